@@ -14,6 +14,9 @@
  */
 
 #include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 
@@ -85,7 +88,21 @@ namespace gridtools {
             performance_meter_t m_meter_exchange;
             performance_meter_t m_meter_bc;
 
+            bool m_in_flight = false;
+
           public:
+            /**
+                @brief The state of an exchange started by distributed_boundaries::start_exchange: the jobs whose halos
+                are being updated. It is consumed by distributed_boundaries::finish_exchange.
+            */
+            template <typename... Jobs>
+            class exchange_handle {
+                friend distributed_boundaries;
+                std::tuple<Jobs...> m_jobs;
+
+                exchange_handle(Jobs const &... jobs) : m_jobs(jobs...) {}
+            };
+
             /**
                 @brief Constructor of distributed_boundaries.
 
@@ -158,6 +175,24 @@ namespace gridtools {
             */
             template <typename... Jobs>
             void exchange(Jobs const &... jobs) {
+                finish_exchange(start_exchange(jobs...));
+            }
+
+            /**
+                @brief First phase of distributed_boundaries::exchange: packs the data stores to be exchanged and
+                starts the communication, without waiting for it.
+
+                The computations that do not read the halos of the exchanged data stores and do not write the exchanged
+                data stores can run until the matching call to distributed_boundaries::finish_exchange. Only one
+                exchange can be in flight at a time.
+
+                \param jobs Variadic list of jobs, as for distributed_boundaries::exchange
+                \return The handle to be passed to distributed_boundaries::finish_exchange
+            */
+            template <typename... Jobs>
+            exchange_handle<Jobs...> start_exchange(Jobs const &... jobs) {
+                if (m_in_flight)
+                    throw std::runtime_error("An exchange is already in flight");
                 auto all_stores_for_exc = std::tuple_cat(collect_stores(jobs)...);
                 if (m_max_stores < sizeof...(jobs)) {
                     std::string err{"Too many data stores to be exchanged" + std::to_string(sizeof...(jobs)) +
@@ -168,37 +203,83 @@ namespace gridtools {
                 m_meter_pack.start();
                 call_pack(all_stores_for_exc, std::make_integer_sequence<uint_t, sizeof...(jobs)>{});
                 m_meter_pack.pause();
-                m_meter_exchange.start();
-                m_he->exchange();
-                m_meter_exchange.pause();
-                m_meter_pack.start();
-                call_unpack(all_stores_for_exc, std::make_integer_sequence<uint_t, sizeof...(jobs)>{});
-                m_meter_pack.pause();
+                m_he->start_exchange();
+                m_in_flight = true;
+                return {jobs...};
+            }
 
-                boundary_only(jobs...);
+            /**
+                @brief Second phase of distributed_boundaries::exchange: waits for the communication started by
+                distributed_boundaries::start_exchange, unpacks the received halos and applies the boundary
+                conditions. The exchange meter accounts for the time spent waiting.
+
+                \param handle The handle returned by distributed_boundaries::start_exchange
+            */
+            template <typename... Jobs>
+            void finish_exchange(exchange_handle<Jobs...> const &handle) {
+                if (!m_in_flight)
+                    throw std::runtime_error("No exchange is in flight");
+                m_in_flight = false;
+                finish_exchange_impl(handle.m_jobs, std::index_sequence_for<Jobs...>());
             }
 
             typename pattern_type::grid_type const &proc_grid() const { return m_he->comm(); }
 
+            /**
+                @brief Selects how the halos are exchanged, see gcl::exchange_mode. Must be called by all the processes
+                with the same mode, not while an exchange is in flight.
+            */
+            void set_exchange_mode(gcl::exchange_mode mode) { m_he->set_exchange_mode(mode); }
+
+            /**
+                @brief Selects whether the halos are sent and received in place with MPI derived datatypes, see
+                gcl::zero_copy_policy (CPU only).
+            */
+            void set_zero_copy(gcl::zero_copy_policy policy) { m_he->set_zero_copy(policy); }
+
+            /**
+                @brief Selects whether the halos of the neighbours on the same node are exchanged through an MPI-3
+                shared memory window instead of MPI messages (CPU only). All the processes must make the same choice.
+            */
+            void set_shared_memory(bool enable) { m_he->set_shared_memory(enable); }
+
             std::string print_meters() const {
                 return m_meter_pack.to_string() + "\n" + m_meter_exchange.to_string() + "\n" + m_meter_bc.to_string();
             }
 
-            double get_time_pack() const { return m_meter_pack.get_time(); }
-            double get_time_exchange() const { return m_meter_exchange.get_time(); }
-            double get_time_boundary() const { return m_meter_bc.get_time(); }
+            double get_time_pack() const { return m_meter_pack.total_time(); }
+            double get_time_exchange() const { return m_meter_exchange.total_time(); }
+            double get_time_boundary() const { return m_meter_bc.total_time(); }
 
-            size_t get_count_exchange() const { return m_meter_exchange.get_count(); }
+            size_t get_count_exchange() const { return m_meter_exchange.count(); }
             // no get_count_pack() as it is equivalent to get_count_exchange()
-            size_t get_count_boundary() const { return m_meter_bc.get_count(); }
+            size_t get_count_boundary() const { return m_meter_bc.count(); }
+
+            /**
+                The volume and the duration of the pack and unpack phases with the derived bandwidths (CPU only).
+            */
+            gcl::pack_statistics const &get_pack_statistics() const { return m_he->get_pack_statistics(); }
 
             void reset_meters() {
-                m_meter_pack.reset_meter();
-                m_meter_exchange.reset_meter();
-                m_meter_bc.reset_meter();
+                m_meter_pack.reset();
+                m_meter_exchange.reset();
+                m_meter_bc.reset();
             }
 
           private:
+            template <typename... Jobs, size_t... Is>
+            void finish_exchange_impl(std::tuple<Jobs...> const &jobs, std::index_sequence<Is...>) {
+                auto all_stores_for_exc = std::tuple_cat(collect_stores(std::get<Is>(jobs))...);
+                m_meter_exchange.start();
+                m_he->wait();
+                m_meter_exchange.pause();
+                m_meter_pack.start();
+                call_unpack(all_stores_for_exc, std::make_integer_sequence<uint_t, sizeof...(Jobs)>{});
+                m_meter_pack.pause();
+
+                boundary_only(std::get<Is>(jobs)...);
+            }
+
             template <typename BoundaryApply, typename ArgsTuple, uint_t... Ids>
             static void call_apply(
                 BoundaryApply boundary_apply, ArgsTuple const &args, std::integer_sequence<uint_t, Ids...>) {
@@ -0,0 +1,99 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <tuple>
+#include <utility>
+
+#include "../common/defs.hpp"
+#include "../common/hymap.hpp"
+#include "../stencil/common/dim.hpp"
+#include "../stencil/common/extent.hpp"
+#include "../stencil/frontend/run.hpp"
+#include "distributed_boundaries.hpp"
+
+/**
+ *  @file
+ *  `overlapped_run(comp, backend, grid, dist_boundaries, std::tie(jobs...), fields...)` is equivalent to
+ *
+ *      dist_boundaries.exchange(jobs...);
+ *      run(comp, backend, grid, fields...);
+ *
+ *  but overlaps the halo exchange with the computation: the exchange is started, the interior of the domain (the
+ *  domain shrunk by the enclosing extent of the arguments, see `get_arg_extent`) is computed while the messages are in
+ *  flight, then the exchange is finished and the remaining boundary strips are computed.
+ *
+ *  Requirements to the computation: the data stores of the jobs are not written by it and the interior points read
+ *  only the points of the domain.
+ */
+
+namespace gridtools {
+    namespace boundaries {
+        namespace overlapped_run_impl_ {
+            using stencil::frontend_impl_::arg;
+
+            template <class Comp, size_t... Is>
+            auto get_spec(Comp comp, std::index_sequence<Is...>) -> decltype(comp(arg<Is>()...));
+
+            template <class Spec, size_t... Is>
+            auto get_enclosing_extent(Spec spec, std::index_sequence<Is...>)
+                -> stencil::enclosing_extent<decltype(stencil::get_arg_extent(spec, arg<Is>()))...>;
+
+            template <class CTraits, class... Jobs, size_t... Is>
+            auto start_exchange(distributed_boundaries<CTraits> &dist_boundaries,
+                std::tuple<Jobs...> const &jobs,
+                std::index_sequence<Is...>) {
+                return dist_boundaries.start_exchange(std::get<Is>(jobs)...);
+            }
+
+            template <class Comp, class Backend, class Grid, class CTraits, class... Jobs, class... Fields>
+            void overlapped_run(Comp comp,
+                Backend backend,
+                Grid const &grid,
+                distributed_boundaries<CTraits> &dist_boundaries,
+                std::tuple<Jobs...> const &jobs,
+                Fields &&... fields) {
+                using spec_t = decltype(get_spec(comp, std::index_sequence_for<Fields...>()));
+                using extent_t = decltype(get_enclosing_extent(spec_t(), std::index_sequence_for<Fields...>()));
+
+                auto origin = grid.origin();
+                int_t i_lo = at_key<stencil::dim::i>(origin);
+                int_t j_lo = at_key<stencil::dim::j>(origin);
+                int_t i_hi = i_lo + grid.i_size();
+                int_t j_hi = j_lo + grid.j_size();
+                // the points that read only the points of the domain
+                int_t inner_i_lo = std::min<int_t>(i_lo - extent_t::iminus::value, i_hi);
+                int_t inner_i_hi = std::max<int_t>(i_hi - extent_t::iplus::value, inner_i_lo);
+                int_t inner_j_lo = std::min<int_t>(j_lo - extent_t::jminus::value, j_hi);
+                int_t inner_j_hi = std::max<int_t>(j_hi - extent_t::jplus::value, inner_j_lo);
+
+                auto run_box = [&](int_t i_start, int_t i_stop, int_t j_start, int_t j_stop) {
+                    if (i_start < i_stop && j_start < j_stop)
+                        stencil::run(comp,
+                            backend,
+                            grid.horizontal_subgrid(i_start, i_stop - i_start, j_start, j_stop - j_start),
+                            fields...);
+                };
+
+                auto handle = start_exchange(dist_boundaries, jobs, std::index_sequence_for<Jobs...>());
+                run_box(inner_i_lo, inner_i_hi, inner_j_lo, inner_j_hi);
+                dist_boundaries.finish_exchange(handle);
+                run_box(i_lo, inner_i_lo, j_lo, j_hi);
+                run_box(inner_i_hi, i_hi, j_lo, j_hi);
+                run_box(inner_i_lo, inner_i_hi, j_lo, inner_j_lo);
+                run_box(inner_i_lo, inner_i_hi, inner_j_hi, j_hi);
+            }
+        } // namespace overlapped_run_impl_
+        using overlapped_run_impl_::overlapped_run;
+    } // namespace boundaries
+} // namespace gridtools
@@ -0,0 +1,221 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#include "defs.hpp"
+#include "host_device.hpp"
+
+/**
+ *  @file
+ *  Compact element types for the fields that don't need the full precision:
+ *    - `float16_t`: IEEE 754 binary16;
+ *    - `bfloat16_t`: the upper half of IEEE 754 binary32;
+ *    - `fixed_point<Int, FractionBits>`: the value `raw / 2^FractionBits` stored in `Int`.
+ *
+ *  The types store the compact representation and implicitly convert from and to their `wide_type` (`float`, or
+ *  `double` for the fixed point types with more than 16 bits) with rounding to nearest even (the fixed point types
+ *  saturate). The arithmetic is performed on the wide type. Stencils access the fields of these types unchanged:
+ *  the `in` accessors return the widened values, the `inout` ones return the references to the compact elements that
+ *  narrow on assignment.
+ */
+
+namespace gridtools {
+    namespace reduced_precision_impl_ {
+        template <class To, class From>
+        GT_FUNCTION To bit_cast(From src) {
+            static_assert(sizeof(To) == sizeof(From), GT_INTERNAL_ERROR);
+            To res;
+            memcpy(&res, &src, sizeof(To));
+            return res;
+        }
+
+        GT_FUNCTION std::uint16_t float_to_half_bits(float value) {
+            std::uint32_t bits = bit_cast<std::uint32_t>(value);
+            std::uint32_t sign = (bits >> 16) & 0x8000;
+            bits &= 0x7fffffff;
+            // inf and nan
+            if (bits >= 0x7f800000)
+                return sign | 0x7c00 | (bits > 0x7f800000 ? 0x200 : 0);
+            // rounds to inf
+            if (bits >= 0x477ff000)
+                return sign | 0x7c00;
+            // normal half precision numbers, the carry of the rounding propagates to the exponent
+            if (bits >= 0x38800000) {
+                std::uint32_t res = (bits >> 13) - ((127 - 15) << 10);
+                std::uint32_t rest = bits & 0x1fff;
+                return sign | (res + (rest > 0x1000 || (rest == 0x1000 && (res & 1))));
+            }
+            // rounds to zero
+            if (bits < 0x33000000)
+                return sign;
+            // subnormal half precision numbers
+            std::uint32_t shift = 126 - (bits >> 23);
+            std::uint32_t mantissa = (bits & 0x7fffff) | 0x800000;
+            std::uint32_t res = mantissa >> shift;
+            std::uint32_t rest = mantissa & ((1u << shift) - 1);
+            std::uint32_t halfway = 1u << (shift - 1);
+            return sign | (res + (rest > halfway || (rest == halfway && (res & 1))));
+        }
+
+        GT_FUNCTION float half_bits_to_float(std::uint16_t bits) {
+            std::uint32_t sign = std::uint32_t(bits & 0x8000) << 16;
+            std::uint32_t exponent = (bits >> 10) & 0x1f;
+            std::uint32_t mantissa = bits & 0x3ff;
+            if (exponent == 0x1f)
+                return bit_cast<float>(sign | 0x7f800000 | (mantissa << 13));
+            if (exponent)
+                return bit_cast<float>(sign | ((exponent + 127 - 15) << 23) | (mantissa << 13));
+            float res = mantissa * (1.f / (1 << 24));
+            return sign ? -res : res;
+        }
+
+        GT_FUNCTION std::uint16_t float_to_bfloat16_bits(float value) {
+            std::uint32_t bits = bit_cast<std::uint32_t>(value);
+            // keeps nan quiet
+            if ((bits & 0x7fffffff) > 0x7f800000)
+                return (bits >> 16) | 0x40;
+            return (bits + 0x7fff + ((bits >> 16) & 1)) >> 16;
+        }
+
+        GT_FUNCTION float bfloat16_bits_to_float(std::uint16_t bits) {
+            return bit_cast<float>(std::uint32_t(bits) << 16);
+        }
+
+        // the compound assignments of the compact types, the arithmetic is performed on the wide type
+        template <class T>
+        struct compact_base {
+            template <class U>
+            GT_FUNCTION T &operator+=(U const &rhs) {
+                return self() = wide() + rhs;
+            }
+            template <class U>
+            GT_FUNCTION T &operator-=(U const &rhs) {
+                return self() = wide() - rhs;
+            }
+            template <class U>
+            GT_FUNCTION T &operator*=(U const &rhs) {
+                return self() = wide() * rhs;
+            }
+            template <class U>
+            GT_FUNCTION T &operator/=(U const &rhs) {
+                return self() = wide() / rhs;
+            }
+
+          private:
+            GT_FUNCTION T &self() { return static_cast<T &>(*this); }
+            GT_FUNCTION auto wide() const { return typename T::wide_type(static_cast<T const &>(*this)); }
+        };
+    } // namespace reduced_precision_impl_
+
+    struct float16_t : reduced_precision_impl_::compact_base<float16_t> {
+        using wide_type = float;
+        std::uint16_t m_bits;
+
+        float16_t() = default;
+        GT_FUNCTION float16_t(float value) : m_bits(reduced_precision_impl_::float_to_half_bits(value)) {}
+        GT_FUNCTION operator float() const { return reduced_precision_impl_::half_bits_to_float(m_bits); }
+
+        GT_FUNCTION static float16_t from_bits(std::uint16_t bits) {
+            float16_t res;
+            res.m_bits = bits;
+            return res;
+        }
+    };
+
+    struct bfloat16_t : reduced_precision_impl_::compact_base<bfloat16_t> {
+        using wide_type = float;
+        std::uint16_t m_bits;
+
+        bfloat16_t() = default;
+        GT_FUNCTION bfloat16_t(float value) : m_bits(reduced_precision_impl_::float_to_bfloat16_bits(value)) {}
+        GT_FUNCTION operator float() const { return reduced_precision_impl_::bfloat16_bits_to_float(m_bits); }
+
+        GT_FUNCTION static bfloat16_t from_bits(std::uint16_t bits) {
+            bfloat16_t res;
+            res.m_bits = bits;
+            return res;
+        }
+    };
+
+    template <class Int, int FractionBits>
+    struct fixed_point : reduced_precision_impl_::compact_base<fixed_point<Int, FractionBits>> {
+        static_assert(std::is_integral<Int>::value, "fixed_point requires an integral representation");
+        static_assert(FractionBits >= 0 && FractionBits < int(sizeof(Int) * 8), "invalid number of fraction bits");
+
+        using wide_type = std::conditional_t<(sizeof(Int) <= 2), float, double>;
+        Int m_raw;
+
+        fixed_point() = default;
+        GT_FUNCTION fixed_point(wide_type value) : m_raw(narrow(value * scale())) {}
+        GT_FUNCTION operator wide_type() const { return m_raw / scale(); }
+
+        GT_FUNCTION static fixed_point from_raw(Int raw) {
+            fixed_point res;
+            res.m_raw = raw;
+            return res;
+        }
+
+      private:
+        GT_FUNCTION static constexpr wide_type scale() { return wide_type(1ull << FractionBits); }
+
+        GT_FUNCTION static Int narrow(wide_type value) {
+            constexpr wide_type lo = wide_type(std::numeric_limits<Int>::min());
+            constexpr wide_type hi = wide_type(std::numeric_limits<Int>::max());
+            if (!(value > lo))
+                return value != value ? 0 : std::numeric_limits<Int>::min();
+            if (!(value < hi))
+                return std::numeric_limits<Int>::max();
+            // rounds to nearest even
+            wide_type floor = wide_type(Int(value) - (value < Int(value)));
+            wide_type rest = value - floor;
+            Int res = Int(floor);
+            return res + (rest > wide_type(.5) || (rest == wide_type(.5) && (res & 1)));
+        }
+    };
+
+    /**
+     *  `is_reduced_precision<T>` tells if `T` is a compact type, `widen_t<T>` is its wide type (`T` itself for the
+     *  other types).
+     */
+    template <class T>
+    struct is_reduced_precision : std::false_type {};
+
+    template <>
+    struct is_reduced_precision<float16_t> : std::true_type {};
+
+    template <>
+    struct is_reduced_precision<bfloat16_t> : std::true_type {};
+
+    template <class Int, int FractionBits>
+    struct is_reduced_precision<fixed_point<Int, FractionBits>> : std::true_type {};
+
+    template <class T>
+    struct is_reduced_precision<T const> : is_reduced_precision<T> {};
+
+    namespace reduced_precision_impl_ {
+        template <class T, class = void>
+        struct widen {
+            using type = T;
+        };
+
+        template <class T>
+        struct widen<T, std::enable_if_t<is_reduced_precision<T>::value>> {
+            using type = typename std::remove_const_t<T>::wide_type;
+        };
+    } // namespace reduced_precision_impl_
+
+    template <class T>
+    using widen_t = typename reduced_precision_impl_::widen<T>::type;
+} // namespace gridtools
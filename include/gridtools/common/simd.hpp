@@ -0,0 +1,350 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#include "host_device.hpp"
+
+/**
+ *  @file
+ *  Fixed width SIMD vectors on top of the GCC/Clang vector extensions.
+ *
+ *  `simd::vec<T, N>` holds `N` values of the arithmetic type `T`, the arithmetic operators work lane wise.
+ *  Comparisons return `simd::mask<T, N>` which can be combined with `&`, `|`, `!` and is consumed by
+ *  `select(mask, a, b)`. `simd::ref<T, N>` refers to `N` consecutive values in memory; it converts to `vec` by loading
+ *  them and stores them on assignment. Scalars are broadcast if they are mixed with vectors.
+ *
+ *  The operators and functions are found by ADL, so the same generic code works for scalars and vectors as long as
+ *  branches are expressed with `select`, `min` and `max`.
+ *
+ *  `interleave_low`, `interleave_high` and `transpose` rearrange the lanes within registers.
+ *
+ *  The default vector size in bytes is `GT_SIMD_BYTES` and derived from the target ISA if not defined.
+ */
+
+#ifndef GT_SIMD_BYTES
+#if defined(__AVX512F__)
+#define GT_SIMD_BYTES 64
+#elif defined(__AVX__)
+#define GT_SIMD_BYTES 32
+#else
+#define GT_SIMD_BYTES 16
+#endif
+#endif
+
+namespace gridtools {
+    namespace simd {
+        /**
+         *  The number of lanes of `T` that fit into a native vector register.
+         */
+        template <class T>
+        constexpr int native_lanes() {
+            return GT_SIMD_BYTES / sizeof(T) > 0 ? GT_SIMD_BYTES / sizeof(T) : 1;
+        }
+
+        template <class T, int N>
+        struct vec;
+
+        template <class T, int N>
+        struct mask;
+
+        template <class T, int N>
+        struct ref;
+
+        namespace simd_impl_ {
+            template <class T, int N>
+            struct native {
+                static_assert(std::is_arithmetic<T>::value, "simd vectors are supported for arithmetic types only");
+                static_assert(N > 0 && (N & (N - 1)) == 0, "the number of lanes should be a power of two");
+                typedef T type __attribute__((vector_size(N * sizeof(T))));
+            };
+
+            template <class T>
+            struct traits {
+                static constexpr int lanes = 0;
+                using value_type = T;
+            };
+
+            template <class T, int N>
+            struct traits<vec<T, N>> {
+                static constexpr int lanes = N;
+                using value_type = T;
+            };
+
+            template <class T, int N>
+            struct traits<ref<T, N>> {
+                static constexpr int lanes = N;
+                using value_type = std::remove_const_t<T>;
+            };
+
+            template <class L, class R>
+            constexpr int common_lanes() {
+                return traits<L>::lanes == 0 ? traits<R>::lanes
+                                             : traits<R>::lanes == 0 || traits<R>::lanes == traits<L>::lanes
+                                                   ? traits<L>::lanes
+                                                   : -1;
+            }
+
+            /*
+             *  The vector type for the result of binary operations on `L` and `R`; at least one of them is a vector.
+             */
+            template <class L,
+                class R,
+                int N = common_lanes<L, R>(),
+                std::enable_if_t<(N > 0) && (std::is_arithmetic<L>::value || traits<L>::lanes > 0) &&
+                                     (std::is_arithmetic<R>::value || traits<R>::lanes > 0),
+                    int> = 0>
+            using common_vec =
+                vec<decltype(typename traits<L>::value_type() + typename traits<R>::value_type()), N>;
+
+            // the helpers return `vec` rather than its native type: a native vector wider than the enabled instruction
+            // set changes the ABI of the function, `vec` is returned in memory in any case
+
+            template <class Res, class T, std::enable_if_t<std::is_arithmetic<T>::value, int> = 0>
+            GT_FORCE_INLINE Res to_vec(T const &src) {
+                return Res(static_cast<typename traits<Res>::value_type>(src));
+            }
+
+            template <class Res, class T, int N>
+            GT_FORCE_INLINE Res to_vec(vec<T, N> const &src) {
+                return Res(src);
+            }
+
+            template <class Res, class T, int N>
+            GT_FORCE_INLINE Res to_vec(ref<T, N> const &src) {
+                return to_vec<Res>(vec<std::remove_const_t<T>, N>(src));
+            }
+
+            // the lanes `Offset`, ..., `Offset + N / 2 - 1` of `l` and `r`, alternating
+            template <int N, int Offset, class T, int... Is>
+            GT_FORCE_INLINE vec<T, N> interleave(
+                vec<T, N> const &l, vec<T, N> const &r, std::integer_sequence<int, Is...>) {
+#if defined(__clang__) || __GNUC__ >= 12
+                return {__builtin_shufflevector(l.m_data, r.m_data, (Offset + Is / 2 + Is % 2 * N)...)};
+#else
+                using index_t = decltype(l.m_data < r.m_data);
+                return {__builtin_shuffle(l.m_data, r.m_data, index_t{(Offset + Is / 2 + Is % 2 * N)...})};
+#endif
+            }
+        } // namespace simd_impl_
+
+        template <class T, int N>
+        struct vec {
+            using native_t = typename simd_impl_::native<T, N>::type;
+            native_t m_data;
+
+            vec() = default;
+            GT_FORCE_INLINE vec(native_t data) : m_data(data) {}
+            GT_FORCE_INLINE vec(T scalar) : m_data(native_t{} + scalar) {}
+
+            template <class U, std::enable_if_t<!std::is_same<U, T>::value, int> = 0>
+            GT_FORCE_INLINE explicit vec(vec<U, N> const &src)
+                : m_data(__builtin_convertvector(src.m_data, native_t)) {}
+
+            /** Loads `N` consecutive values. */
+            static GT_FORCE_INLINE vec load(T const *ptr) {
+                vec res;
+                std::memcpy(&res.m_data, ptr, sizeof(native_t));
+                return res;
+            }
+
+            /** Stores `N` consecutive values. */
+            GT_FORCE_INLINE void store(T *ptr) const { std::memcpy(ptr, &m_data, sizeof(native_t)); }
+
+            GT_FORCE_INLINE T operator[](int i) const { return m_data[i]; }
+
+            static constexpr int size() { return N; }
+        };
+
+        template <class T, int N>
+        struct mask {
+            using native_t = decltype(typename vec<T, N>::native_t() < typename vec<T, N>::native_t());
+            native_t m_data;
+
+            GT_FORCE_INLINE bool operator[](int i) const { return m_data[i]; }
+
+            friend GT_FORCE_INLINE mask operator&(mask const &l, mask const &r) { return {l.m_data & r.m_data}; }
+            friend GT_FORCE_INLINE mask operator|(mask const &l, mask const &r) { return {l.m_data | r.m_data}; }
+            friend GT_FORCE_INLINE mask operator!(mask const &m) { return {~m.m_data}; }
+        };
+
+        template <class T, int N>
+        struct ref {
+            T *m_ptr;
+
+            GT_FORCE_INLINE operator vec<std::remove_const_t<T>, N>() const {
+                return vec<std::remove_const_t<T>, N>::load(m_ptr);
+            }
+
+            GT_FORCE_INLINE operator ref<T const, N>() const { return {m_ptr}; }
+
+            template <class U, class Vec = simd_impl_::common_vec<vec<std::remove_const_t<T>, N>, U>>
+            GT_FORCE_INLINE ref const &operator=(U const &src) const {
+                static_assert(!std::is_const<T>::value, "assignment to read only simd reference");
+                vec<T, N>(simd_impl_::to_vec<Vec>(src)).store(m_ptr);
+                return *this;
+            }
+
+            ref(ref const &) = default;
+
+            // assignments store the values, they never rebind the reference
+            GT_FORCE_INLINE ref const &operator=(ref const &src) const { return *this = vec<T, N>(src); }
+            GT_FORCE_INLINE ref &operator=(ref const &src) {
+                static_cast<ref const &>(*this) = vec<T, N>(src);
+                return *this;
+            }
+
+            template <class U>
+            GT_FORCE_INLINE ref const &operator+=(U const &src) const {
+                return *this = *this + src;
+            }
+            template <class U>
+            GT_FORCE_INLINE ref const &operator-=(U const &src) const {
+                return *this = *this - src;
+            }
+            template <class U>
+            GT_FORCE_INLINE ref const &operator*=(U const &src) const {
+                return *this = *this * src;
+            }
+            template <class U>
+            GT_FORCE_INLINE ref const &operator/=(U const &src) const {
+                return *this = *this / src;
+            }
+
+            GT_FORCE_INLINE std::remove_const_t<T> operator[](int i) const { return m_ptr[i]; }
+        };
+
+#define GT_SIMD_BINARY_OPERATOR(op)                                                                          \
+    template <class L, class R, class Res = simd_impl_::common_vec<L, R>>                                    \
+    GT_FORCE_INLINE Res operator op(L const &l, R const &r) {                                                \
+        return {simd_impl_::to_vec<Res>(l).m_data op simd_impl_::to_vec<Res>(r).m_data};                     \
+    }                                                                                                        \
+    static_assert(1, "")
+
+        GT_SIMD_BINARY_OPERATOR(+);
+        GT_SIMD_BINARY_OPERATOR(-);
+        GT_SIMD_BINARY_OPERATOR(*);
+        GT_SIMD_BINARY_OPERATOR(/);
+
+#undef GT_SIMD_BINARY_OPERATOR
+
+#define GT_SIMD_COMPARISON_OPERATOR(op)                                                                      \
+    template <class L,                                                                                       \
+        class R,                                                                                             \
+        class Vec = simd_impl_::common_vec<L, R>,                                                            \
+        class Res = mask<typename simd_impl_::traits<Vec>::value_type, simd_impl_::traits<Vec>::lanes>>      \
+    GT_FORCE_INLINE Res operator op(L const &l, R const &r) {                                                \
+        return {simd_impl_::to_vec<Vec>(l).m_data op simd_impl_::to_vec<Vec>(r).m_data};                     \
+    }                                                                                                        \
+    static_assert(1, "")
+
+        GT_SIMD_COMPARISON_OPERATOR(<);
+        GT_SIMD_COMPARISON_OPERATOR(<=);
+        GT_SIMD_COMPARISON_OPERATOR(>);
+        GT_SIMD_COMPARISON_OPERATOR(>=);
+        GT_SIMD_COMPARISON_OPERATOR(==);
+        GT_SIMD_COMPARISON_OPERATOR(!=);
+
+#undef GT_SIMD_COMPARISON_OPERATOR
+
+        template <class T, int N>
+        GT_FORCE_INLINE vec<T, N> operator-(vec<T, N> const &src) {
+            return {-src.m_data};
+        }
+
+        template <class T, int N>
+        GT_FORCE_INLINE vec<std::remove_const_t<T>, N> operator-(ref<T, N> const &src) {
+            return -vec<std::remove_const_t<T>, N>(src);
+        }
+
+        /**
+         *  Lane wise `m ? l : r`.
+         */
+        template <class M, int N, class L, class R, class Res = simd_impl_::common_vec<L, R>>
+        GT_FORCE_INLINE Res select(mask<M, N> const &m, L const &l, R const &r) {
+            static_assert(simd_impl_::traits<Res>::lanes == N, "mask and values have different number of lanes");
+            using native_t = typename Res::native_t;
+            using int_native_t = decltype(native_t() < native_t());
+            return {__builtin_convertvector(m.m_data, int_native_t) ? simd_impl_::to_vec<Res>(l).m_data
+                                                                    : simd_impl_::to_vec<Res>(r).m_data};
+        }
+
+        template <class L, class R, class Res = simd_impl_::common_vec<L, R>>
+        GT_FORCE_INLINE Res min(L const &l, R const &r) {
+            return select(r < l, r, l);
+        }
+
+        template <class L, class R, class Res = simd_impl_::common_vec<L, R>>
+        GT_FORCE_INLINE Res max(L const &l, R const &r) {
+            return select(l < r, r, l);
+        }
+
+        template <class T, int N>
+        GT_FORCE_INLINE vec<T, N> abs(vec<T, N> const &src) {
+            return select(src < T(0), -src, src);
+        }
+
+        template <class T, int N>
+        GT_FORCE_INLINE vec<std::remove_const_t<T>, N> abs(ref<T, N> const &src) {
+            return abs(vec<std::remove_const_t<T>, N>(src));
+        }
+
+        template <class T, int N>
+        GT_FORCE_INLINE vec<T, N> sqrt(vec<T, N> const &src) {
+            vec<T, N> res;
+            for (int i = 0; i != N; ++i)
+                res.m_data[i] = std::sqrt(src.m_data[i]);
+            return res;
+        }
+
+        template <class T, int N>
+        GT_FORCE_INLINE vec<std::remove_const_t<T>, N> sqrt(ref<T, N> const &src) {
+            return sqrt(vec<std::remove_const_t<T>, N>(src));
+        }
+
+        /**
+         *  `{l[0], r[0], l[1], r[1], ..., l[N / 2 - 1], r[N / 2 - 1]}`
+         */
+        template <class T, int N>
+        GT_FORCE_INLINE vec<T, N> interleave_low(vec<T, N> const &l, vec<T, N> const &r) {
+            return simd_impl_::interleave<N, 0>(l, r, std::make_integer_sequence<int, N>());
+        }
+
+        /**
+         *  `{l[N / 2], r[N / 2], ..., l[N - 1], r[N - 1]}`
+         */
+        template <class T, int N>
+        GT_FORCE_INLINE vec<T, N> interleave_high(vec<T, N> const &l, vec<T, N> const &r) {
+            return simd_impl_::interleave<N, N / 2>(l, r, std::make_integer_sequence<int, N>());
+        }
+
+        /**
+         *  Transposes the `N x N` matrix given by its rows in registers: `log2(N)` rounds of interleaving the upper
+         *  half of the rows with the lower half.
+         */
+        template <class T, int N>
+        GT_FORCE_INLINE void transpose(vec<T, N> (&rows)[N]) {
+            for (int round = 1; round < N; round *= 2) {
+                vec<T, N> tmp[N];
+                for (int i = 0; i != N / 2; ++i) {
+                    tmp[2 * i] = interleave_low(rows[i], rows[i + N / 2]);
+                    tmp[2 * i + 1] = interleave_high(rows[i], rows[i + N / 2]);
+                }
+                for (int i = 0; i != N; ++i)
+                    rows[i] = tmp[i];
+            }
+        }
+    } // namespace simd
+} // namespace gridtools
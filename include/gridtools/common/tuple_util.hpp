@@ -689,7 +689,7 @@ namespace gridtools {
                 struct pop_back_f {
                     template <class Tup,
                         class Accessors = get_accessors<Tup>,
-                        class Res = from_types<Tup, meta::pop_front<Accessors>>>
+                        class Res = from_types<Tup, meta::pop_back<Accessors>>>
                     GT_TARGET GT_FORCE_INLINE GT_CONSTEXPR Res operator()(Tup &&tup) const {
                         return pop_back_impl_f<std::make_index_sequence<size<Accessors>::value - 1>, Res>()(
                             wstd::forward<Tup>(tup));
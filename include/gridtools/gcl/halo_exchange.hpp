@@ -304,7 +304,32 @@ namespace gridtools {
             */
             void wait() { hd.wait(); }
 
+            /**
+               Selects how the buffers are exchanged (point to point, persistent requests or a neighbourhood
+               collective), see gcl::exchange_mode. All the processes must select the same mode.
+            */
+            void set_exchange_mode(exchange_mode mode) { hd.set_exchange_mode(mode); }
+
+            /**
+               Selects whether the halos are sent and received in place with MPI derived datatypes instead of the
+               pack and unpack buffers, see gcl::zero_copy_policy (CPU only).
+            */
+            void set_zero_copy(zero_copy_policy policy) { hd.set_zero_copy(policy); }
+
+            /**
+               Selects whether the halos of the neighbours on the same node are exchanged through an MPI-3 shared
+               memory window instead of MPI messages (CPU only). All the processes must make the same choice.
+            */
+            void set_shared_memory(bool enable) { hd.set_shared_memory(enable); }
+
             grid_type const &comm() const { return hd.comm(); }
+
+            /**
+               The volume and the duration of the pack and unpack phases, see gcl::pack_statistics (CPU only)
+            */
+            pack_statistics const &get_pack_statistics() const { return hd.statistics(); }
+
+            void reset_pack_statistics() { hd.reset_statistics(); }
         };
 
         /**
@@ -462,6 +487,19 @@ namespace gridtools {
                and vice versa.
             */
             void wait() { hd.wait(); }
+
+            /**
+               Selects how the buffers are exchanged (point to point, persistent requests or a neighbourhood
+               collective), see gcl::exchange_mode. All the processes must select the same mode.
+            */
+            void set_exchange_mode(exchange_mode mode) { hd.set_exchange_mode(mode); }
+
+            /**
+               The volume and the duration of the pack and unpack phases, see gcl::pack_statistics (CPU only)
+            */
+            pack_statistics const &get_pack_statistics() const { return hd.statistics(); }
+
+            void reset_pack_statistics() { hd.reset_statistics(); }
         };
 
         template <typename layout2proc_map, typename Gcl_Arch = cpu>
@@ -11,6 +11,8 @@
 
 #include <mpi.h>
 
+#include "../low_level/Halo_Exchange_3D.hpp"
+
 namespace gridtools {
     namespace gcl {
         /**
@@ -70,6 +72,11 @@ namespace gridtools {
             */
             void wait() { m_haloexch.wait(); }
 
+            /**
+               Selects how the buffers are exchanged, see gcl::exchange_mode.
+            */
+            void set_exchange_mode(exchange_mode mode) { m_haloexch.set_exchange_mode(mode); }
+
             /**
                Retrieve the pattern from which the computing grid and other information
                can be retrieved. The function is available only if the underlying
@@ -53,13 +53,16 @@
 #undef GCL_KERNEL_TYPE
 #endif
 
+#include <tuple>
 #include <vector>
 
 #include "../../common/array.hpp"
 #include "../../common/make_array.hpp"
 #include "../../common/numerics.hpp"
+#include "../../common/tuple_util.hpp"
 #include "../low_level/translate.hpp"
 #include "field_on_the_fly.hpp"
+#include "halo_packer.hpp"
 #include "helpers_impl.hpp"
 
 namespace gridtools {
@@ -71,6 +74,7 @@ namespace gridtools {
             array<char *, static_pow3(DIMS)> recv_buffer;
             array<int, static_pow3(DIMS)> send_buffer_size; // One entry will not be used...
             array<int, static_pow3(DIMS)> recv_buffer_size;
+            mutable halo_packer<> m_packer;
 
           public:
             typedef descriptor_base<HaloExch> base_type;
@@ -213,26 +217,30 @@ namespace gridtools {
 
             template <typename... FIELDS>
             void pack(const FIELDS &... _fields) const {
-                for (int ii = -1; ii <= 1; ++ii) {
-                    for (int jj = -1; jj <= 1; ++jj) {
-                        for (int kk = -1; kk <= 1; ++kk) {
-                            char *it = reinterpret_cast<char *>(&(send_buffer[translate()(ii, jj, kk)][0]));
-                            pack_dims<DIMS, 0>()(*this, ii, jj, kk, it, _fields...);
-                        }
-                    }
-                }
+                for_each_neighbour([&](array<int, DIMS> const &eta) {
+                    char *it = send_buffer[translate()(eta[0], eta[1], eta[2])];
+                    tuple_util::for_each(
+                        [&](auto const &field) {
+                            if (has_neighbour(field, eta))
+                                m_packer.schedule_pack(field.ptr, field.halos, eta, it);
+                        },
+                        std::tie(_fields...));
+                });
+                m_packer.run();
             }
 
             template <typename... FIELDS>
             void unpack(const FIELDS &... _fields) const {
-                for (int ii = -1; ii <= 1; ++ii) {
-                    for (int jj = -1; jj <= 1; ++jj) {
-                        for (int kk = -1; kk <= 1; ++kk) {
-                            char *it = reinterpret_cast<char *>(&(recv_buffer[translate()(ii, jj, kk)][0]));
-                            unpack_dims<DIMS, 0>()(*this, ii, jj, kk, it, _fields...);
-                        }
-                    }
-                }
+                for_each_neighbour([&](array<int, DIMS> const &eta) {
+                    char *it = recv_buffer[translate()(eta[0], eta[1], eta[2])];
+                    tuple_util::for_each(
+                        [&](auto const &field) {
+                            if (has_neighbour(field, eta))
+                                m_packer.schedule_unpack(field.ptr, field.halos, eta, it);
+                        },
+                        std::tie(_fields...));
+                });
+                m_packer.run();
             }
 
             /**
@@ -243,16 +251,13 @@ namespace gridtools {
             */
             template <typename T1, typename T2, template <typename> class T3>
             void pack(std::vector<field_on_the_fly<T1, T2, T3>> const &fields) {
-                for (int ii = -1; ii <= 1; ++ii) {
-                    for (int jj = -1; jj <= 1; ++jj) {
-                        for (int kk = -1; kk <= 1; ++kk) {
-                            typename field_on_the_fly<T1, T2, T3>::value_type *it =
-                                reinterpret_cast<typename field_on_the_fly<T1, T2, T3>::value_type *>(
-                                    &(send_buffer[translate()(ii, jj, kk)][0]));
-                            pack_vector_dims<DIMS, 0>()(*this, ii, jj, kk, it, fields);
-                        }
-                    }
-                }
+                for_each_neighbour([&](array<int, DIMS> const &eta) {
+                    char *it = send_buffer[translate()(eta[0], eta[1], eta[2])];
+                    for (auto &&field : fields)
+                        if (has_neighbour(field, eta))
+                            m_packer.schedule_pack(field.ptr, field.halos, eta, it);
+                });
+                m_packer.run();
             }
 
             /**
@@ -263,110 +268,39 @@ namespace gridtools {
             */
             template <typename T1, typename T2, template <typename> class T3>
             void unpack(std::vector<field_on_the_fly<T1, T2, T3>> const &fields) {
-                for (int ii = -1; ii <= 1; ++ii) {
-                    for (int jj = -1; jj <= 1; ++jj) {
-                        for (int kk = -1; kk <= 1; ++kk) {
-                            typename field_on_the_fly<T1, T2, T3>::value_type *it =
-                                reinterpret_cast<typename field_on_the_fly<T1, T2, T3>::value_type *>(
-                                    &(recv_buffer[translate()(ii, jj, kk)][0]));
-                            unpack_vector_dims<DIMS, 0>()(*this, ii, jj, kk, it, fields);
-                        }
-                    }
-                }
+                for_each_neighbour([&](array<int, DIMS> const &eta) {
+                    char *it = recv_buffer[translate()(eta[0], eta[1], eta[2])];
+                    for (auto &&field : fields)
+                        if (has_neighbour(field, eta))
+                            m_packer.schedule_unpack(field.ptr, field.halos, eta, it);
+                });
+                m_packer.run();
             }
 
+            /**
+               The volume and the duration of the pack and unpack phases
+            */
+            pack_statistics const &statistics() const { return m_packer.statistics(); }
+
+            void reset_statistics() { m_packer.reset_statistics(); }
+
           private:
-            template <int, int>
-            struct pack_dims {};
-
-            template <int dummy>
-            struct pack_dims<3, dummy> {
-
-                template <typename T, typename iterator>
-                void operator()(const T &, int, int, int, iterator &) const {}
-
-                template <typename T, typename iterator, typename FIRST, typename... FIELDS>
-                void operator()(
-                    const T &hm, int ii, int jj, int kk, iterator &it, FIRST const &first, const FIELDS &... _fields)
-                    const {
-                    typedef
-                        typename layout_transform<typename FIRST::inner_layoutmap, proc_layout_abs>::type proc_layout;
-                    const int ii_P = make_array(ii, jj, kk)[proc_layout::at(0)];
-                    const int jj_P = make_array(ii, jj, kk)[proc_layout::at(1)];
-                    const int kk_P = make_array(ii, jj, kk)[proc_layout::at(2)];
-                    if ((ii != 0 || jj != 0 || kk != 0) && (hm.pattern().proc_grid().proc(ii_P, jj_P, kk_P) != -1)) {
-                        first.pack(make_array(ii, jj, kk), first.ptr, it);
-                        operator()(hm, ii, jj, kk, it, _fields...);
-                    }
-                }
-            };
-
-            template <int, int>
-            struct unpack_dims {};
-
-            template <int dummy>
-            struct unpack_dims<3, dummy> {
-
-                template <typename T, typename iterator>
-                void operator()(const T &, int, int, int, iterator &) const {}
-
-                template <typename T, typename iterator, typename FIRST, typename... FIELDS>
-                void operator()(
-                    const T &hm, int ii, int jj, int kk, iterator &it, FIRST const &first, const FIELDS &... _fields)
-                    const {
-                    typedef
-                        typename layout_transform<typename FIRST::inner_layoutmap, proc_layout_abs>::type proc_layout;
-                    const int ii_P = make_array(ii, jj, kk)[proc_layout::at(0)];
-                    const int jj_P = make_array(ii, jj, kk)[proc_layout::at(1)];
-                    const int kk_P = make_array(ii, jj, kk)[proc_layout::at(2)];
-                    if ((ii != 0 || jj != 0 || kk != 0) && (hm.pattern().proc_grid().proc(ii_P, jj_P, kk_P) != -1)) {
-                        first.unpack(make_array(ii, jj, kk), first.ptr, it);
-                        operator()(hm, ii, jj, kk, it, _fields...);
-                    }
-                }
-            };
-
-            template <int, int>
-            struct pack_vector_dims {};
-
-            template <int dummy>
-            struct pack_vector_dims<3, dummy> {
-
-                template <typename T, typename iterator, typename array_of_fotf>
-                void operator()(const T &hm, int ii, int jj, int kk, iterator &it, array_of_fotf const &_fields) const {
-                    typedef typename layout_transform<typename array_of_fotf::value_type::inner_layoutmap,
-                        proc_layout_abs>::type proc_layout;
-                    const int ii_P = make_array(ii, jj, kk)[proc_layout::at(0)];
-                    const int jj_P = make_array(ii, jj, kk)[proc_layout::at(1)];
-                    const int kk_P = make_array(ii, jj, kk)[proc_layout::at(2)];
-                    if ((ii != 0 || jj != 0 || kk != 0) && (hm.pattern().proc_grid().proc(ii_P, jj_P, kk_P) != -1)) {
-                        for (unsigned int fi = 0; fi < _fields.size(); ++fi) {
-                            _fields[fi].pack(make_array(ii, jj, kk), _fields[fi].ptr, it);
-                        }
-                    }
-                }
-            };
-
-            template <int, int>
-            struct unpack_vector_dims {};
-
-            template <int dummy>
-            struct unpack_vector_dims<3, dummy> {
-
-                template <typename T, typename iterator, typename array_of_fotf>
-                void operator()(const T &hm, int ii, int jj, int kk, iterator &it, array_of_fotf const &_fields) const {
-                    typedef typename layout_transform<typename array_of_fotf::value_type::inner_layoutmap,
-                        proc_layout_abs>::type proc_layout;
-                    const int ii_P = make_array(ii, jj, kk)[proc_layout::at(0)];
-                    const int jj_P = make_array(ii, jj, kk)[proc_layout::at(1)];
-                    const int kk_P = make_array(ii, jj, kk)[proc_layout::at(2)];
-                    if ((ii != 0 || jj != 0 || kk != 0) && (hm.pattern().proc_grid().proc(ii_P, jj_P, kk_P) != -1)) {
-                        for (unsigned int fi = 0; fi < _fields.size(); ++fi) {
-                            _fields[fi].unpack(make_array(ii, jj, kk), _fields[fi].ptr, it);
-                        }
-                    }
-                }
-            };
+            template <class Fun>
+            static void for_each_neighbour(Fun const &fun) {
+                for (int ii = -1; ii <= 1; ++ii)
+                    for (int jj = -1; jj <= 1; ++jj)
+                        for (int kk = -1; kk <= 1; ++kk)
+                            if (ii != 0 || jj != 0 || kk != 0)
+                                fun(make_array(ii, jj, kk));
+            }
+
+            // the neighbour in the direction `eta` of the field exists in the process grid
+            template <class Field>
+            bool has_neighbour(Field const &, array<int, DIMS> const &eta) const {
+                typedef typename layout_transform<typename Field::inner_layoutmap, proc_layout_abs>::type proc_layout;
+                return this->pattern().proc_grid().proc(
+                           eta[proc_layout::at(0)], eta[proc_layout::at(1)], eta[proc_layout::at(2)]) != -1;
+            }
         };
 
 #ifdef GT_CUDACC
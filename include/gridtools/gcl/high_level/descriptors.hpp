@@ -24,6 +24,9 @@
 #include "access.hpp"
 #include "descriptor_base.hpp"
 #include "empty_field_base.hpp"
+#include "halo_datatypes.hpp"
+#include "halo_packer.hpp"
+#include "shared_halo_window.hpp"
 #include "helpers_impl.hpp"
 
 namespace gridtools {
@@ -175,6 +178,8 @@ namespace gridtools {
             */
             explicit field_descriptor_no_dt(DataType *_fp) : fieldptr(_fp) {}
 
+            DataType *data() const { return fieldptr; }
+
             /** void pack(gridtools::array<int, D> const& eta, iterator &it)
                 Pack the elements to be sent using the iterator passed in. At the end
                 the iterator points to the element next to the last inserted. In inout
@@ -227,6 +232,7 @@ namespace gridtools {
 
             array<DataType *, static_pow3(DIMS)> send_buffer; // One entry will not be used...
             array<DataType *, static_pow3(DIMS)> recv_buffer;
+            mutable halo_packer<> m_packer;
 
           public:
             typedef descriptor_base<HaloExch> base_type;
@@ -353,6 +359,13 @@ namespace gridtools {
             */
             pattern_type const &pattern() const { return base_type::m_haloexch; }
 
+            /**
+               The volume and the duration of the pack and unpack phases
+            */
+            pack_statistics const &statistics() const { return m_packer.statistics(); }
+
+            void reset_statistics() { m_packer.reset_statistics(); }
+
             // FRIENDING
             friend class allocation_service<this_type>;
             friend class pack_service<this_type>;
@@ -385,6 +398,14 @@ namespace gridtools {
             array<DataType *, static_pow3(DIMS)> recv_buffer;
             array<int, static_pow3(DIMS)> send_size;
             array<int, static_pow3(DIMS)> recv_size;
+            mutable halo_packer<> m_packer;
+            mutable halo_datatypes<DataType> m_datatypes;
+            zero_copy_policy m_zero_copy = zero_copy_policy::never;
+            array<bool, static_pow3(DIMS)> m_recv_in_place{}; // as registered by the last pack
+            int m_max_fields = 0;
+            bool m_shared_memory = false;
+            shared_halo_window m_shared;
+            array<int, static_pow3(DIMS)> m_shared_neighbour{}; // the node rank of the neighbour, -1 if remote
 
           public:
             typedef cpu arch_type;
@@ -442,7 +463,29 @@ namespace gridtools {
 
                \param max_fields_n Maximum number of data fields that will be passed to the communication functions
             */
-            void setup(int max_fields_n) { allocation_service<this_type>()(this, max_fields_n); }
+            void setup(int max_fields_n) {
+                m_max_fields = max_fields_n;
+                allocation_service<this_type>()(this, max_fields_n);
+                for (int ii = -1; ii <= 1; ++ii)
+                    for (int jj = -1; jj <= 1; ++jj)
+                        for (int kk = -1; kk <= 1; ++kk)
+                            if (ii != 0 || jj != 0 || kk != 0)
+                                m_datatypes.setup(halo.halos, make_array(ii, jj, kk), translate()(ii, jj, kk));
+            }
+
+            /**
+               Selects whether the halos are sent and received in place with MPI derived datatypes instead of the
+               pack and unpack buffers, see gcl::zero_copy_policy. Not to be called between pack and unpack.
+            */
+            void set_zero_copy(zero_copy_policy policy) { m_zero_copy = policy; }
+
+            /**
+               Selects whether the halos of the neighbours on the same node are exchanged through an MPI-3 shared
+               memory window instead of MPI messages: the neighbour unpacks directly from the buffer packed for it.
+               All the processes must make the same choice, the window is allocated by the next pack. Not to be
+               called between pack and unpack.
+            */
+            void set_shared_memory(bool enable) { m_shared_memory = enable; }
 
             /**
                Function to pack data to be sent
@@ -451,7 +494,7 @@ namespace gridtools {
             */
             template <typename... FIELDS>
             void pack(const FIELDS &... _fields) {
-                pack_dims<DIMS, 0>()(*this, _fields...);
+                pack_fields(array<DataType const *, sizeof...(FIELDS)>{_fields...});
             }
 
             /**
@@ -461,7 +504,7 @@ namespace gridtools {
             */
             template <typename... FIELDS>
             void unpack(const FIELDS &... _fields) const {
-                unpack_dims<DIMS, 0>()(*this, _fields...);
+                unpack_fields(array<DataType *, sizeof...(FIELDS)>{_fields...});
             }
 
             /**
@@ -469,14 +512,14 @@ namespace gridtools {
 
                \param[in] fields vector with data fields pointers to be packed from
             */
-            void pack(std::vector<DataType *> const &fields) { pack_vector_dims<DIMS, 0>()(*this, fields); }
+            void pack(std::vector<DataType *> const &fields) { pack_fields(fields); }
 
             /**
                Function to unpack received data
 
                \param[in] fields vector with data fields pointers to be unpacked into
             */
-            void unpack(std::vector<DataType *> const &fields) { unpack_vector_dims<DIMS, 0>()(*this, fields); }
+            void unpack(std::vector<DataType *> const &fields) { unpack_fields(fields); }
 
             /// Utilities
 
@@ -491,138 +534,161 @@ namespace gridtools {
             */
             pattern_type const &pattern() const { return base_type::pattern(); }
 
+            /**
+               The volume and the duration of the pack and unpack phases
+            */
+            pack_statistics const &statistics() const { return m_packer.statistics(); }
+
+            void reset_statistics() { m_packer.reset_statistics(); }
+
             friend struct allocation_service<this_type>;
 
           private:
-            template <int I, int dummy>
-            struct pack_dims {};
-
-            template <int dummy>
-            struct pack_dims<3, dummy> {
-                template <typename T, typename... FIELDS>
-                void operator()(T &hm, const FIELDS &... _fields) const {
-#pragma omp parallel for schedule(dynamic, 1) collapse(3)
-                    for (int ii = -1; ii <= 1; ++ii) {
-                        for (int jj = -1; jj <= 1; ++jj) {
-                            for (int kk = -1; kk <= 1; ++kk) {
-                                typedef proc_layout map_type;
-                                const int ii_P = make_array(ii, jj, kk)[map_type::at(0)];
-                                const int jj_P = make_array(ii, jj, kk)[map_type::at(1)];
-                                const int kk_P = make_array(ii, jj, kk)[map_type::at(2)];
-                                if ((ii != 0 || jj != 0 || kk != 0) &&
-                                    (hm.pattern().proc_grid().proc(ii_P, jj_P, kk_P) != -1)) {
-                                    DataType *it = &(hm.send_buffer[translate()(ii, jj, kk)][0]);
-                                    hm.halo.pack_all(make_array(ii, jj, kk), it, _fields...);
-
-                                    hm.m_haloexch.set_send_to_size(
-                                        hm.send_size[translate()(ii, jj, kk)] * sizeof...(_fields) * sizeof(DataType),
-                                        ii_P,
-                                        jj_P,
-                                        kk_P);
-                                    hm.m_haloexch.set_receive_from_size(
-                                        hm.recv_size[translate()(ii, jj, kk)] * sizeof...(_fields) * sizeof(DataType),
-                                        ii_P,
-                                        jj_P,
-                                        kk_P);
-                                }
-                            }
-                        }
-                    }
-                }
-            };
-
-            template <int I, int dummy>
-            struct unpack_dims {};
-
-            template <int dummy>
-            struct unpack_dims<3, dummy> {
-                template <typename T, typename... FIELDS>
-                void operator()(const T &hm, const FIELDS &... _fields) const {
-#pragma omp parallel for schedule(dynamic, 1) collapse(3)
-                    for (int ii = -1; ii <= 1; ++ii) {
-                        for (int jj = -1; jj <= 1; ++jj) {
-                            for (int kk = -1; kk <= 1; ++kk) {
-                                typedef proc_layout map_type;
-                                const int ii_P = make_array(ii, jj, kk)[map_type::at(0)];
-                                const int jj_P = make_array(ii, jj, kk)[map_type::at(1)];
-                                const int kk_P = make_array(ii, jj, kk)[map_type::at(2)];
-                                if ((ii != 0 || jj != 0 || kk != 0) &&
-                                    (hm.pattern().proc_grid().proc(ii_P, jj_P, kk_P) != -1)) {
-                                    DataType *it = &(hm.recv_buffer[translate()(ii, jj, kk)][0]);
-                                    hm.halo.unpack_all(make_array(ii, jj, kk), it, _fields...);
-                                }
-                            }
+            template <class Fun>
+            void for_each_neighbour(Fun const &fun) const {
+                for (int ii = -1; ii <= 1; ++ii)
+                    for (int jj = -1; jj <= 1; ++jj)
+                        for (int kk = -1; kk <= 1; ++kk) {
+                            typedef proc_layout map_type;
+                            const int ii_P = make_array(ii, jj, kk)[map_type::at(0)];
+                            const int jj_P = make_array(ii, jj, kk)[map_type::at(1)];
+                            const int kk_P = make_array(ii, jj, kk)[map_type::at(2)];
+                            if ((ii != 0 || jj != 0 || kk != 0) && (pattern().proc_grid().proc(ii_P, jj_P, kk_P) != -1))
+                                fun(make_array(ii, jj, kk), make_array(ii_P, jj_P, kk_P));
                         }
-                    }
-                }
-            };
+            }
 
-            template <int I, int dummy>
-            struct pack_vector_dims {};
+            void set_sizes(int fields_n) {
+                for_each_neighbour([&](array<int, DIMS> const &eta, array<int, DIMS> const &eta_P) {
+                    int index = translate()(eta[0], eta[1], eta[2]);
+                    base_type::m_haloexch.set_send_to_size(
+                        send_size[index] * fields_n * sizeof(DataType), eta_P[0], eta_P[1], eta_P[2]);
+                    base_type::m_haloexch.set_receive_from_size(
+                        recv_size[index] * fields_n * sizeof(DataType), eta_P[0], eta_P[1], eta_P[2]);
+                });
+            }
 
-            template <int dummy>
-            struct pack_vector_dims<3, dummy> {
-                template <typename T>
-                void operator()(T &hm, std::vector<DataType *> const &fields) const {
-#pragma omp parallel for schedule(dynamic, 1) collapse(3)
-                    for (int ii = -1; ii <= 1; ++ii) {
-                        for (int jj = -1; jj <= 1; ++jj) {
-                            for (int kk = -1; kk <= 1; ++kk) {
-                                typedef proc_layout map_type;
-                                const int ii_P = make_array(ii, jj, kk)[map_type::at(0)];
-                                const int jj_P = make_array(ii, jj, kk)[map_type::at(1)];
-                                const int kk_P = make_array(ii, jj, kk)[map_type::at(2)];
-                                if ((ii != 0 || jj != 0 || kk != 0) &&
-                                    (hm.pattern().proc_grid().proc(ii_P, jj_P, kk_P) != -1)) {
-                                    DataType *it = &(hm.send_buffer[translate()(ii, jj, kk)][0]);
-                                    for (size_t i = 0; i < fields.size(); ++i) {
-                                        hm.halo.pack(make_array(ii, jj, kk), fields[i], it);
-                                    }
-
-                                    hm.m_haloexch.set_send_to_size(
-                                        hm.send_size[translate()(ii, jj, kk)] * fields.size() * sizeof(DataType),
-                                        ii_P,
-                                        jj_P,
-                                        kk_P);
-                                    hm.m_haloexch.set_receive_from_size(
-                                        hm.recv_size[translate()(ii, jj, kk)] * fields.size() * sizeof(DataType),
-                                        ii_P,
-                                        jj_P,
-                                        kk_P);
-                                }
-                            }
-                        }
-                    }
-                }
-            };
+            /*
+             * Registers either the buffer or the datatype of the fields in place for both sides of the direction.
+             */
+            template <class Fields>
+            bool register_in_place(Fields const &fields, array<int, DIMS> const &eta, array<int, DIMS> const &eta_P) {
+                using datatypes_t = halo_datatypes<DataType>;
+                int index = translate()(eta[0], eta[1], eta[2]);
+                int n = fields.size();
+                auto policy = n ? m_zero_copy : zero_copy_policy::never;
+                auto &&exch = base_type::m_haloexch;
+                if (policy == zero_copy_policy::automatic && m_datatypes.needs_calibration(datatypes_t::send, index))
+                    m_datatypes.calibrate(datatypes_t::send,
+                        index,
+                        *fields.begin(),
+                        halo.halos,
+                        eta,
+                        send_buffer[index],
+                        send_size[index] * sizeof(DataType),
+                        pattern().proc_grid().communicator());
+                bool send_in_place = m_datatypes.in_place(datatypes_t::send, index, policy);
+                int bytes = send_size[index] * n * sizeof(DataType);
+                if (send_in_place)
+                    exch.register_send_to_datatype(*fields.begin(),
+                        m_datatypes.fields_type(datatypes_t::send, index, fields),
+                        bytes,
+                        eta_P[0],
+                        eta_P[1],
+                        eta_P[2]);
+                else
+                    exch.register_send_to_buffer(send_buffer[index], bytes, eta_P[0], eta_P[1], eta_P[2]);
+                m_recv_in_place[index] = m_datatypes.in_place(datatypes_t::recv, index, policy);
+                bytes = recv_size[index] * n * sizeof(DataType);
+                if (m_recv_in_place[index])
+                    exch.register_receive_from_datatype(const_cast<DataType *>(*fields.begin()),
+                        m_datatypes.fields_type(datatypes_t::recv, index, fields),
+                        bytes,
+                        eta_P[0],
+                        eta_P[1],
+                        eta_P[2]);
+                else
+                    exch.register_receive_from_buffer(recv_buffer[index], bytes, eta_P[0], eta_P[1], eta_P[2]);
+                return send_in_place;
+            }
 
-            template <int I, int dummy>
-            struct unpack_vector_dims {};
+            bool is_shared(int index) const { return m_shared_memory && m_shared_neighbour[index] != -1; }
+
+            void setup_shared_memory() {
+                m_shared.init(pattern().proc_grid().communicator());
+                array<std::size_t, static_pow3(DIMS)> capacities{};
+                for (auto &rank : m_shared_neighbour)
+                    rank = -1;
+                for_each_neighbour([&](array<int, DIMS> const &eta, array<int, DIMS> const &eta_P) {
+                    int index = translate()(eta[0], eta[1], eta[2]);
+                    int rank = pattern().proc_grid().proc(eta_P[0], eta_P[1], eta_P[2]);
+                    m_shared_neighbour[index] = m_shared.node_rank(rank);
+                    if (m_shared_neighbour[index] != -1)
+                        capacities[index] = send_size[index] * m_max_fields * sizeof(DataType);
+                });
+                m_shared.allocate(capacities);
+            }
 
-            template <int dummy>
-            struct unpack_vector_dims<3, dummy> {
-                template <typename T>
-                void operator()(const T &hm, std::vector<DataType *> const &fields) const {
-#pragma omp parallel for schedule(dynamic, 1) collapse(3)
-                    for (int ii = -1; ii <= 1; ++ii) {
-                        for (int jj = -1; jj <= 1; ++jj) {
-                            for (int kk = -1; kk <= 1; ++kk) {
-                                typedef proc_layout map_type;
-                                const int ii_P = make_array(ii, jj, kk)[map_type::at(0)];
-                                const int jj_P = make_array(ii, jj, kk)[map_type::at(1)];
-                                const int kk_P = make_array(ii, jj, kk)[map_type::at(2)];
-                                if ((ii != 0 || jj != 0 || kk != 0) &&
-                                    (hm.pattern().proc_grid().proc(ii_P, jj_P, kk_P) != -1)) {
-                                    DataType *it = &(hm.recv_buffer[translate()(ii, jj, kk)][0]);
-                                    for (size_t i = 0; i < fields.size(); ++i) {
-                                        hm.halo.unpack(make_array(ii, jj, kk), fields[i], it);
-                                    }
-                                }
-                            }
-                        }
-                    }
+            template <class Fields>
+            void pack_fields(Fields const &fields) {
+                set_sizes(fields.size());
+                if (m_shared_memory) {
+                    if (!m_shared.allocated())
+                        setup_shared_memory();
+                    m_shared.next_exchange();
                 }
-            };
+                for_each_neighbour([&](array<int, DIMS> const &eta, array<int, DIMS> const &eta_P) {
+                    int index = translate()(eta[0], eta[1], eta[2]);
+                    DataType *it = send_buffer[index];
+                    if (is_shared(index)) {
+                        // nothing goes through the messages
+                        base_type::m_haloexch.register_send_to_buffer(it, 0, eta_P[0], eta_P[1], eta_P[2]);
+                        base_type::m_haloexch.register_receive_from_buffer(
+                            recv_buffer[index], 0, eta_P[0], eta_P[1], eta_P[2]);
+                        m_recv_in_place[index] = false;
+                        it = reinterpret_cast<DataType *>(m_shared.send_buffer(index));
+                    } else if (register_in_place(fields, eta, eta_P))
+                        return;
+                    for (auto field : fields)
+                        m_packer.schedule_pack(field, halo.halos, eta, it);
+                });
+                m_packer.run();
+                if (m_shared_memory)
+                    m_shared.publish();
+            }
+
+            template <class Fields>
+            void unpack_fields(Fields const &fields) const {
+                using datatypes_t = halo_datatypes<DataType>;
+                for_each_neighbour([&](array<int, DIMS> const &eta, array<int, DIMS> const &) {
+                    int index = translate()(eta[0], eta[1], eta[2]);
+                    if (m_recv_in_place[index])
+                        return;
+                    DataType *it = recv_buffer[index];
+                    if (is_shared(index))
+                        // the neighbour packed its box in the opposite direction
+                        it = reinterpret_cast<DataType *>(const_cast<char *>(m_shared.recv_buffer(
+                            m_shared_neighbour[index], translate()(-eta[0], -eta[1], -eta[2]))));
+                    for (auto field : fields)
+                        m_packer.schedule_unpack(field, halo.halos, eta, it);
+                });
+                m_packer.run();
+                if (m_zero_copy != zero_copy_policy::automatic || fields.size() == 0)
+                    return;
+                for_each_neighbour([&](array<int, DIMS> const &eta, array<int, DIMS> const &) {
+                    int index = translate()(eta[0], eta[1], eta[2]);
+                    if (!m_recv_in_place[index] && !is_shared(index) &&
+                        m_datatypes.needs_calibration(datatypes_t::recv, index))
+                        m_datatypes.calibrate(datatypes_t::recv,
+                            index,
+                            *fields.begin(),
+                            halo.halos,
+                            eta,
+                            recv_buffer[index],
+                            recv_size[index] * sizeof(DataType),
+                            pattern().proc_grid().communicator());
+                });
+            }
 
             template <int D, int Dummy>
             struct _destroy_dynamic_ut {};
@@ -0,0 +1,231 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+#include <mpi.h>
+
+#include "../../common/array.hpp"
+#include "../../common/halo_descriptor.hpp"
+#include "halo_packer.hpp"
+
+/**
+ *  @file
+ *  MPI derived datatypes that describe the halo boxes of the fields in place, used by the CPU halo exchange to send
+ *  from and to receive into the fields directly instead of going through the pack and unpack buffers.
+ */
+
+namespace gridtools {
+    namespace gcl {
+        /**
+         *  When the halo exchange sends and receives the halo boxes in place with MPI derived datatypes:
+         *    - never: the boxes are always packed into (unpacked from) the communication buffers;
+         *    - automatic: per direction and per side, the boxes that are contiguous in memory go in place; for the
+         *      others, the cost of packing is measured at the first exchange against the cost of the MPI datatype
+         *      engine on the same box (`MPI_Pack`/`MPI_Unpack`) and the cheaper one is kept;
+         *    - always: all the boxes go in place.
+         *
+         *  The choice is local to the process: the datatypes are built from `MPI_CHAR`, so they match the plain
+         *  buffers of the neighbours. When a box is received in place, the fields given to `unpack` must be the ones
+         *  given to `pack`.
+         */
+        enum class zero_copy_policy { never, automatic, always };
+
+        /**
+         *  The datatypes of the halo boxes of the elements of type `T`, for the 27 directions and the two sides (the
+         *  box sent to the neighbour and the box received from it), and the per direction decisions of the automatic
+         *  policy. The datatypes of several fields are cached for the last set of fields.
+         */
+        template <class T>
+        class halo_datatypes {
+            enum class decision { unknown, pack, in_place };
+
+            struct entry {
+                MPI_Datatype box = MPI_DATATYPE_NULL;    // the box of one field
+                MPI_Datatype fields = MPI_DATATYPE_NULL; // the boxes of the fields at ptrs
+                std::vector<char const *> ptrs;
+                decision choice = decision::unknown;
+                bool contiguous = false;
+            };
+
+            entry m_entries[2][27];
+
+            static void free(MPI_Datatype &type) {
+                if (type != MPI_DATATYPE_NULL)
+                    MPI_Type_free(&type);
+            }
+
+            template <class Bound>
+            static void make_box(
+                entry &e, array<halo_descriptor, 3> const &halos, array<int, 3> const &eta, Bound bound) {
+                int sizes[3], subsizes[3], starts[3];
+                for (int d = 0; d < 3; ++d) {
+                    int lower, upper;
+                    bound(halos[d], eta[d], lower, upper);
+                    sizes[d] = halos[d].total_length();
+                    subsizes[d] = std::max(upper - lower + 1, 0);
+                    starts[d] = lower;
+                }
+                // a single block if the box is flat above its first partial dimension
+                int partial = 0;
+                while (partial < 3 && subsizes[partial] == sizes[partial])
+                    ++partial;
+                e.contiguous = true;
+                for (int d = partial + 1; d < 3; ++d)
+                    e.contiguous = e.contiguous && subsizes[d] <= 1;
+                if (subsizes[0] * subsizes[1] * subsizes[2] == 0)
+                    return;
+                MPI_Datatype element;
+                MPI_Type_contiguous(sizeof(T), MPI_CHAR, &element);
+                MPI_Type_create_subarray(3, sizes, subsizes, starts, MPI_ORDER_FORTRAN, element, &e.box);
+                MPI_Type_commit(&e.box);
+                MPI_Type_free(&element);
+            }
+
+            template <class Fields>
+            static bool same_fields(entry const &e, Fields const &fields) {
+                if (e.ptrs.size() != fields.size())
+                    return false;
+                std::size_t i = 0;
+                for (auto field : fields)
+                    if (e.ptrs[i++] != reinterpret_cast<char const *>(field))
+                        return false;
+                return true;
+            }
+
+            template <class F>
+            static double seconds(F &&f) {
+                double res = 0;
+                for (int rep = 0; rep < 3; ++rep) {
+                    auto start = std::chrono::steady_clock::now();
+                    f();
+                    double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                    res = rep ? std::min(res, t) : t;
+                }
+                return res;
+            }
+
+          public:
+            enum side { send = 0, recv = 1 };
+
+            halo_datatypes() = default;
+            halo_datatypes(halo_datatypes const &) = delete;
+            halo_datatypes &operator=(halo_datatypes const &) = delete;
+
+            ~halo_datatypes() {
+                int finalized;
+                MPI_Finalized(&finalized);
+                if (finalized)
+                    return;
+                for (auto &&entries : m_entries)
+                    for (auto &e : entries) {
+                        free(e.box);
+                        free(e.fields);
+                    }
+            }
+
+            /**
+             *  Builds the datatypes of the box sent to (`send`) and received from (`recv`) the neighbour `eta`.
+             */
+            void setup(array<halo_descriptor, 3> const &halos, array<int, 3> const &eta, int index) {
+                make_box(
+                    m_entries[send][index], halos, eta, [](halo_descriptor const &h, int e, int &lower, int &upper) {
+                        lower = h.loop_low_bound_inside(e);
+                        upper = h.loop_high_bound_inside(e);
+                    });
+                make_box(
+                    m_entries[recv][index], halos, eta, [](halo_descriptor const &h, int e, int &lower, int &upper) {
+                        lower = h.loop_low_bound_outside(e);
+                        upper = h.loop_high_bound_outside(e);
+                    });
+            }
+
+            /**
+             *  Whether the box of the direction `index` goes in place for the given policy.
+             */
+            bool in_place(side s, int index, zero_copy_policy policy) const {
+                entry const &e = m_entries[s][index];
+                if (policy == zero_copy_policy::never || e.box == MPI_DATATYPE_NULL)
+                    return false;
+                return policy == zero_copy_policy::always || e.contiguous || e.choice == decision::in_place;
+            }
+
+            /**
+             *  Whether the automatic policy still has to measure the box of the direction `index`.
+             */
+            bool needs_calibration(side s, int index) const {
+                entry const &e = m_entries[s][index];
+                return e.box != MPI_DATATYPE_NULL && !e.contiguous && e.choice == decision::unknown;
+            }
+
+            /**
+             *  Measures the packing of the box of one field against `MPI_Pack` (for `send`) or `MPI_Unpack` (for
+             *  `recv`) of its datatype, on the data that the exchange moves anyway: `buffer` holds (receives) the
+             *  packed box and both variants write the same values.
+             */
+            template <class Field>
+            void calibrate(side s,
+                int index,
+                Field *field,
+                array<halo_descriptor, 3> const &halos,
+                array<int, 3> const &eta,
+                T *buffer,
+                int buffer_size,
+                MPI_Comm comm) {
+                entry &e = m_entries[s][index];
+                halo_packer<> packer;
+                double pack_time = seconds([&] {
+                    T *it = buffer;
+                    if (s == send)
+                        packer.schedule_pack(field, halos, eta, it);
+                    else
+                        packer.schedule_unpack(const_cast<T *>(field), halos, eta, it);
+                    packer.run();
+                });
+                double mpi_time = seconds([&] {
+                    int position = 0;
+                    if (s == send)
+                        MPI_Pack(field, 1, e.box, buffer, buffer_size, &position, comm);
+                    else
+                        MPI_Unpack(buffer, buffer_size, &position, const_cast<T *>(field), 1, e.box, comm);
+                });
+                e.choice = mpi_time < pack_time ? decision::in_place : decision::pack;
+            }
+
+            /**
+             *  The datatype of the boxes of all the `fields` relative to the first one, rebuilt when the fields change.
+             */
+            template <class Fields>
+            MPI_Datatype fields_type(side s, int index, Fields const &fields) {
+                entry &e = m_entries[s][index];
+                if (same_fields(e, fields))
+                    return e.fields;
+                free(e.fields);
+                e.ptrs.clear();
+                std::vector<MPI_Aint> displacements;
+                MPI_Aint first;
+                MPI_Get_address(*fields.begin(), &first);
+                for (auto field : fields) {
+                    MPI_Aint address;
+                    MPI_Get_address(field, &address);
+                    displacements.push_back(address - first);
+                    e.ptrs.push_back(reinterpret_cast<char const *>(field));
+                }
+                MPI_Type_create_hindexed_block(displacements.size(), 1, displacements.data(), e.box, &e.fields);
+                MPI_Type_commit(&e.fields);
+                return e.fields;
+            }
+        };
+    } // namespace gcl
+} // namespace gridtools
@@ -0,0 +1,204 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#include "../../common/array.hpp"
+#include "../../common/halo_descriptor.hpp"
+#include "../../thread_pool/concept.hpp"
+#include "../../thread_pool/omp.hpp"
+
+/**
+ *  @file
+ *  The CPU engine that copies the halos of the fields between the fields and the communication buffers.
+ */
+
+namespace gridtools {
+    namespace gcl {
+        /**
+         *  The volume and the duration of the pack and the unpack phases of a halo exchange handler, accumulated
+         *  since the construction or the last reset.
+         */
+        struct pack_statistics {
+            std::size_t pack_bytes = 0;
+            double pack_seconds = 0;
+            std::size_t unpack_bytes = 0;
+            double unpack_seconds = 0;
+
+            // bytes per second
+            double pack_bandwidth() const { return pack_seconds > 0 ? pack_bytes / pack_seconds : 0; }
+            double unpack_bandwidth() const { return unpack_seconds > 0 ? unpack_bytes / unpack_seconds : 0; }
+        };
+
+        /**
+         *  Copies the halo boxes of several fields from the fields into the buffers of the neighbours (pack) or back
+         *  (unpack). The copies are first scheduled and then executed at once by `run`, in parallel over the
+         *  neighbours, the fields and the planes of the boxes (the outermost dimension). Within a plane the rows along
+         *  the unit stride dimension are copied by `memcpy`; the planes made of whole rows are copied at once.
+         *
+         *  The halos are given in the increasing stride order, as in `empty_field_no_dt`. The boxes are stored in
+         *  the buffers in the same order as by `empty_field_no_dt::pack`, so the result is interchangeable with it.
+         */
+        template <class ThreadPool = thread_pool::omp>
+        class halo_packer {
+            struct segment {
+                char *field;  // the origin of the field
+                char *buffer; // the position of the box in the buffer
+                std::size_t element_size;
+                array<int, 3> lower;
+                array<int, 3> sizes;
+                std::size_t stride1; // the strides of the field in elements
+                std::size_t stride2;
+                std::size_t first_plane; // the planes of the previous segments
+                bool is_pack;
+            };
+
+            std::vector<segment> m_segments;
+            std::size_t m_planes = 0;
+            pack_statistics m_statistics;
+
+            template <class Bound>
+            std::size_t schedule(char *field,
+                std::size_t element_size,
+                array<halo_descriptor, 3> const &halos,
+                array<int, 3> const &eta,
+                char *buffer,
+                bool is_pack,
+                Bound bound) {
+                segment s;
+                s.field = field;
+                s.buffer = buffer;
+                s.element_size = element_size;
+                s.stride1 = halos[0].total_length();
+                s.stride2 = s.stride1 * halos[1].total_length();
+                s.first_plane = m_planes;
+                s.is_pack = is_pack;
+                std::size_t size = 1;
+                for (int d = 0; d < 3; ++d) {
+                    int lower, upper;
+                    bound(halos[d], eta[d], lower, upper);
+                    s.lower[d] = lower;
+                    s.sizes[d] = std::max(upper - lower + 1, 0);
+                    size *= s.sizes[d];
+                }
+                if (size == 0)
+                    return 0;
+                m_segments.push_back(s);
+                m_planes += s.sizes[2];
+                return size * element_size;
+            }
+
+            static void copy_plane(segment const &s, int k) {
+                std::size_t row = s.sizes[0] * s.element_size;
+                std::size_t plane = s.sizes[1] * row;
+                char *buffer = s.buffer + k * plane;
+                char *field = s.field + ((s.lower[2] + k) * s.stride2 + s.lower[1] * s.stride1 + s.lower[0]) *
+                                            s.element_size;
+                if (s.sizes[0] == (int)s.stride1) {
+                    // whole rows, the plane is contiguous
+                    if (s.is_pack)
+                        std::memcpy(buffer, field, plane);
+                    else
+                        std::memcpy(field, buffer, plane);
+                    return;
+                }
+                std::size_t field_stride = s.stride1 * s.element_size;
+                for (int j = 0; j < s.sizes[1]; ++j, buffer += row, field += field_stride) {
+                    if (s.is_pack)
+                        std::memcpy(buffer, field, row);
+                    else
+                        std::memcpy(field, buffer, row);
+                }
+            }
+
+          public:
+            /**
+             *  Schedules the copy of the part of `field` that is sent to the neighbour `eta` into `buffer`, `buffer` is
+             *  advanced past the copied data.
+             */
+            template <class T, class Buffer>
+            void schedule_pack(
+                T const *field, array<halo_descriptor, 3> const &halos, array<int, 3> const &eta, Buffer *&buffer) {
+                reinterpret_cast<char *&>(buffer) += schedule(const_cast<char *>(reinterpret_cast<char const *>(field)),
+                    sizeof(T),
+                    halos,
+                    eta,
+                    reinterpret_cast<char *>(buffer),
+                    true,
+                    [](halo_descriptor const &h, int e, int &lower, int &upper) {
+                        lower = h.loop_low_bound_inside(e);
+                        upper = h.loop_high_bound_inside(e);
+                    });
+            }
+
+            /**
+             *  Schedules the copy of the part of `field` that is received from the neighbour `eta` from `buffer`,
+             *  `buffer` is advanced past the copied data.
+             */
+            template <class T, class Buffer>
+            void schedule_unpack(
+                T *field, array<halo_descriptor, 3> const &halos, array<int, 3> const &eta, Buffer *&buffer) {
+                reinterpret_cast<char *&>(buffer) += schedule(reinterpret_cast<char *>(field),
+                    sizeof(T),
+                    halos,
+                    eta,
+                    reinterpret_cast<char *>(buffer),
+                    false,
+                    [](halo_descriptor const &h, int e, int &lower, int &upper) {
+                        lower = h.loop_low_bound_outside(e);
+                        upper = h.loop_high_bound_outside(e);
+                    });
+            }
+
+            /**
+             *  Executes the scheduled copies and clears the schedule.
+             */
+            void run() {
+                auto start = std::chrono::steady_clock::now();
+                segment const *segments = m_segments.data();
+                std::size_t n = m_segments.size();
+                thread_pool::parallel_for_loop(
+                    ThreadPool(),
+                    [&](auto plane) {
+                        auto s = std::upper_bound(segments,
+                                     segments + n,
+                                     (std::size_t)plane,
+                                     [](std::size_t p, segment const &s) { return p < s.first_plane; }) -
+                                 1;
+                        copy_plane(*s, plane - s->first_plane);
+                    },
+                    (int)m_planes);
+                double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                bool has_pack = false, has_unpack = false;
+                for (auto &&s : m_segments) {
+                    std::size_t bytes = s.sizes[0] * s.sizes[1] * s.sizes[2] * s.element_size;
+                    (s.is_pack ? m_statistics.pack_bytes : m_statistics.unpack_bytes) += bytes;
+                    (s.is_pack ? has_pack : has_unpack) = true;
+                }
+                // a schedule is made either of packs or of unpacks by the handlers
+                if (has_pack)
+                    m_statistics.pack_seconds += seconds;
+                else if (has_unpack)
+                    m_statistics.unpack_seconds += seconds;
+                m_segments.clear();
+                m_planes = 0;
+            }
+
+            pack_statistics const &statistics() const { return m_statistics; }
+
+            void reset_statistics() { m_statistics = {}; }
+        };
+    } // namespace gcl
+} // namespace gridtools
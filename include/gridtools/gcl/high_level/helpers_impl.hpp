@@ -144,9 +144,12 @@ namespace gridtools {
                         for (int kk = -1; kk <= 1; ++kk)
                             if ((ii != 0 || jj != 0 || kk != 0) && (hm->pattern().proc_grid().proc(ii, jj, kk) != -1)) {
                                 Datatype *it = &(hm->send_buffer[translate()(ii, jj, kk)][0]);
-                                for (int df = 0; df < hm->size(); ++df)
-                                    hm->data_field(df).pack(make_array(ii, jj, kk), it);
+                                for (int df = 0; df < hm->size(); ++df) {
+                                    auto &&field = hm->data_field(df);
+                                    hm->m_packer.schedule_pack(field.data(), field.halos, make_array(ii, jj, kk), it);
+                                }
                             }
+                hm->m_packer.run();
             }
         };
 
@@ -162,9 +165,12 @@ namespace gridtools {
                         for (int kk = -1; kk <= 1; ++kk)
                             if ((ii != 0 || jj != 0 || kk != 0) && (hm->pattern().proc_grid().proc(ii, jj, kk) != -1)) {
                                 Datatype *it = &(hm->recv_buffer[translate()(ii, jj, kk)][0]);
-                                for (int df = 0; df < hm->size(); ++df)
-                                    hm->data_field(df).unpack(make_array(ii, jj, kk), it);
+                                for (int df = 0; df < hm->size(); ++df) {
+                                    auto &&field = hm->data_field(df);
+                                    hm->m_packer.schedule_unpack(field.data(), field.halos, make_array(ii, jj, kk), it);
+                                }
                             }
+                hm->m_packer.run();
             }
         };
     } // namespace gcl
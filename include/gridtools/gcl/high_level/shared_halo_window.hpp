@@ -0,0 +1,152 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <mpi.h>
+
+#include "../../common/array.hpp"
+
+/**
+ *  @file
+ *  The MPI-3 shared memory window through which the processes of the same node exchange their halos without
+ *  messages.
+ */
+
+namespace gridtools {
+    namespace gcl {
+        /**
+         *  The send buffers of the 27 directions of a process, allocated in a shared memory window of the processes of
+         *  its node (`MPI_Comm_split_type(MPI_COMM_TYPE_SHARED)`). A neighbour on the same node unpacks directly from
+         *  the buffer packed for it: no message and no receive buffer.
+         *
+         *  Each buffer is doubled and the exchanges alternate between the two halves, so that a single barrier per
+         *  exchange (`publish`, after the pack) is enough: a half is packed again two exchanges later, after the
+         *  neighbours went through the barrier of the next exchange, which they do after having unpacked.
+         */
+        class shared_halo_window {
+            static constexpr int slots = 2 * 27;
+            static constexpr std::size_t alignment = 64;
+
+            MPI_Comm m_node_comm = MPI_COMM_NULL;
+            MPI_Group m_group = MPI_GROUP_NULL;
+            MPI_Group m_node_group = MPI_GROUP_NULL;
+            MPI_Win m_win = MPI_WIN_NULL;
+            int m_node_rank = 0;
+            std::vector<char *> m_bases;     // the windows of the processes of the node
+            std::vector<MPI_Aint> m_offsets; // [node rank][half][direction]
+            int m_half = 0;
+
+            char *slot(int node_rank, int index) const {
+                return m_bases[node_rank] + m_offsets[node_rank * slots + m_half * 27 + index];
+            }
+
+          public:
+            shared_halo_window() = default;
+            shared_halo_window(shared_halo_window const &) = delete;
+            shared_halo_window &operator=(shared_halo_window const &) = delete;
+
+            ~shared_halo_window() {
+                int finalized;
+                MPI_Finalized(&finalized);
+                if (finalized)
+                    return;
+                if (m_win != MPI_WIN_NULL) {
+                    MPI_Win_unlock_all(m_win);
+                    MPI_Win_free(&m_win);
+                }
+                if (m_group != MPI_GROUP_NULL)
+                    MPI_Group_free(&m_group);
+                if (m_node_group != MPI_GROUP_NULL)
+                    MPI_Group_free(&m_node_group);
+                if (m_node_comm != MPI_COMM_NULL)
+                    MPI_Comm_free(&m_node_comm);
+            }
+
+            /**
+             *  Finds the processes of `comm` on the node of the caller. Collective over `comm`.
+             */
+            void init(MPI_Comm comm) {
+                MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &m_node_comm);
+                MPI_Comm_rank(m_node_comm, &m_node_rank);
+                MPI_Comm_group(comm, &m_group);
+                MPI_Comm_group(m_node_comm, &m_node_group);
+            }
+
+            bool initialized() const { return m_node_comm != MPI_COMM_NULL; }
+
+            /**
+             *  The rank in the node of the process `rank` of the communicator given to `init`, -1 if it is on another
+             *  node.
+             */
+            int node_rank(int rank) const {
+                int res;
+                MPI_Group_translate_ranks(m_group, 1, &rank, m_node_group, &res);
+                return res == MPI_UNDEFINED ? -1 : res;
+            }
+
+            /**
+             *  Allocates the window with the capacities in bytes of the send buffers of the directions. Collective
+             *  over the node.
+             */
+            void allocate(array<std::size_t, 27> const &capacities) {
+                std::vector<MPI_Aint> offsets(slots);
+                MPI_Aint total = 0;
+                for (int half = 0; half < 2; ++half)
+                    for (int index = 0; index < 27; ++index) {
+                        offsets[half * 27 + index] = total;
+                        total += (capacities[index] + alignment - 1) / alignment * alignment;
+                    }
+                char *base;
+                MPI_Win_allocate_shared(total, 1, MPI_INFO_NULL, m_node_comm, &base, &m_win);
+                int size;
+                MPI_Comm_size(m_node_comm, &size);
+                m_offsets.resize(size * slots);
+                MPI_Allgather(offsets.data(), slots, MPI_AINT, m_offsets.data(), slots, MPI_AINT, m_node_comm);
+                m_bases.resize(size);
+                for (int rank = 0; rank < size; ++rank) {
+                    MPI_Aint bytes;
+                    int disp_unit;
+                    MPI_Win_shared_query(m_win, rank, &bytes, &disp_unit, &m_bases[rank]);
+                }
+                MPI_Win_lock_all(MPI_MODE_NOCHECK, m_win);
+            }
+
+            bool allocated() const { return m_win != MPI_WIN_NULL; }
+
+            /**
+             *  Switches to the other half of the buffers, at the beginning of the pack.
+             */
+            void next_exchange() { m_half ^= 1; }
+
+            /**
+             *  The buffer of the caller for the direction `index`.
+             */
+            char *send_buffer(int index) const { return slot(m_node_rank, index); }
+
+            /**
+             *  The buffer of the process `node_rank` for its direction `index`.
+             */
+            char const *recv_buffer(int node_rank, int index) const { return slot(node_rank, index); }
+
+            /**
+             *  Makes the packed buffers of the node visible to their readers, at the end of the pack. Collective over
+             *  the node.
+             */
+            void publish() const {
+                MPI_Win_sync(m_win);
+                MPI_Barrier(m_node_comm);
+                MPI_Win_sync(m_win);
+            }
+        };
+    } // namespace gcl
+} // namespace gridtools
@@ -9,6 +9,9 @@
  */
 #pragma once
 
+#include <algorithm>
+#include <vector>
+
 #include "../../common/defs.hpp"
 #include "../GCL.hpp"
 #include "translate.hpp"
@@ -65,6 +68,17 @@
 
 namespace gridtools {
     namespace gcl {
+        /**
+         * The way Halo_Exchange_3D moves the buffers:
+         *  - point_to_point: `MPI_Irecv`/`MPI_Isend` for every neighbour at every exchange;
+         *  - persistent: `MPI_Recv_init`/`MPI_Send_init` requests created once for the registered buffers (and
+         *    recreated when a buffer or a size changes), started with `MPI_Startall` and completed with `MPI_Waitall`;
+         *  - neighbor_collective: a single `MPI_Ineighbor_alltoallw` on a distributed graph communicator that connects
+         *    the process to its (up to 26) neighbours. The receives are not posted separately, `post_receives` does
+         *    nothing and `do_sends` starts the whole exchange.
+         */
+        enum class exchange_mode { point_to_point, persistent, neighbor_collective };
+
         /** \class Halo_Exchange_3D
          * Class to instantiate, define and run a regular cyclic and acyclic
          * halo exchange pattern in 3D.  By regular it is intended that the
@@ -149,8 +163,11 @@ namespace gridtools {
             class sr_buffers {
                 char *m_buffers[27]; // there is ona buffer more to allow for a simple indexing
                 int m_size[27];      // Sizes in bytes
+                MPI_Datatype m_types[27]; // MPI_DATATYPE_NULL for the plain buffers of m_size bytes
               public:
                 explicit sr_buffers() {
+                    for (auto &t : m_types)
+                        t = MPI_DATATYPE_NULL;
                     m_buffers[0] = nullptr;
                     m_buffers[1] = nullptr;
                     m_buffers[2] = nullptr;
@@ -209,6 +226,16 @@ namespace gridtools {
                 }
 
                 char *&buffer(int I, int J, int K) { return m_buffers[translate()(I, J, K)]; }
+                char *buffer(int n) const { return m_buffers[n]; }
+                int size(int n) const { return m_size[n]; }
+                MPI_Datatype &type(int I, int J, int K) { return m_types[translate()(I, J, K)]; }
+                MPI_Datatype type(int n) const { return m_types[n]; }
+
+                // the arguments of the MPI calls: a single element of the derived datatype or the bytes of the buffer
+                int count(int n) const { return m_types[n] == MPI_DATATYPE_NULL || !m_size[n] ? m_size[n] : 1; }
+                MPI_Datatype mpi_type(int n) const { return m_types[n] == MPI_DATATYPE_NULL ? MPI_CHAR : m_types[n]; }
+                int count(int I, int J, int K) const { return count(translate()(I, J, K)); }
+                MPI_Datatype mpi_type(int I, int J, int K) const { return mpi_type(translate()(I, J, K)); }
                 int &size(int I, int J, int K) { return m_size[translate()(I, J, K)]; }
                 int size(int I, int J, int K) const { return m_size[translate()(I, J, K)]; }
             };
@@ -245,12 +272,174 @@ namespace gridtools {
 
             const PROC_GRID /*&*/ m_proc_grid;
 
+            exchange_mode m_mode = exchange_mode::point_to_point;
+
+            // persistent mode: the requests and the buffers they were created for, per side (receive, send)
+            static constexpr int recv_side = 0;
+            static constexpr int send_side = 1;
+            std::vector<MPI_Request> m_persistent_requests[2];
+            char *m_persistent_buffers[2][27] = {};
+            int m_persistent_sizes[2][27] = {};
+            MPI_Datatype m_persistent_types[2][27] = {};
+            bool m_has_persistent[2] = {};
+
+            // neighbor_collective mode: the graph communicator and the arguments of the collective, the displacements
+            // are the absolute addresses of the buffers
+            MPI_Comm m_neighbor_comm = MPI_COMM_NULL;
+            std::vector<int> m_neighbor_destinations; // the destinations as directions, in the order of the graph
+            std::vector<int> m_neighbor_sources;      // the receive buffers of the sources, in the order of the graph
+            std::vector<int> m_send_counts;
+            std::vector<int> m_recv_counts;
+            std::vector<MPI_Aint> m_send_displs;
+            std::vector<MPI_Aint> m_recv_displs;
+            std::vector<MPI_Datatype> m_send_types;
+            std::vector<MPI_Datatype> m_recv_types;
+            MPI_Request m_neighbor_request = MPI_REQUEST_NULL;
+
+            static int tag(int I, int J, int K) { return (K + 1) * 9 + (I + 1) * 3 + J + 1; }
+
+            template <class Fun>
+            void for_each_neighbour(Fun &&fun) const {
+                for (int i = -1; i <= 1; ++i)
+                    for (int j = -1; j <= 1; ++j)
+                        for (int k = -1; k <= 1; ++k)
+                            if ((i || j || k) && m_proc_grid.proc(i, j, k) != -1)
+                                fun(i, j, k);
+            }
+
+            sr_buffers &buffers(int side) { return side == recv_side ? m_recv_buffers : m_send_buffers; }
+            sr_buffers const &buffers(int side) const { return side == recv_side ? m_recv_buffers : m_send_buffers; }
+
+            void free_persistent(int side) {
+                for (auto &r : m_persistent_requests[side])
+                    MPI_Request_free(&r);
+                m_persistent_requests[side].clear();
+                m_has_persistent[side] = false;
+            }
+
+            void free_persistent() {
+                free_persistent(recv_side);
+                free_persistent(send_side);
+            }
+
+            bool persistent_up_to_date(int side) const {
+                if (!m_has_persistent[side])
+                    return false;
+                auto const &bufs = buffers(side);
+                for (int n = 0; n < 27; ++n)
+                    if (m_persistent_buffers[side][n] != bufs.buffer(n) ||
+                        m_persistent_sizes[side][n] != bufs.size(n) || m_persistent_types[side][n] != bufs.type(n))
+                        return false;
+                return true;
+            }
+
+            /*
+             * The same messages as post_receive/perform_isend, created once. The two sides are prepared separately:
+             * the receives are (re)created only by post_receives and the sends only by do_sends, so that do_sends
+             * never frees receive requests that are already started.
+             */
+            void prepare_persistent(int side) {
+                if (persistent_up_to_date(side))
+                    return;
+                free_persistent(side);
+                auto &bufs = buffers(side);
+                auto &requests = m_persistent_requests[side];
+                for_each_neighbour([&](int i, int j, int k) {
+                    if (!bufs.size(i, j, k))
+                        return;
+                    requests.emplace_back();
+                    if (side == recv_side)
+                        MPI_Recv_init(bufs.buffer(i, j, k),
+                            bufs.count(i, j, k),
+                            bufs.mpi_type(i, j, k),
+                            m_proc_grid.proc(i, j, k),
+                            tag(-i, -j, -k),
+                            m_proc_grid.communicator(),
+                            &requests.back());
+                    else
+                        MPI_Send_init(bufs.buffer(i, j, k),
+                            bufs.count(i, j, k),
+                            bufs.mpi_type(i, j, k),
+                            m_proc_grid.proc(i, j, k),
+                            tag(i, j, k),
+                            m_proc_grid.communicator(),
+                            &requests.back());
+                });
+                for (int n = 0; n < 27; ++n) {
+                    m_persistent_buffers[side][n] = bufs.buffer(n);
+                    m_persistent_sizes[side][n] = bufs.size(n);
+                    m_persistent_types[side][n] = bufs.type(n);
+                }
+                m_has_persistent[side] = true;
+            }
+
+            /*
+             * The graph has an edge per neighbour direction, a process may appear several times (periodic dimensions
+             * with one or two processes). The messages between two processes are matched in the order of the edges,
+             * so the sources are listed in the reverse order of the directions: the k-th message sent from p to q in
+             * the direction d lands in the buffer of q for the direction -d.
+             */
+            void start_neighbor_collective() {
+                if (m_neighbor_comm == MPI_COMM_NULL) {
+                    std::vector<int> destinations, sources;
+                    for_each_neighbour([&](int i, int j, int k) {
+                        destinations.push_back(m_proc_grid.proc(i, j, k));
+                        m_neighbor_destinations.push_back(translate()(i, j, k));
+                    });
+                    for (int i = 1; i >= -1; --i)
+                        for (int j = 1; j >= -1; --j)
+                            for (int k = 1; k >= -1; --k)
+                                if ((i || j || k) && m_proc_grid.proc(i, j, k) != -1) {
+                                    sources.push_back(m_proc_grid.proc(i, j, k));
+                                    m_neighbor_sources.push_back(translate()(i, j, k));
+                                }
+                    MPI_Dist_graph_create_adjacent(m_proc_grid.communicator(),
+                        sources.size(),
+                        sources.data(),
+                        MPI_UNWEIGHTED,
+                        destinations.size(),
+                        destinations.data(),
+                        MPI_UNWEIGHTED,
+                        MPI_INFO_NULL,
+                        false,
+                        &m_neighbor_comm);
+                    m_send_counts.resize(destinations.size());
+                    m_send_displs.resize(destinations.size());
+                    m_recv_counts.resize(sources.size());
+                    m_recv_displs.resize(sources.size());
+                    m_send_types.resize(destinations.size());
+                    m_recv_types.resize(sources.size());
+                }
+                for (size_t n = 0; n != m_neighbor_destinations.size(); ++n) {
+                    int b = m_neighbor_destinations[n];
+                    m_send_counts[n] = m_send_buffers.buffer(b) ? m_send_buffers.count(b) : 0;
+                    m_send_types[n] = m_send_buffers.mpi_type(b);
+                    MPI_Get_address(m_send_buffers.buffer(b), &m_send_displs[n]);
+                }
+                for (size_t n = 0; n != m_neighbor_sources.size(); ++n) {
+                    int b = m_neighbor_sources[n];
+                    m_recv_counts[n] = m_recv_buffers.buffer(b) ? m_recv_buffers.count(b) : 0;
+                    m_recv_types[n] = m_recv_buffers.mpi_type(b);
+                    MPI_Get_address(m_recv_buffers.buffer(b), &m_recv_displs[n]);
+                }
+                MPI_Ineighbor_alltoallw(MPI_BOTTOM,
+                    m_send_counts.data(),
+                    m_send_displs.data(),
+                    m_send_types.data(),
+                    MPI_BOTTOM,
+                    m_recv_counts.data(),
+                    m_recv_displs.data(),
+                    m_recv_types.data(),
+                    m_neighbor_comm,
+                    &m_neighbor_request);
+            }
+
             template <int I, int J, int K>
             void post_receive() {
                 if (m_recv_buffers.size(I, J, K)) {
                     MPI_Irecv(static_cast<char *>(m_recv_buffers.buffer(I, J, K)),
-                        m_recv_buffers.size(I, J, K),
-                        MPI_CHAR,
+                        m_recv_buffers.count(I, J, K),
+                        m_recv_buffers.mpi_type(I, J, K),
                         m_proc_grid.template proc<I, J, K>(),
                         TAG<-I, -J, -K>::value,
                         m_proc_grid.communicator(),
@@ -262,8 +451,8 @@ namespace gridtools {
             void perform_isend() {
                 if (m_send_buffers.size(I, J, K)) {
                     MPI_Isend(static_cast<char *>(m_send_buffers.buffer(I, J, K)),
-                        m_send_buffers.size(I, J, K),
-                        MPI_CHAR,
+                        m_send_buffers.count(I, J, K),
+                        m_send_buffers.mpi_type(I, J, K),
                         m_proc_grid.template proc<I, J, K>(),
                         TAG<I, J, K>::value,
                         m_proc_grid.communicator(),
@@ -308,6 +497,30 @@ namespace gridtools {
             explicit Halo_Exchange_3D(PROC_GRID /*const&*/ _pg)
                 : m_send_buffers(), m_recv_buffers(), request(), send_request(), m_proc_grid(_pg) {}
 
+            Halo_Exchange_3D(Halo_Exchange_3D const &) = delete;
+            Halo_Exchange_3D &operator=(Halo_Exchange_3D const &) = delete;
+
+            ~Halo_Exchange_3D() {
+                int finalized;
+                MPI_Finalized(&finalized);
+                if (finalized)
+                    return;
+                free_persistent();
+                if (m_neighbor_comm != MPI_COMM_NULL)
+                    MPI_Comm_free(&m_neighbor_comm);
+            }
+
+            /** Selects how the buffers are exchanged, see gcl::exchange_mode. Must be called by all the processes in
+                the grid with the same mode, not while an exchange is in progress.
+            */
+            void set_exchange_mode(exchange_mode mode) {
+                if (mode != exchange_mode::persistent)
+                    free_persistent();
+                m_mode = mode;
+            }
+
+            exchange_mode get_exchange_mode() const { return m_mode; }
+
             /** Function to retrieve the grid from the pattern, from which user can query
                 location information.
 
@@ -337,6 +550,23 @@ namespace gridtools {
 
                 m_send_buffers.buffer(I, J, K) = reinterpret_cast<char *>(p);
                 m_send_buffers.size(I, J, K) = s;
+                m_send_buffers.type(I, J, K) = MPI_DATATYPE_NULL;
+            }
+
+            /** Function to register the data to be sent to a neighbor as a derived datatype, so that it is sent
+                directly from where it is (e.g. the halo of a field) without a send buffer. The same as
+                register_send_to_buffer otherwise, the pattern does not take the ownership of the datatype.
+
+               \param[in] p The address the datatype is relative to
+               \param[in] t Committed datatype of the data, built from MPI_CHAR so that it matches the plain buffers
+               \param[in] s Number of bytes described by the datatype
+               \param[in] I Relative coordinates of the receiving process along the first dimension
+               \param[in] J Relative coordinates of the receiving process along the second dimension
+               \param[in] K Relative coordinates of the receiving process along the third dimension
+            */
+            void register_send_to_datatype(void const *p, MPI_Datatype t, int s, int I, int J, int K) {
+                register_send_to_buffer(const_cast<void *>(p), s, I, J, K);
+                m_send_buffers.type(I, J, K) = t;
             }
 
             /** Function to register send buffers with the communication patter.
@@ -390,6 +620,15 @@ namespace gridtools {
 
                 m_recv_buffers.buffer(I, J, K) = reinterpret_cast<char *>(p);
                 m_recv_buffers.size(I, J, K) = s;
+                m_recv_buffers.type(I, J, K) = MPI_DATATYPE_NULL;
+            }
+
+            /** Function to register where the data received from a neighbor goes as a derived datatype, so that it is
+                received directly in place (e.g. into the halo of a field). See register_send_to_datatype.
+            */
+            void register_receive_from_datatype(void *p, MPI_Datatype t, int s, int I, int J, int K) {
+                register_receive_from_buffer(p, s, I, J, K);
+                m_recv_buffers.type(I, J, K) = t;
             }
 
             /** Function to register buffers for received data with the communication patter.
@@ -549,6 +788,16 @@ namespace gridtools {
             }
 
             void post_receives() {
+                if (m_mode == exchange_mode::persistent) {
+                    prepare_persistent(recv_side);
+                    auto &requests = m_persistent_requests[recv_side];
+                    if (!requests.empty())
+                        MPI_Startall(requests.size(), requests.data());
+                    return;
+                }
+                if (m_mode == exchange_mode::neighbor_collective)
+                    return;
+
                 /* Posting receives face -1
                  */
                 if (m_proc_grid.template proc<1, 0, -1>() != -1) {
@@ -667,6 +916,18 @@ namespace gridtools {
             }
 
             void do_sends() {
+                if (m_mode == exchange_mode::persistent) {
+                    // the started receives must match the buffers registered for this exchange
+                    assert(persistent_up_to_date(recv_side));
+                    prepare_persistent(send_side);
+                    auto &requests = m_persistent_requests[send_side];
+                    if (!requests.empty())
+                        MPI_Startall(requests.size(), requests.data());
+                    return;
+                }
+                if (m_mode == exchange_mode::neighbor_collective)
+                    return start_neighbor_collective();
+
                 /* Sending data face -1
                  */
                 if (m_proc_grid.template proc<-1, 0, -1>() != -1) {
@@ -813,6 +1074,15 @@ namespace gridtools {
             }
 
             void wait() {
+                if (m_mode == exchange_mode::persistent) {
+                    for (auto &requests : m_persistent_requests)
+                        MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+                    return;
+                }
+                if (m_mode == exchange_mode::neighbor_collective) {
+                    MPI_Wait(&m_neighbor_request, MPI_STATUS_IGNORE);
+                    return;
+                }
 
                 wait_for_sends();
 
@@ -10,46 +10,265 @@
 
 #pragma once
 
-#include <cassert>
-#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
 
-#include "../common/hypercube_iterator.hpp"
+#include "../common/defs.hpp"
 #include "../common/tuple_util.hpp"
 
+#ifndef GT_CUDACC
+#include "../common/simd.hpp"
+#endif
+
+/**
+ *  @file
+ *  Host implementation of `transform_layout`.
+ *
+ *  The dimension with the smallest source stride (`a`) and the one with the smallest destination stride (`b`) are
+ *  the innermost dimensions of the source and of the destination. If they are the same, the data is copied row by row
+ *  along that dimension (`memcpy` for contiguous rows, the dimensions that continue the rows in both layouts are merged
+ *  into them). Otherwise the `a`-`b` plane is split into tiles that fit into
+ *  the L1 cache: the source tile is read along `a`, the destination tile is written along `b`. If both are contiguous
+ *  the tiles are transposed in SIMD registers in blocks of `L x L` elements. The tiles of all the planes (including the
+ *  dimensions beyond the third) are distributed over the threads by a single parallel loop.
+ */
+
 namespace gridtools {
     namespace impl {
-        template <class T, class Dims, class DstStrides, class SrcSrides>
-        void transform_cpu_loop(
-            T *dst, T const *__restrict__ src, Dims dims, DstStrides dst_strides, SrcSrides src_strides) {
+        namespace transform_cpu_impl_ {
+            using index_t = std::ptrdiff_t;
+
+            // the tiles are 512 bytes wide
+            template <class T>
+            constexpr index_t tile_size() {
+                return sizeof(T) <= 4 ? 128 : sizeof(T) <= 8 ? 64 : 16;
+            }
+
+            template <class T>
+            constexpr index_t chunk_size() {
+                return (std::size_t(1) << 18) / sizeof(T) > 0 ? (std::size_t(1) << 18) / sizeof(T) : 1;
+            }
+
+            template <class T>
+            using bits_t = std::conditional_t<sizeof(T) == 8, std::uint64_t, std::uint32_t>;
+
+            // the number of lanes of the in-register transpose, 0 if it is not applicable to `T`
+            template <class T>
+            constexpr int simd_lanes() {
+#ifdef GT_CUDACC
+                return 0;
+#else
+                return std::is_trivially_copyable<T>::value && (sizeof(T) == 4 || sizeof(T) == 8) &&
+                               simd::native_lanes<bits_t<T>>() > 1
+                           ? simd::native_lanes<bits_t<T>>()
+                           : 0;
+#endif
+            }
 
-            auto omp_loop = [size_i = tuple_util::get<0>(dims),
-                                size_j = tuple_util::get<1>(dims),
-                                size_k = tuple_util::get<2>(dims),
-                                src_stride_i = tuple_util::get<0>(src_strides),
-                                src_stride_j = tuple_util::get<1>(src_strides),
-                                src_stride_k = tuple_util::get<2>(src_strides),
-                                dst_stride_i = tuple_util::get<0>(dst_strides),
-                                dst_stride_j = tuple_util::get<1>(dst_strides),
-                                dst_stride_k = tuple_util::get<2>(dst_strides)](T *dst, T const *__restrict__ src) {
-#pragma omp parallel for collapse(3)
-                for (int i = 0; i < size_i; ++i)
-                    for (int j = 0; j < size_j; ++j)
-                        for (int k = 0; k < size_k; ++k)
-                            dst[dst_stride_i * i + dst_stride_j * j + dst_stride_k * k] =
-                                src[src_stride_i * i + src_stride_j * j + src_stride_k * k];
-            };
-
-            auto offset = [](auto const &index, auto const &strides) {
-                size_t res = 0;
-                tuple_util::for_each([&res](auto i, auto stride) { res += i * stride; }, index, strides);
+            template <class Tup, size_t N>
+            void to_array(Tup const &tup, index_t (&res)[N]) {
+                size_t i = 0;
+                tuple_util::for_each([&](auto val) { res[i++] = static_cast<index_t>(val); }, tup);
+            }
+
+            // the dimension of the size > 1 with the smallest absolute stride, -1 if there is no such dimension
+            template <size_t N>
+            int innermost(index_t const (&sizes)[N], index_t const (&strides)[N]) {
+                int res = -1;
+                for (int d = 0; d != int(N); ++d)
+                    if (sizes[d] > 1 && (res < 0 || std::abs(strides[d]) < std::abs(strides[res])))
+                        res = d;
                 return res;
-            };
+            }
+
+            template <class T>
+            void copy_block(T *dst,
+                T const *__restrict__ src,
+                index_t size_a,
+                index_t size_b,
+                index_t dst_stride_a,
+                index_t dst_stride_b,
+                index_t src_stride_a,
+                index_t src_stride_b) {
+                for (index_t b = 0; b < size_b; ++b)
+                    for (index_t a = 0; a < size_a; ++a)
+                        dst[dst_stride_a * a + dst_stride_b * b] = src[src_stride_a * a + src_stride_b * b];
+            }
+
+            template <class T, std::enable_if_t<simd_lanes<T>() == 0, int> = 0>
+            void transpose_tile(T *dst,
+                T const *__restrict__ src,
+                index_t size_a,
+                index_t size_b,
+                index_t dst_stride_a,
+                index_t src_stride_b) {
+                copy_block(dst, src, size_a, size_b, dst_stride_a, 1, 1, src_stride_b);
+            }
+
+#ifndef GT_CUDACC
+            /*
+             *  `src` is contiguous along `a`, `dst` is contiguous along `b`. `L` source rows are loaded, transposed in
+             *  registers and stored as `L` destination rows.
+             */
+            template <class T, int L = simd_lanes<T>(), std::enable_if_t<(L > 0), int> = 0>
+            void transpose_tile(T *dst,
+                T const *__restrict__ src,
+                index_t size_a,
+                index_t size_b,
+                index_t dst_stride_a,
+                index_t src_stride_b) {
+                using vec_t = simd::vec<bits_t<T>, L>;
+                index_t a = 0;
+                for (; a + L <= size_a; a += L) {
+                    index_t b = 0;
+                    for (; b + L <= size_b; b += L) {
+                        vec_t rows[L];
+                        for (int r = 0; r != L; ++r)
+                            rows[r] =
+                                vec_t::load(reinterpret_cast<bits_t<T> const *>(src + a + src_stride_b * (b + r)));
+                        simd::transpose(rows);
+                        for (int r = 0; r != L; ++r)
+                            rows[r].store(reinterpret_cast<bits_t<T> *>(dst + dst_stride_a * (a + r) + b));
+                    }
+                    copy_block(dst + dst_stride_a * a + b,
+                        src + a + src_stride_b * b,
+                        L,
+                        size_b - b,
+                        dst_stride_a,
+                        1,
+                        1,
+                        src_stride_b);
+                }
+                copy_block(dst + dst_stride_a * a, src + a, size_a - a, size_b, dst_stride_a, 1, 1, src_stride_b);
+            }
+#endif
+
+            template <class T>
+            void copy_row(T *dst, T const *__restrict__ src, index_t size, index_t dst_stride, index_t src_stride) {
+                if (std::is_trivially_copyable<T>::value && dst_stride == 1 && src_stride == 1)
+                    std::memcpy(dst, src, size * sizeof(T));
+                else
+                    for (index_t i = 0; i < size; ++i)
+                        dst[dst_stride * i] = src[src_stride * i];
+            }
+
+            template <class T, size_t N>
+            void transform(T *dst,
+                T const *__restrict__ src,
+                index_t const (&sizes)[N],
+                index_t const (&dst_strides)[N],
+                index_t const (&src_strides)[N]) {
+                for (auto size : sizes)
+                    if (size <= 0)
+                        return;
+                int a = innermost(sizes, src_strides);
+                int b = innermost(sizes, dst_strides);
+                if (a < 0) {
+                    *dst = *src;
+                    return;
+                }
 
-            auto &&extra_src_strides = tuple_util::drop_front<3>(std::move(src_strides));
-            auto &&extra_dst_strides = tuple_util::drop_front<3>(std::move(dst_strides));
+                // the remaining dimensions
+                index_t outer_sizes[N] = {};
+                index_t outer_dst_strides[N] = {};
+                index_t outer_src_strides[N] = {};
+                size_t num_outer = 0;
+                index_t num_outer_points = 1;
+                for (int d = 0; d != int(N); ++d) {
+                    if (d == a || d == b || sizes[d] == 1)
+                        continue;
+                    outer_sizes[num_outer] = sizes[d];
+                    outer_dst_strides[num_outer] = dst_strides[d];
+                    outer_src_strides[num_outer] = src_strides[d];
+                    num_outer_points *= sizes[d];
+                    ++num_outer;
+                }
+                auto outer_offsets = [&](index_t n, index_t &dst_offset, index_t &src_offset) {
+                    for (size_t d = 0; d != num_outer; ++d) {
+                        index_t i = n % outer_sizes[d];
+                        n /= outer_sizes[d];
+                        dst_offset += outer_dst_strides[d] * i;
+                        src_offset += outer_src_strides[d] * i;
+                    }
+                };
 
-            for (auto i : make_hypercube_view(tuple_util::drop_front<3>(dims)))
-                omp_loop(dst + offset(i, extra_dst_strides), src + offset(i, extra_src_strides));
+                if (a == b) {
+                    // the outer dimensions that continue the rows in both layouts are merged into the rows
+                    index_t row_size = sizes[a];
+                    for (size_t d = 0; d != num_outer;) {
+                        if (outer_src_strides[d] != src_strides[a] * row_size ||
+                            outer_dst_strides[d] != dst_strides[a] * row_size) {
+                            ++d;
+                            continue;
+                        }
+                        row_size *= outer_sizes[d];
+                        num_outer_points /= outer_sizes[d];
+                        --num_outer;
+                        outer_sizes[d] = outer_sizes[num_outer];
+                        outer_src_strides[d] = outer_src_strides[num_outer];
+                        outer_dst_strides[d] = outer_dst_strides[num_outer];
+                        d = 0;
+                    }
+                    // the long rows are split to spread them over the threads
+                    index_t chunk = chunk_size<T>();
+                    index_t chunks = (row_size + chunk - 1) / chunk;
+#pragma omp parallel for
+                    for (index_t n = 0; n < num_outer_points * chunks; ++n) {
+                        index_t start = n % chunks * chunk;
+                        index_t dst_offset = dst_strides[a] * start, src_offset = src_strides[a] * start;
+                        outer_offsets(n / chunks, dst_offset, src_offset);
+                        copy_row(dst + dst_offset,
+                            src + src_offset,
+                            row_size - start < chunk ? row_size - start : chunk,
+                            dst_strides[a],
+                            src_strides[a]);
+                    }
+                    return;
+                }
+
+                constexpr index_t tile = tile_size<T>();
+                index_t size_a = sizes[a];
+                index_t size_b = sizes[b];
+                index_t tiles_a = (size_a + tile - 1) / tile;
+                index_t tiles_b = (size_b + tile - 1) / tile;
+                bool contiguous = src_strides[a] == 1 && dst_strides[b] == 1;
+#pragma omp parallel for
+                for (index_t n = 0; n < tiles_a * tiles_b * num_outer_points; ++n) {
+                    index_t a_start = n % tiles_a * tile;
+                    index_t b_start = n / tiles_a % tiles_b * tile;
+                    index_t dst_offset = dst_strides[a] * a_start + dst_strides[b] * b_start;
+                    index_t src_offset = src_strides[a] * a_start + src_strides[b] * b_start;
+                    outer_offsets(n / tiles_a / tiles_b, dst_offset, src_offset);
+                    index_t tile_a = size_a - a_start < tile ? size_a - a_start : tile;
+                    index_t tile_b = size_b - b_start < tile ? size_b - b_start : tile;
+                    if (contiguous)
+                        transpose_tile(
+                            dst + dst_offset, src + src_offset, tile_a, tile_b, dst_strides[a], src_strides[b]);
+                    else
+                        copy_block(dst + dst_offset,
+                            src + src_offset,
+                            tile_a,
+                            tile_b,
+                            dst_strides[a],
+                            dst_strides[b],
+                            src_strides[a],
+                            src_strides[b]);
+                }
+            }
+        } // namespace transform_cpu_impl_
+
+        template <class T, class Dims, class DstStrides, class SrcSrides>
+        void transform_cpu_loop(
+            T *dst, T const *__restrict__ src, Dims dims, DstStrides dst_strides, SrcSrides src_strides) {
+            constexpr size_t n = tuple_util::size<Dims>::value;
+            transform_cpu_impl_::index_t sizes[n], dst_strides_arr[n], src_strides_arr[n];
+            transform_cpu_impl_::to_array(dims, sizes);
+            transform_cpu_impl_::to_array(dst_strides, dst_strides_arr);
+            transform_cpu_impl_::to_array(src_strides, src_strides_arr);
+            transform_cpu_impl_::transform(dst, src, sizes, dst_strides_arr, src_strides_arr);
         }
     } // namespace impl
 } // namespace gridtools
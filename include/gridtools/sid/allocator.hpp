@@ -12,9 +12,18 @@
 #ifndef GT_SID_ALLOCATOR_HPP_
 #define GT_SID_ALLOCATOR_HPP_
 
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdlib>
+#include <iterator>
+#include <list>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <new>
 #include <stack>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -41,18 +50,31 @@
  *  API
  *  ---
  *
- *  The library provides two types that model the concept:
+ *  The library provides three types that model the concept:
  *    - `allocator`,
- *    - `cached_allocator`.
+ *    - `cached_allocator`,
+ *    - `pooled_allocator`.
  *
- *  Both are templated with the functor that takes the size in bytes and returns `std::unique_ptr`
+ *  All are templated with the functor that takes the size in bytes and returns `std::unique_ptr`
  *
- *  There are also correspondent generators: `make_allocator` and `make_cached_allocator`.
+ *  There are also correspondent generators: `make_allocator`, `make_cached_allocator` and `make_pooled_allocator`.
  *
  *  Semantics:
  *    - `allocator` keeps the resources that are allocated and releases them in dtor.
  *    - `cached_allocator` keeps resources during its lifetime. On dtor it stashes the resources in the internal static
- *      storage. The newly created instances of `cached_allocator` will attempt to reuse the stashed resources.
+ *      thread local storage. The newly created instances of `cached_allocator` will attempt to reuse the stashed
+ *      resources of exactly the same size.
+ *    - `pooled_allocator` is like `cached_allocator`, but the resources are stashed in one pool that is shared by all
+ *      threads and all allocation functors (a buffer is only reused by the functor type that has allocated it). The
+ *      sizes are rounded up to size classes (four per power of two) and a request is served by the smallest stashed
+ *      buffer that fits, if it is at most twice as large. The pool retains at most `get_pool_limit()` bytes in total,
+ *      the least recently returned buffers are freed first. The limit is taken from the `GT_ALLOCATOR_POOL_LIMIT`
+ *      environment variable (in MiB, 2048 by default) and can be changed with `set_pool_limit`. `get_pool_stats()`
+ *      returns the statistics of the pool, `release_pooled_memory()` frees all stashed buffers.
+ *      An allocation functor that places the memory (like `thread_pool::first_touch_allocation_f`) provides
+ *      `std::size_t allocation_placement(impl)` by ADL: a non-zero value that identifies the placement. Its buffers
+ *      are reused only for the requests of the same size and placement, so that the reused memory is placed as the
+ *      functor would place a new buffer.
  *
  *  To make the simplest possible allocator one can do:
  *    `auto alloc = make_allocator(&std::make_unique<char[]>);`
@@ -95,7 +117,268 @@ namespace gridtools {
                     return {ptr.release(), {ptr.get_deleter(), stack}};
                 }
             };
+
+            struct pool_stats {
+                std::size_t hits = 0;
+                std::size_t misses = 0;
+                std::size_t evictions = 0;
+                // the size of the stashed buffers
+                std::size_t bytes_retained = 0;
+                // the size of the buffers that are handed out
+                std::size_t bytes_in_use = 0;
+
+                pool_stats &operator+=(pool_stats const &other) {
+                    hits += other.hits;
+                    misses += other.misses;
+                    evictions += other.evictions;
+                    bytes_retained += other.bytes_retained;
+                    bytes_in_use += other.bytes_in_use;
+                    return *this;
+                }
+            };
+
+            /*
+             *  Rounds the size up to the size class: 256 bytes or a multiple of the quarter of the largest power of two
+             *  that is smaller than the size. That wastes less than 25%.
+             */
+            inline std::size_t size_class(std::size_t size) {
+                std::size_t power = 256;
+                if (size <= power)
+                    return power;
+                while (power * 2 < size)
+                    power *= 2;
+                std::size_t step = power / 4;
+                return (size + step - 1) / step * step;
+            }
+
+            inline std::size_t default_pool_limit() {
+                if (char const *env = std::getenv("GT_ALLOCATOR_POOL_LIMIT"))
+                    return std::size_t(std::atoll(env)) << 20;
+                return std::size_t(2048) << 20;
+            }
+
+            // the key of the buffers of the allocation functor type in the pool
+            template <class Impl>
+            void const *pool_tag() {
+                static char const res = 0;
+                return &res;
+            }
+
+            template <class Impl>
+            auto get_placement(Impl const &impl, int) -> decltype(allocation_placement(impl)) {
+                return allocation_placement(impl);
+            }
+
+            template <class Impl>
+            std::size_t get_placement(Impl const &, long) {
+                return 0;
+            }
+
+            /*
+             *  The buffers of all allocation functors are stashed in one pool, so that the limit bounds the total
+             *  retained memory. The buffers are keyed by the functor type and by the placement (see
+             *  `allocation_placement`), the least recently stashed buffers are evicted first.
+             */
+            class pool {
+                struct buffer_base {
+                    virtual ~buffer_base() = default;
+                };
+
+                template <class Ptr>
+                struct buffer final : buffer_base {
+                    Ptr m_ptr;
+                    buffer(Ptr ptr) : m_ptr(std::move(ptr)) {}
+                };
+
+                struct key {
+                    void const *tag;
+                    std::size_t placement;
+                    std::size_t capacity;
+
+                    bool operator<(key const &other) const {
+                        return std::tie(tag, placement, capacity) <
+                               std::tie(other.tag, other.placement, other.capacity);
+                    }
+                };
+
+                struct entry {
+                    key k;
+                    std::unique_ptr<buffer_base> buf;
+                };
+                using lru_t = std::list<entry>;
+                using index_t = std::multimap<key, lru_t::iterator>;
+
+                std::mutex m_mutex;
+                // the stashed buffers, the least recently stashed first
+                lru_t m_lru;
+                index_t m_index;
+                std::size_t m_limit = default_pool_limit();
+                pool_stats m_stats;
+
+                // called with the lock held
+                std::unique_ptr<buffer_base> take(index_t::iterator pos) {
+                    auto res = std::move(pos->second->buf);
+                    m_stats.bytes_retained -= pos->first.capacity;
+                    m_lru.erase(pos->second);
+                    m_index.erase(pos);
+                    return res;
+                }
+
+                // called with the lock held, the evicted buffers are freed by the caller after unlocking
+                void evict(std::size_t limit, std::vector<std::unique_ptr<buffer_base>> &evicted) {
+                    while (!m_lru.empty() && m_stats.bytes_retained > limit) {
+                        auto oldest = m_lru.begin();
+                        auto range = m_index.equal_range(oldest->k);
+                        auto pos = std::find_if(
+                            range.first, range.second, [&](auto const &item) { return item.second == oldest; });
+                        assert(pos != range.second);
+                        ++m_stats.evictions;
+                        evicted.push_back(take(pos));
+                    }
+                }
+
+              public:
+                // never destroyed: the buffers can be returned during the static destruction
+                static pool &instance() {
+                    static auto *res = new pool;
+                    return *res;
+                }
+
+                /*
+                 *  Returns a stashed buffer or allocates a new one with `alloc`. Without the placement a buffer of
+                 *  the size class of the request is served by the smallest stashed buffer that is at most twice as
+                 *  large and `capacity` is set to its size. With the placement only a buffer of the same size is
+                 *  reused.
+                 */
+                template <class Ptr, class Alloc>
+                Ptr get(void const *tag, std::size_t placement, std::size_t &capacity, Alloc const &alloc) {
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        auto found = m_index.lower_bound({tag, placement, capacity});
+                        if (found != m_index.end() && found->first.tag == tag && found->first.placement == placement &&
+                            (placement ? found->first.capacity == capacity : found->first.capacity / 2 <= capacity)) {
+                            capacity = found->first.capacity;
+                            auto buf = take(found);
+                            ++m_stats.hits;
+                            m_stats.bytes_in_use += capacity;
+                            return std::move(static_cast<buffer<Ptr> &>(*buf).m_ptr);
+                        }
+                        ++m_stats.misses;
+                        m_stats.bytes_in_use += capacity;
+                    }
+                    try {
+                        return alloc(capacity);
+                    } catch (std::bad_alloc const &) {
+                        // the stashed buffers might be in the way
+                        trim(0);
+                    } catch (...) {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        m_stats.bytes_in_use -= capacity;
+                        throw;
+                    }
+                    try {
+                        return alloc(capacity);
+                    } catch (...) {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        m_stats.bytes_in_use -= capacity;
+                        throw;
+                    }
+                }
+
+                template <class Ptr>
+                void put(void const *tag, std::size_t placement, std::size_t capacity, Ptr ptr) {
+                    std::vector<std::unique_ptr<buffer_base>> evicted;
+                    std::unique_ptr<buffer_base> buf(new buffer<Ptr>(std::move(ptr)));
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_stats.bytes_in_use -= capacity;
+                    if (capacity > m_limit) {
+                        ++m_stats.evictions;
+                        evicted.push_back(std::move(buf));
+                        return;
+                    }
+                    key k = {tag, placement, capacity};
+                    m_lru.push_back({k, std::move(buf)});
+                    m_index.emplace(k, std::prev(m_lru.end()));
+                    m_stats.bytes_retained += capacity;
+                    evict(m_limit, evicted);
+                }
+
+                pool_stats stats() {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    return m_stats;
+                }
+
+                std::size_t limit() {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    return m_limit;
+                }
+
+                void set_limit(std::size_t bytes) {
+                    std::vector<std::unique_ptr<buffer_base>> evicted;
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_limit = bytes;
+                    evict(bytes, evicted);
+                }
+
+                // frees the least recently stashed buffers until at most `limit` bytes are retained
+                void trim(std::size_t limit) {
+                    std::vector<std::unique_ptr<buffer_base>> evicted;
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    evict(limit, evicted);
+                }
+            };
+
+            template <class Impl, class Ptr = decltype(std::declval<Impl const>()(size_t{}))>
+            struct pooled_proxy_f;
+
+            template <class Impl, class T, class Deleter>
+            struct pooled_proxy_f<Impl, std::unique_ptr<T, Deleter>> {
+                using ptr_t = std::unique_ptr<T, Deleter>;
+
+                struct deleter_f {
+                    using pointer = typename ptr_t::pointer;
+                    Deleter m_deleter;
+                    std::size_t m_placement;
+                    std::size_t m_capacity;
+
+                    void operator()(pointer ptr) const {
+                        pool::instance().put(pool_tag<Impl>(), m_placement, m_capacity, ptr_t(ptr, m_deleter));
+                    }
+                };
+
+                Impl m_impl;
+
+                std::unique_ptr<T, deleter_f> operator()(size_t size) const {
+                    std::size_t placement = get_placement(m_impl, 0);
+                    std::size_t capacity = placement ? size : size_class(size);
+                    auto ptr = pool::instance().get<ptr_t>(
+                        pool_tag<Impl>(), placement, capacity, [this](std::size_t size) { return m_impl(size); });
+                    return {ptr.release(), {ptr.get_deleter(), placement, capacity}};
+                }
+            };
+
+            /**
+             *  The statistics of the pool of `pooled_allocator`.
+             */
+            inline pool_stats get_pool_stats() { return pool::instance().stats(); }
+
+            /**
+             *  Frees the buffers that are stashed in the pool of `pooled_allocator`.
+             */
+            inline void release_pooled_memory() { pool::instance().trim(0); }
+
+            inline std::size_t get_pool_limit() { return pool::instance().limit(); }
+
+            /**
+             *  Sets the maximal number of bytes that are retained by the pool of `pooled_allocator`.
+             */
+            inline void set_pool_limit(std::size_t bytes) { pool::instance().set_limit(bytes); }
         } // namespace allocator_impl_
+        using allocator_impl_::get_pool_limit;
+        using allocator_impl_::get_pool_stats;
+        using allocator_impl_::pool_stats;
+        using allocator_impl_::release_pooled_memory;
+        using allocator_impl_::set_pool_limit;
     }     // namespace sid
 } // namespace gridtools
 
@@ -124,7 +407,6 @@ namespace gridtools {
                 template <class LazyT>
                 friend auto allocate(allocator &self, LazyT, size_t size) {
                     using type = typename LazyT::type;
-                    auto ptr = self.m_impl(sizeof(type) * size);
                     self.m_buffers.push_back(self.m_impl(sizeof(type) * size));
                     return make_simple_ptr_holder(reinterpret_cast<type *>(self.m_buffers.back().get()));
                 }
@@ -136,6 +418,12 @@ namespace gridtools {
                 cached_allocator(Impl impl) : cached_allocator::allocator({std::move(impl)}) {}
             };
 
+            template <class Impl>
+            struct pooled_allocator : allocator<allocator_impl_::pooled_proxy_f<Impl>> {
+                pooled_allocator() = default;
+                pooled_allocator(Impl impl) : pooled_allocator::allocator({std::move(impl)}) {}
+            };
+
             template <class Impl>
             allocator<Impl> make_allocator(Impl impl) {
                 return {std::move(impl)};
@@ -145,6 +433,11 @@ namespace gridtools {
             cached_allocator<Impl> make_cached_allocator(Impl impl) {
                 return {std::move(impl)};
             }
+
+            template <class Impl>
+            pooled_allocator<Impl> make_pooled_allocator(Impl impl) {
+                return {std::move(impl)};
+            }
         }
     } // namespace sid
 } // namespace gridtools
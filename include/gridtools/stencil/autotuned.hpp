@@ -0,0 +1,254 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <istream>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+#include "../common/defs.hpp"
+#include "../thread_pool/concept.hpp"
+
+/**
+ *  @file
+ *  Backend that selects the fastest of several candidate backends at runtime.
+ *
+ *  The candidates are typically the same backend instantiated with different block sizes:
+ *
+ *    using backend_t = stencil::autotuned<thread_pool::omp,
+ *        stencil::cpu_kfirst<integral_constant<int, 8>, integral_constant<int, 8>>,
+ *        stencil::cpu_kfirst<integral_constant<int, 32>, integral_constant<int, 4>>,
+ *        stencil::cpu_kfirst<integral_constant<int, 128>, integral_constant<int, 2>>>;
+ *
+ *  Tuning is done per stencil, grid size and number of threads. The candidates are run one after the other: the first
+ *  run of each candidate is a warm-up (allocation of the temporaries, first touch of the pages) and the best of the
+ *  following `tuning_table::samples` runs is its time. Once all of them are measured the fastest candidate is used.
+ *  Every `run` call executes the stencil exactly once, hence the results are not affected by tuning.
+ *
+ *  If the environment variable `GT_AUTOTUNE_FILE` is set, the tuned candidates are stored in that file and reused by
+ *  subsequent executions of the program. The file is replaced atomically, so that concurrent processes (e.g. MPI
+ *  ranks) don't corrupt it.
+ */
+
+namespace gridtools {
+    namespace stencil {
+        namespace autotuned_backend {
+            struct tuning_key {
+                std::uint64_t spec_hash;
+                int_t i_size;
+                int_t j_size;
+                int_t k_size;
+                int_t threads;
+
+                friend bool operator<(tuning_key const &lhs, tuning_key const &rhs) {
+                    return std::tie(lhs.spec_hash, lhs.i_size, lhs.j_size, lhs.k_size, lhs.threads) <
+                           std::tie(rhs.spec_hash, rhs.i_size, rhs.j_size, rhs.k_size, rhs.threads);
+                }
+            };
+
+            /**
+             *  Stable (FNV-1a) hash of a type name, usable as a key in the tuning file.
+             */
+            inline std::uint64_t hash_name(char const *name, std::uint64_t seed = 14695981039346656037ull) {
+                for (; *name; ++name)
+                    seed = (seed ^ static_cast<unsigned char>(*name)) * 1099511628211ull;
+                return seed;
+            }
+
+            /**
+             *  Thread safe record of the measurements and of the tuned candidates.
+             */
+            class tuning_table {
+                struct entry {
+                    std::vector<int> runs;     // per candidate, including the warm-up
+                    std::vector<double> times; // per candidate, the best of the timed runs
+                    int winner = -1;
+                };
+
+                // the candidate being measured
+                static int current(entry const &e) {
+                    int res = 0;
+                    while (res < (int)e.runs.size() && e.runs[res] > samples)
+                        ++res;
+                    return res;
+                }
+
+                mutable std::mutex m_mutex;
+                std::map<tuning_key, entry> m_entries;
+                std::string m_file;
+
+              public:
+                /**
+                 *  The number of timed runs of each candidate after its warm-up.
+                 */
+                static constexpr int samples = 3;
+
+                /**
+                 *  The table is read from and written to `file` unless it is empty.
+                 */
+                explicit tuning_table(std::string file = {}) : m_file(std::move(file)) {
+                    if (m_file.empty())
+                        return;
+                    std::ifstream in(m_file);
+                    load(in);
+                }
+
+                static tuning_table &instance() {
+                    static char const *file = std::getenv("GT_AUTOTUNE_FILE");
+                    static tuning_table res(file ? file : "");
+                    return res;
+                }
+
+                /**
+                 *  The candidate for the next run: the tuned one if all candidates are measured.
+                 */
+                int next(tuning_key const &key, int candidates) const {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    auto it = m_entries.find(key);
+                    if (it == m_entries.end())
+                        return 0;
+                    if (it->second.winner >= 0 && it->second.winner < candidates)
+                        return it->second.winner;
+                    return std::min(current(it->second), candidates - 1);
+                }
+
+                /**
+                 *  The tuned candidate or `-1` if the key is not tuned yet.
+                 */
+                int winner(tuning_key const &key) const {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    auto it = m_entries.find(key);
+                    return it == m_entries.end() ? -1 : it->second.winner;
+                }
+
+                /**
+                 *  Records the time of a run. Measurements that are not expected (runs of another candidate than the
+                 *  one being measured or runs of a tuned key) are ignored.
+                 */
+                void report(tuning_key const &key, int candidates, int candidate, double time) {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    auto &e = m_entries[key];
+                    if (e.winner >= 0)
+                        return;
+                    if (e.runs.empty()) {
+                        e.runs.resize(candidates, 0);
+                        e.times.resize(candidates, 0);
+                    }
+                    if (candidate != current(e))
+                        return;
+                    // the first run of the candidate is the warm-up
+                    if (e.runs[candidate]++)
+                        e.times[candidate] = e.runs[candidate] == 2 ? time : std::min(e.times[candidate], time);
+                    if (current(e) < candidates)
+                        return;
+                    e.winner = std::min_element(e.times.begin(), e.times.end()) - e.times.begin();
+                    if (!m_file.empty())
+                        save_file();
+                }
+
+                /**
+                 *  Reads the tuned candidates in the format written by `save`.
+                 */
+                void load(std::istream &in) {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    tuning_key key;
+                    int winner;
+                    while (in >> key.spec_hash >> key.i_size >> key.j_size >> key.k_size >> key.threads >> winner) {
+                        m_entries[key].winner = winner;
+                    }
+                }
+
+                /**
+                 *  Writes the tuned candidates, one `spec_hash i_size j_size k_size threads candidate` line per key.
+                 */
+                void save(std::ostream &out) const {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    save_impl(out);
+                }
+
+              private:
+                // written to a file of the process first, then renamed
+                void save_file() const {
+                    std::string tmp = m_file + "." + std::to_string(getpid()) + ".tmp";
+                    {
+                        std::ofstream out(tmp);
+                        save_impl(out);
+                        if (!out) {
+                            std::remove(tmp.c_str());
+                            return;
+                        }
+                    }
+                    std::rename(tmp.c_str(), m_file.c_str());
+                }
+
+                void save_impl(std::ostream &out) const {
+                    for (auto &&item : m_entries) {
+                        if (item.second.winner < 0)
+                            continue;
+                        auto const &key = item.first;
+                        out << key.spec_hash << " " << key.i_size << " " << key.j_size << " " << key.k_size << " "
+                            << key.threads << " " << item.second.winner << "\n";
+                    }
+                }
+            };
+
+            template <class Backend, class Spec, class Grid, class DataStores>
+            void run_candidate(Grid const &grid, DataStores data_stores) {
+                gridtools_backend_entry_point(Backend(), Spec(), grid, std::move(data_stores));
+            }
+
+            template <class ThreadPool, class Backend, class Spec, class Grid>
+            tuning_key make_tuning_key(Grid const &grid) {
+                return {hash_name(typeid(Spec).name(), hash_name(typeid(Backend).name())),
+                    grid.i_size(),
+                    grid.j_size(),
+                    grid.k_size(),
+                    thread_pool::get_max_threads(ThreadPool())};
+            }
+
+            template <class ThreadPool, class... Backends>
+            struct autotuned {
+                static_assert(sizeof...(Backends) > 0, "autotuned backend requires at least one candidate");
+
+                template <class Spec, class Grid, class DataStores>
+                friend void gridtools_backend_entry_point(autotuned, Spec, Grid const &grid, DataStores data_stores) {
+                    using candidate_t = void (*)(Grid const &, DataStores);
+                    static constexpr candidate_t candidates[] = {&run_candidate<Backends, Spec, Grid, DataStores>...};
+                    constexpr int n = sizeof...(Backends);
+
+                    auto &table = tuning_table::instance();
+                    auto key = make_tuning_key<ThreadPool, autotuned, Spec>(grid);
+                    int candidate = table.next(key, n);
+
+                    auto start = std::chrono::steady_clock::now();
+                    candidates[candidate](grid, std::move(data_stores));
+                    std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+
+                    table.report(key, n, candidate, time.count());
+                }
+            };
+        } // namespace autotuned_backend
+        using autotuned_backend::autotuned;
+    } // namespace stencil
+} // namespace gridtools
@@ -0,0 +1,120 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <type_traits>
+
+#include "../../common/integral_constant.hpp"
+#include "../../meta.hpp"
+#include "../be_api.hpp"
+#include "caches.hpp"
+#include "fill_flush.hpp"
+
+/**
+ *  The view of the spec for the backends that serve the software caches by fusing the whole multi stage.
+ *
+ *  The multi stages with caches are represented by a single `be_api::fused_view_item`:
+ *    - the forward/backward ones with k-caches are supposed to be executed column by column;
+ *      fill/flush stages are added to them;
+ *    - the parallel ones with ij-caches are supposed to be executed level by level.
+ *  The other multi stages are represented by `be_api::split_view_item`s, caches are ignored there.
+ */
+namespace gridtools {
+    namespace stencil {
+        namespace cached_view {
+            namespace impl_ {
+                template <class Cache>
+                struct is_cached_f {
+                    template <class PlhInfo>
+                    using apply = std::is_same<typename PlhInfo::caches_t, meta::list<Cache>>;
+                };
+
+                template <class Matrix>
+                using matrix_plh_map =
+                    meta::rename<be_api::merge_plh_maps, meta::transform<be_api::get_plh_map, meta::flatten<Matrix>>>;
+
+                template <class Matrix>
+                using is_parallel_matrix = be_api::is_parallel<typename meta::first<meta::first<Matrix>>::execution_t>;
+
+                template <class Matrix>
+                using fill_flush_matrix = meta::first<fill_flush::transform_spec<meta::list<Matrix>>>;
+
+                template <class Matrix>
+                using has_uniform_extent = bool_constant<
+                    meta::length<meta::dedup<meta::transform<be_api::get_extent, meta::flatten<Matrix>>>>::value == 1>;
+
+                /*
+                 *  K-caches are served by executing the whole multi stage column by column. It is valid only if no
+                 *  stage accesses the data computed by the other stages with horizontal offsets, i.e. if all the stages
+                 *  have the same extent. Otherwise k-caches are ignored.
+                 */
+                template <class Matrix>
+                using use_k_caches = conjunction<negation<is_parallel_matrix<Matrix>>,
+                    meta::any_of<is_cached_f<cache_type::k>::apply, matrix_plh_map<Matrix>>,
+                    has_uniform_extent<fill_flush_matrix<Matrix>>>;
+
+                /*
+                 *  IJ-caches are served by executing the whole multi stage level by level within the block. There are
+                 *  no vertical dependencies within the parallel multi stage, that is why it is always valid.
+                 */
+                template <class Matrix>
+                using use_ij_caches = conjunction<is_parallel_matrix<Matrix>,
+                    meta::any_of<is_cached_f<cache_type::ij>::apply, matrix_plh_map<Matrix>>>;
+
+                template <class Matrix>
+                using make_stages = meta::if_<use_k_caches<Matrix>,
+                    meta::list<be_api::make_fused_view_item<fill_flush_matrix<Matrix>>>,
+                    meta::if_<use_ij_caches<Matrix>,
+                        meta::list<be_api::make_fused_view_item<Matrix>>,
+                        meta::transform<be_api::make_split_view_item, be_api::fuse_stage_rows<Matrix>>>>;
+
+                template <class Spec>
+                using make_view =
+                    meta::rename<be_api::aggregated_view, meta::flatten<meta::transform<make_stages, Spec>>>;
+
+                // The caches that are served by the stage: `k` for the column stages and `ij` for the level stages.
+                template <class Stage>
+                using stage_caches = meta::if_<meta::is_instantiation_of<be_api::fused_view_item, Stage>,
+                    meta::list<
+                        meta::if_<be_api::is_parallel<typename Stage::execution_t>, cache_type::ij, cache_type::k>>,
+                    meta::list<>>;
+
+                template <class Stage>
+                struct served_caches_f {
+                    template <class PlhInfo>
+                    using apply = meta::if_<std::is_same<typename PlhInfo::caches_t, stage_caches<Stage>>,
+                        typename PlhInfo::caches_t,
+                        meta::list<>>;
+                };
+
+                template <class Stage>
+                struct is_served_f {
+                    template <class PlhInfo>
+                    using apply = negation<meta::is_empty<typename served_caches_f<Stage>::template apply<PlhInfo>>>;
+                };
+
+                // The temporaries that are not served by caches are allocated for the full column.
+                template <class Stage>
+                using full_tmp_plh_map = meta::filter<meta::not_<is_served_f<Stage>::template apply>::template apply,
+                    meta::filter<be_api::get_is_tmp, typename Stage::plh_map_t>>;
+
+                template <class Stages>
+                using tmp_plh_map = be_api::remove_caches_from_plh_map<
+                    meta::flatten<meta::transform<full_tmp_plh_map, meta::rename<meta::list, Stages>>>>;
+            } // namespace impl_
+            using impl_::is_cached_f;
+            using impl_::is_parallel_matrix;
+            using impl_::make_view;
+            using impl_::served_caches_f;
+            using impl_::stage_caches;
+            using impl_::tmp_plh_map;
+        } // namespace cached_view
+    }     // namespace stencil
+} // namespace gridtools
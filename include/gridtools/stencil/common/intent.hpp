@@ -9,7 +9,10 @@
  */
 #pragma once
 
+#include <type_traits>
+
 #include "../../common/host_device.hpp"
+#include "../../common/reduced_precision.hpp"
 
 namespace gridtools {
     namespace stencil {
@@ -29,14 +32,15 @@ namespace gridtools {
         template <class T>
         struct apply_intent_type<intent::inout, T const &> {};
 
+        // the reduced precision values are widened on read
         template <class T>
         struct apply_intent_type<intent::in, T> {
-            using type = T;
+            using type = widen_t<T>;
         };
 
         template <class T>
         struct apply_intent_type<intent::in, T &> {
-            using type = T const &;
+            using type = std::conditional_t<is_reduced_precision<T>::value, widen_t<T>, T const &>;
         };
 
         template <intent Intent, class T>
@@ -0,0 +1,132 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "../../common/defs.hpp"
+#include "../../common/tuple_util.hpp"
+#include "../../sid/concept.hpp"
+#include "../../sid/synthetic.hpp"
+
+namespace gridtools {
+    namespace stencil {
+        namespace rebind_impl_ {
+            template <class T>
+            auto add_ptr_diffs(T const &lhs, T const &rhs, int) -> decltype(lhs + rhs) {
+                return lhs + rhs;
+            }
+
+            template <class T>
+            T add_ptr_diffs(T const &, T const &, long) {
+                static_assert(std::is_empty<T>::value, GT_INTERNAL_ERROR);
+                return {};
+            }
+
+            /*
+             *  Reads the origin from the cell that is updated on every call.
+             */
+            template <class Ptr, class PtrDiff>
+            struct ptr_holder {
+                Ptr const *m_cell;
+                PtrDiff m_offset;
+
+                Ptr operator()() const { return *m_cell + m_offset; }
+
+                friend ptr_holder operator+(ptr_holder const &obj, PtrDiff const &offset) {
+                    return {obj.m_cell, add_ptr_diffs(obj.m_offset, offset, 0)};
+                }
+            };
+
+            struct get_origin_f {
+                template <class Sid>
+                sid::ptr_type<Sid> operator()(Sid &src) const {
+                    return sid::get_origin(src)();
+                }
+            };
+
+            struct get_strides_f {
+                template <class Sid>
+                sid::strides_type<Sid> operator()(Sid &src) const {
+                    return sid::get_strides(src);
+                }
+            };
+
+            struct make_field_f {
+                template <class Sid>
+                auto operator()(Sid &src, sid::ptr_type<Sid> const &cell) const {
+                    using ptr_diff_t = sid::ptr_diff_type<Sid>;
+                    return sid::synthetic()
+                        .set<sid::property::origin>(ptr_holder<sid::ptr_type<Sid>, ptr_diff_t>{&cell, {}})
+                        .template set<sid::property::strides>(sid::get_strides(src))
+                        .template set<sid::property::ptr_diff, ptr_diff_t>()
+                        .template set<sid::property::strides_kind, sid::strides_kind<Sid>>();
+                }
+            };
+
+            template <class Strides>
+            bool equal_strides(Strides const &lhs, Strides const &rhs) {
+                return tuple_util::all_of(
+                    [](auto const &l, auto const &r) {
+                        return tuple_util::all_of([](auto const &a, auto const &b) { return a == b; }, l, r);
+                    },
+                    lhs,
+                    rhs);
+            }
+
+            /*
+             *  The loops of a compiled stencil do not depend on where the fields are, only on their strides.
+             *
+             *  `make_loops` gets the fields that read their origins from the cells owned by this object and returns
+             *  the loops over them as a function without arguments. They are built on the first call and after that
+             *  a call only stores the origins of the given fields into the cells. If the strides of the fields differ
+             *  from the ones the loops are built for, the loops are built again.
+             */
+            template <class DataStores, class MakeLoops>
+            class rebinding_executable {
+                using ptrs_t = decltype(tuple_util::transform(get_origin_f(), std::declval<DataStores &>()));
+                using strides_t = decltype(tuple_util::transform(get_strides_f(), std::declval<DataStores &>()));
+                using fields_t = decltype(tuple_util::transform(
+                    make_field_f(), std::declval<DataStores &>(), std::declval<ptrs_t const &>()));
+                using loops_t = decltype(std::declval<MakeLoops &>()(std::declval<fields_t>()));
+
+                MakeLoops m_make_loops;
+                std::unique_ptr<ptrs_t> m_ptrs;
+                std::unique_ptr<strides_t> m_strides;
+                std::unique_ptr<loops_t> m_loops;
+
+              public:
+                rebinding_executable(MakeLoops make_loops) : m_make_loops(std::move(make_loops)) {}
+
+                void operator()(DataStores data_stores) {
+                    auto strides = tuple_util::transform(get_strides_f(), data_stores);
+                    if (!m_loops || !equal_strides(strides, *m_strides)) {
+                        m_loops.reset();
+                        m_ptrs.reset(new ptrs_t(tuple_util::transform(get_origin_f(), data_stores)));
+                        m_strides.reset(new strides_t(std::move(strides)));
+                        m_loops.reset(
+                            new loops_t(m_make_loops(tuple_util::transform(make_field_f(), data_stores, *m_ptrs))));
+                    } else {
+                        *m_ptrs = tuple_util::transform(get_origin_f(), data_stores);
+                    }
+                    (*m_loops)();
+                }
+            };
+
+            template <class DataStores, class MakeLoops>
+            rebinding_executable<DataStores, MakeLoops> make_rebinding_executable(MakeLoops make_loops) {
+                return {std::move(make_loops)};
+            }
+        } // namespace rebind_impl_
+        using rebind_impl_::make_rebinding_executable;
+    } // namespace stencil
+} // namespace gridtools
@@ -0,0 +1,57 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <memory>
+#include <utility>
+
+#include "../../thread_pool/concept.hpp"
+
+namespace gridtools {
+    namespace stencil {
+        namespace thread_count_guard_impl_ {
+            /*
+             *  The executable of a compiled stencil on the CPU backends has one slice of the temporaries and the caches
+             *  per thread, sized by the maximal number of threads of the pool when it is made. If the number of
+             *  threads grows later (`omp_set_num_threads`), the executable is made again before the call.
+             */
+            template <class ThreadPool, class Make>
+            class thread_count_guard {
+                using executable_t = decltype(std::declval<Make const &>()());
+
+                Make m_make;
+                int m_threads;
+                std::unique_ptr<executable_t> m_executable;
+
+              public:
+                thread_count_guard(Make make)
+                    : m_make(std::move(make)), m_threads(thread_pool::get_max_threads(ThreadPool())),
+                      m_executable(new executable_t(m_make())) {}
+
+                template <class DataStores>
+                void operator()(DataStores data_stores) {
+                    int threads = thread_pool::get_max_threads(ThreadPool());
+                    if (threads > m_threads) {
+                        m_executable.reset();
+                        m_threads = threads;
+                        m_executable.reset(new executable_t(m_make()));
+                    }
+                    (*m_executable)(std::move(data_stores));
+                }
+            };
+
+            template <class ThreadPool, class Make>
+            thread_count_guard<ThreadPool, Make> make_thread_count_guard(Make make) {
+                return {std::move(make)};
+            }
+        } // namespace thread_count_guard_impl_
+        using thread_count_guard_impl_::make_thread_count_guard;
+    } // namespace stencil
+} // namespace gridtools
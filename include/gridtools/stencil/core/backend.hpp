@@ -10,11 +10,14 @@
 #pragma once
 
 #include <functional>
+#include <type_traits>
 #include <utility>
 
+#include "../../common/defs.hpp"
 #include "../../common/hymap.hpp"
 #include "../../common/tuple.hpp"
 #include "../../common/tuple_util.hpp"
+#include "../../meta.hpp"
 #include "../../sid/sid_shift_origin.hpp"
 #include "convert_fe_to_be_spec.hpp"
 
@@ -40,8 +43,61 @@ namespace gridtools {
                             shift_origin(grid, std::move(data_stores)));
                     }
                 };
+
+                template <class Backend, class Spec, class Grid, class DataStores, class = void>
+                struct has_compile : std::false_type {};
+
+                template <class Backend, class Spec, class Grid, class DataStores>
+                struct has_compile<Backend,
+                    Spec,
+                    Grid,
+                    DataStores,
+                    void_t<decltype(gridtools_backend_compile(
+                        Backend(), Spec(), std::declval<Grid const &>(), meta::list<DataStores>()))>>
+                    : std::true_type {};
+
+                template <class Backend, class Spec, class DataStores, class Grid>
+                auto make_executable(std::true_type, Grid const &grid) {
+                    return gridtools_backend_compile(Backend(), Spec(), grid, meta::list<DataStores>());
+                }
+
+                template <class Backend, class Spec, class DataStores, class Grid>
+                auto make_executable(std::false_type, Grid const &grid) {
+                    return [grid](auto data_stores) {
+                        gridtools_backend_entry_point(Backend(), Spec(), grid, std::move(data_stores));
+                    };
+                }
+
+                /*
+                 *  The backend part of `stencil::compile` for the given types of the fields.
+                 *
+                 *  The backends that can do the setup of the stencil (allocation of the temporaries and so on) in
+                 *  advance provide `gridtools_backend_compile(backend, spec, grid, meta::list<DataStores>())` that
+                 *  returns a function to be called with the external data stores of the type `DataStores`. For the
+                 *  others every call goes to the entry point.
+                 */
+                template <class Backend, class Spec, class Grid, class DataStores>
+                class backend_executable {
+                    using be_spec_t = convert_fe_to_be_spec<Spec, typename Grid::interval_t, DataStores>;
+                    using be_data_stores_t =
+                        decltype(shift_origin(std::declval<Grid const &>(), std::declval<DataStores>()));
+                    using has_compile_t = has_compile<Backend, be_spec_t, Grid, be_data_stores_t>;
+                    using impl_t = decltype(make_executable<Backend, be_spec_t, be_data_stores_t>(
+                        has_compile_t(), std::declval<Grid const &>()));
+
+                    Grid m_grid;
+                    impl_t m_impl;
+
+                  public:
+                    backend_executable(Grid const &grid)
+                        : m_grid(grid),
+                          m_impl(make_executable<Backend, be_spec_t, be_data_stores_t>(has_compile_t(), grid)) {}
+
+                    void operator()(DataStores data_stores) { m_impl(shift_origin(m_grid, std::move(data_stores))); }
+                };
             } // namespace backend_impl_
             using backend_impl_::backend_entry_point_f;
+            using backend_impl_::backend_executable;
         } // namespace core
     }     // namespace stencil
 } // namespace gridtools
@@ -70,6 +70,16 @@ namespace gridtools {
                 class AllRwItems = meta::filter<esf_metafunctions_impl_::has_intent<intent::inout>::apply, AllItems>,
                 class AllRwArgs = meta::transform<meta::first, AllRwItems>>
             using compute_readwrite_args = meta::dedup<AllRwArgs>;
+
+            /**
+             * Compute a list of all args that are read (through `in` accessors) by at least one ESF
+             */
+            template <class Esfs,
+                class ItemLists = meta::transform<esf_metafunctions_impl_::get_items, Esfs>,
+                class AllItems = meta::flatten<ItemLists>,
+                class AllInItems = meta::filter<esf_metafunctions_impl_::has_intent<intent::in>::apply, AllItems>,
+                class AllInArgs = meta::transform<meta::first, AllInItems>>
+            using compute_read_only_args = meta::dedup<AllInArgs>;
         } // namespace core
     }     // namespace stencil
 } // namespace gridtools
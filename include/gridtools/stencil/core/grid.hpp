@@ -126,6 +126,18 @@ namespace gridtools {
                 auto size() const {
                     return tuple_util::make<hymap::keys<dim::i, dim::j, dim::k>::values>(i_size(), j_size(), k_size());
                 }
+
+                /**
+                 *  The grid with the same vertical axis and the given horizontal domain.
+                 */
+                grid horizontal_subgrid(int_t i_start, int_t i_size, int_t j_start, int_t j_size) const {
+                    grid res = *this;
+                    res.m_i_start = i_start;
+                    res.m_i_size = i_size;
+                    res.m_j_start = j_start;
+                    res.m_j_size = j_size;
+                    return res;
+                }
             };
 
             template <class T>
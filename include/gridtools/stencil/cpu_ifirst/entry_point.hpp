@@ -9,21 +9,32 @@
  */
 #pragma once
 
+#include <type_traits>
 #include <utility>
 
 #include "../../common/defs.hpp"
+#include "../../common/functional.hpp"
 #include "../../common/hymap.hpp"
 #include "../../common/integral_constant.hpp"
+#include "../../common/simd.hpp"
 #include "../../common/tuple_util.hpp"
 #include "../../meta.hpp"
 #include "../../sid/as_const.hpp"
 #include "../../sid/block.hpp"
 #include "../../sid/composite.hpp"
 #include "../../sid/concept.hpp"
+#include "../../thread_pool/concept.hpp"
 #include "../../thread_pool/omp.hpp"
 #include "../be_api.hpp"
+#include "../common/cached_view.hpp"
+#include "../common/caches.hpp"
 #include "../common/dim.hpp"
+#include "../common/extent.hpp"
+#include "../common/fill_flush.hpp"
+#include "../common/rebind.hpp"
+#include "../common/thread_count_guard.hpp"
 #include "execinfo.hpp"
+#include "k_cache.hpp"
 #include "loops.hpp"
 #include "pos3.hpp"
 #include "tmp_storage_sid.hpp"
@@ -31,20 +42,44 @@
 namespace gridtools {
     namespace stencil {
         namespace cpu_ifirst_backend {
-            template <class ThreadPool = thread_pool::omp>
+            /*
+             *  Non-positive block sizes are chosen depending on the grid size and the number of threads.
+             *
+             *  With the positive `Lanes` the i-loop is explicitly vectorized: the stages are evaluated for `Lanes`
+             *  consecutive points at once and the accessors return `simd` vectors (see `cpu_ifirst/simd.hpp`).
+             *  The elementary functors have to be written generically (no branches on the values, `select`, `min` and
+             *  `max` instead) and all the fields that vary along i have to be contiguous in i.
+             */
+            template <class ThreadPool = thread_pool::omp,
+                class IBlockSize = integral_constant<int_t, 0>,
+                class JBlockSize = integral_constant<int_t, 0>,
+                class Lanes = integral_constant<int_t, 0>>
             struct cpu_ifirst {
-                template <class Spec, class Grid, class DataStores>
-                friend void gridtools_backend_entry_point(
-                    cpu_ifirst, Spec, Grid const &grid, DataStores external_data_stores) {
-                    using stages_t = be_api::make_split_view<Spec>;
-                    using all_parrallel_t = typename meta::all_of<be_api::is_parallel,
-                        meta::transform<be_api::get_execution, stages_t>>::type;
+                template <class Spec>
+                using all_parrallel = typename meta::all_of<cached_view::is_parallel_matrix, Spec>::type;
 
-                    tmp_allocator alloc;
+                template <class Spec>
+                using stages =
+                    meta::if_<all_parrallel<Spec>, be_api::make_split_view<Spec>, cached_view::make_view<Spec>>;
+
+                template <class Spec, class DataStores>
+                static auto transform_data_stores(Spec, DataStores data_stores) {
+                    return fill_flush::transform_data_stores<typename stages<Spec>::plh_map_t>(std::move(data_stores));
+                }
 
-                    execinfo info(ThreadPool(), grid);
+                /*
+                 *  Allocates the temporaries and the caches and returns the function that builds the loops of the
+                 *  stencil over the given external fields. The loops are returned as a function without arguments
+                 *  (see `common/rebind.hpp`). The allocator is owned by the returned function.
+                 */
+                template <class Spec, class Grid, class Allocator>
+                static auto make_loops(Spec, Grid const &grid, Allocator alloc) {
+                    using all_parrallel_t = all_parrallel<Spec>;
+                    using stages_t = stages<Spec>;
 
-                    using tmp_plh_map_t = be_api::remove_caches_from_plh_map<typename stages_t::tmp_plh_map_t>;
+                    execinfo info(ThreadPool(), grid, IBlockSize::value, JBlockSize::value);
+
+                    using tmp_plh_map_t = cached_view::tmp_plh_map<stages_t>;
                     auto temporaries = be_api::make_data_stores(tmp_plh_map_t(),
                         [&alloc,
                             block_size = make_pos3(
@@ -56,37 +91,190 @@ namespace gridtools {
                                 ThreadPool>(alloc, block_size);
                         });
 
-                    auto blocked_externals = tuple_util::transform(
-                        [block_size = tuple_util::make<hymap::keys<dim::i, dim::j>::values>(
-                             info.i_block_size(), info.j_block_size())](auto &&data_store) {
-                            return sid::block(std::forward<decltype(data_store)>(data_store), block_size);
-                        },
-                        std::move(external_data_stores));
-
-                    auto data_stores = hymap::concat(std::move(blocked_externals), std::move(temporaries));
+                    auto tile_size = make_pos3((size_t)info.i_block_size(), (size_t)info.j_block_size(), (size_t)1);
 
-                    auto loops = tuple_util::transform(
+                    // the caches of every stage, `meta::list<>` for not cached placeholders
+                    auto caches = tuple_util::transform(
                         [&](auto stage) {
                             using stage_t = decltype(stage);
-                            auto k_sizes = tuple_util::transform(
-                                [&](auto cell) { return grid.k_size(cell.interval()); }, stage_t::cells());
-
                             using plh_map_t = typename stage_t::plh_map_t;
-                            using keys_t = meta::rename<sid::composite::keys, meta::transform<meta::first, plh_map_t>>;
-                            auto composite = tuple_util::convert_to<keys_t::template values>(tuple_util::transform(
-                                [&](auto info) {
-                                    return sid::add_const(info.is_const(), at_key<decltype(info.plh())>(data_stores));
-                                },
-                                stage_t::plh_map()));
-                            return make_loop<ThreadPool, stage_t>(
-                                all_parrallel_t(), grid, std::move(composite), std::move(k_sizes));
+                            return tuple_util::transform(
+                                overload(
+                                    [&](meta::list<cache_type::ij>, auto info) {
+                                        return make_tmp_storage<decltype(info.data()),
+                                            to_horizontal_extent<decltype(info.extent())>,
+                                            true,
+                                            ThreadPool>(alloc, tile_size);
+                                    },
+                                    [&](meta::list<cache_type::k>, auto info) {
+                                        return make_k_cache<std::remove_const_t<decltype(info.data())>,
+                                            decltype(info.extent()),
+                                            ThreadPool>(alloc, tile_size.i);
+                                    },
+                                    [&](meta::list<>, auto) { return meta::list<>(); }),
+                                meta::transform<cached_view::served_caches_f<stage_t>::template apply, plh_map_t>(),
+                                plh_map_t());
                         },
                         meta::rename<tuple, stages_t>());
 
-                    run_loops<ThreadPool>(all_parrallel_t(), grid, std::move(loops));
+                    return [alloc = std::move(alloc),
+                               temporaries = std::move(temporaries),
+                               caches = std::move(caches),
+                               grid,
+                               info](auto external_data_stores) {
+                        auto blocked_externals = tuple_util::transform(
+                            [block_size = tuple_util::make<hymap::keys<dim::i, dim::j>::values>(
+                                 info.i_block_size(), info.j_block_size())](auto &&data_store) {
+                                return sid::block(std::forward<decltype(data_store)>(data_store), block_size);
+                            },
+                            std::move(external_data_stores));
+
+                        auto data_stores = hymap::concat(std::move(blocked_externals), temporaries);
+
+                        auto loops = tuple_util::transform(
+                            [&](auto stage, auto const &stage_caches) {
+                                using stage_t = decltype(stage);
+                                auto k_sizes = make_k_sizes(stage, grid);
+
+                                using plh_map_t = typename stage_t::plh_map_t;
+                                using keys_t =
+                                    meta::rename<sid::composite::keys, meta::transform<meta::first, plh_map_t>>;
+                                auto composite = tuple_util::convert_to<keys_t::template values>(tuple_util::transform(
+                                    overload([&](auto cache, auto) { return cache; },
+                                        [&](meta::list<>, auto info) {
+                                            return sid::add_const(
+                                                info.is_const(), at_key<decltype(info.plh())>(data_stores));
+                                        }),
+                                    stage_caches,
+                                    plh_map_t()));
+                                return make_loop<ThreadPool, integral_constant<int_t, Lanes::value>, stage_t>(
+                                    meta::if_<all_parrallel_t, std::true_type, cached_view::stage_caches<stage_t>>(),
+                                    grid,
+                                    std::move(composite),
+                                    std::move(k_sizes));
+                            },
+                            meta::rename<tuple, stages_t>(),
+                            caches);
+
+                        return [loops = std::move(loops), grid, info] {
+                            run_loops<ThreadPool>(all_parrallel_t(), grid, info, loops);
+                        };
+                    };
+                }
+
+                template <class Spec, class Grid, class DataStores>
+                friend void gridtools_backend_entry_point(
+                    cpu_ifirst, Spec, Grid const &grid, DataStores external_data_stores) {
+                    make_loops(Spec(), grid, tmp_allocator<ThreadPool>())(
+                        transform_data_stores(Spec(), std::move(external_data_stores)))();
+                }
+
+                /*
+                 *  The executable of `stencil::compile`: the temporaries and the caches are allocated once and the
+                 *  loops are built once and reused by every call.
+                 */
+                template <class Spec, class Grid, class DataStores>
+                friend auto gridtools_backend_compile(cpu_ifirst, Spec, Grid const &grid, meta::list<DataStores>) {
+                    using data_stores_t = decltype(transform_data_stores(Spec(), std::declval<DataStores>()));
+                    return make_thread_count_guard<ThreadPool>([grid] {
+                        return [executable = make_rebinding_executable<data_stores_t>(
+                                    make_loops(Spec(), grid, persistent_tmp_allocator<ThreadPool>()))](
+                                   DataStores external_data_stores) mutable {
+                            executable(transform_data_stores(Spec(), std::move(external_data_stores)));
+                        };
+                    });
                 }
             };
+
+            template <class ThreadPool, class IBlockSize, class JBlockSize, class KParallel>
+            struct first_touch_blocks_f {
+                template <class F>
+                void operator()(int_t i_size, int_t j_size, int_t k_size, F const &f) const {
+                    execinfo info(ThreadPool(), i_size, j_size, IBlockSize::value, JBlockSize::value);
+                    run(KParallel(), info, k_size, f);
+                }
+
+              private:
+                // as `run_loops` of the k-serial stencils
+                template <class F>
+                static void run(std::false_type, execinfo const &info, int_t k_size, F const &f) {
+                    thread_pool::parallel_for_loop(ThreadPool(),
+                        [&](auto i, auto j) {
+                            auto block = info.block(i, j);
+                            int_t i_begin = i * info.i_block_size();
+                            int_t j_begin = j * info.j_block_size();
+                            f(i_begin,
+                                i_begin + block.i_block_size,
+                                j_begin,
+                                j_begin + block.j_block_size,
+                                0,
+                                k_size);
+                        },
+                        info.i_blocks(),
+                        info.j_blocks());
+                }
+
+                // as `run_loops` of the k-parallel stencils
+                template <class F>
+                static void run(std::true_type, execinfo const &info, int_t k_size, F const &f) {
+                    thread_pool::parallel_for_loop(ThreadPool(),
+                        [&](auto i, auto k, auto j) {
+                            auto block = info.block(i, j, k);
+                            int_t i_begin = i * info.i_block_size();
+                            int_t j_begin = j * info.j_block_size();
+                            f(i_begin,
+                                i_begin + block.i_block_size,
+                                j_begin,
+                                j_begin + block.j_block_size,
+                                block.k,
+                                block.k + 1);
+                        },
+                        info.i_blocks(),
+                        k_size,
+                        info.j_blocks());
+                }
+            };
+
+            /*
+             *  The blocks in the order in which they are distributed over the threads by `run_loops`.
+             *  To be passed to `storage::builder<...>.first_touch(...)`. By default the blocks are the ones of the
+             *  k-serial stencils, with `KParallel` set they are the ones of the stencils whose multi stages are all
+             *  parallel (every level of a block is a separate task).
+             */
+            template <class ThreadPool,
+                class IBlockSize,
+                class JBlockSize,
+                class Lanes,
+                class KParallel = std::false_type>
+            first_touch_blocks_f<ThreadPool, IBlockSize, JBlockSize, KParallel> first_touch_blocks(
+                cpu_ifirst<ThreadPool, IBlockSize, JBlockSize, Lanes>, KParallel = {}) {
+                return {};
+            }
+
+            /*
+             *  The thread pool of the backend and the backend rebound to another pool (see `time_blocked_run`).
+             */
+            template <class ThreadPool, class IBlockSize, class JBlockSize, class Lanes>
+            ThreadPool backend_thread_pool(cpu_ifirst<ThreadPool, IBlockSize, JBlockSize, Lanes>) {
+                return {};
+            }
+
+            template <class ThreadPool, class IBlockSize, class JBlockSize, class Lanes, class Other>
+            cpu_ifirst<Other, IBlockSize, JBlockSize, Lanes> backend_with_thread_pool(
+                cpu_ifirst<ThreadPool, IBlockSize, JBlockSize, Lanes>, Other) {
+                return {};
+            }
+
+            /*
+             *  `cpu_ifirst` vectorized with the native vector width of the target ISA for `T`.
+             */
+            template <class T = double, class ThreadPool = thread_pool::omp>
+            using cpu_ifirst_simd = cpu_ifirst<ThreadPool,
+                integral_constant<int_t, 0>,
+                integral_constant<int_t, 0>,
+                integral_constant<int_t, simd::native_lanes<T>()>>;
         } // namespace cpu_ifirst_backend
         using cpu_ifirst_backend::cpu_ifirst;
+        using cpu_ifirst_backend::cpu_ifirst_simd;
     } // namespace stencil
 } // namespace gridtools
@@ -10,6 +10,9 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cassert>
+
 #include "../../common/defs.hpp"
 #include "../../common/host_device.hpp"
 #include "../../thread_pool/concept.hpp"
@@ -54,23 +57,34 @@ namespace gridtools {
                 }
 
               public:
-                template <class ThreadPool, class Grid>
-                GT_FORCE_INLINE execinfo(ThreadPool, const Grid &grid)
-                    : m_i_grid_size(grid.i_size()), m_j_grid_size(grid.j_size()) {
+                /**
+                 * @brief Splits the grid into blocks.
+                 *
+                 * Non-positive block sizes are derived from the grid size and the number of threads.
+                 */
+                template <class ThreadPool>
+                GT_FORCE_INLINE execinfo(
+                    ThreadPool, int_t i_grid_size, int_t j_grid_size, int_t i_block_size = 0, int_t j_block_size = 0)
+                    : m_i_grid_size(i_grid_size), m_j_grid_size(j_grid_size) {
                     int_t threads = thread_pool::get_max_threads(ThreadPool());
 
                     // if domain is large enough (relative to the number of threads),
                     // we split only along j-axis (for prefetching reasons)
                     // for smaller domains we also split along i-axis
-                    m_j_block_size = (m_j_grid_size + threads - 1) / threads;
+                    m_j_block_size = j_block_size > 0 ? j_block_size : (m_j_grid_size + threads - 1) / threads;
                     m_j_blocks = (m_j_grid_size + m_j_block_size - 1) / m_j_block_size;
-                    int_t max_i_blocks = threads / m_j_blocks;
-                    m_i_block_size = (m_i_grid_size + max_i_blocks - 1) / max_i_blocks;
+                    int_t max_i_blocks = std::max(threads / m_j_blocks, 1);
+                    m_i_block_size =
+                        i_block_size > 0 ? i_block_size : (m_i_grid_size + max_i_blocks - 1) / max_i_blocks;
                     m_i_blocks = (m_i_grid_size + m_i_block_size - 1) / m_i_block_size;
 
                     assert(m_i_block_size > 0 && m_j_block_size > 0);
                 }
 
+                template <class ThreadPool, class Grid>
+                GT_FORCE_INLINE execinfo(ThreadPool, const Grid &grid, int_t i_block_size = 0, int_t j_block_size = 0)
+                    : execinfo(ThreadPool(), grid.i_size(), grid.j_size(), i_block_size, j_block_size) {}
+
                 /**
                  * @brief Computes the effective (clamped) block size and position for k-serial stencils.
                  *
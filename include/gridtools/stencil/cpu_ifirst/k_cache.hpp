@@ -0,0 +1,88 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <cstddef>
+
+#include "../../common/defs.hpp"
+#include "../../common/host_device.hpp"
+#include "../../common/hymap.hpp"
+#include "../../common/integral_constant.hpp"
+#include "../../meta.hpp"
+#include "../../sid/allocator.hpp"
+#include "../../sid/concept.hpp"
+#include "../../sid/synthetic.hpp"
+#include "../../thread_pool/concept.hpp"
+#include "../common/dim.hpp"
+#include "tmp_storage_sid.hpp"
+
+namespace gridtools {
+    namespace stencil {
+        namespace cpu_ifirst_backend {
+            namespace _impl_k_cache {
+                template <std::size_t, class>
+                struct strides_kind_impl;
+
+                template <class T, class Extent>
+                using strides_kind = strides_kind_impl<sizeof(T), Extent>;
+
+                template <class Extent>
+                using window_size = integral_constant<int_t, Extent::kplus::value - Extent::kminus::value + 1>;
+            } // namespace _impl_k_cache
+
+            /**
+             * @brief K-cache window: the levels `[kminus, kplus]` around the current one for a single row of the block.
+             *
+             * The window doesn't move along j and the caller is responsible to keep it at the current level.
+             */
+            template <class T, class Extent, class ThreadPool, class Allocator>
+            auto make_k_cache(Allocator &allocator, std::size_t i_block_size) {
+                using namespace literals;
+                int_t size_i = _impl_tmp::pad<T>(Extent::extend(dim::i(), i_block_size));
+                int_t size_k = _impl_k_cache::window_size<Extent>::value;
+                int_t offset = -Extent::iminus::value - size_i * Extent::kminus::value;
+                return sid::synthetic()
+                    .set<sid::property::origin>(
+                        allocate(allocator,
+                            meta::lazy::id<T>(),
+                            size_i * size_k * thread_pool::get_max_threads(ThreadPool())) +
+                        offset)
+                    .template set<sid::property::strides>(
+                        hymap::keys<dim::i, dim::k, dim::thread>::values<integral_constant<int_t, 1>, int_t, int_t>(
+                            1_c, size_i, size_i * size_k))
+                    .template set<sid::property::strides_kind, _impl_k_cache::strides_kind<T, Extent>>()
+                    .template set<sid::property::ptr_diff, int_t>();
+            }
+
+            /**
+             * @brief Moves the k-cache window of the given placeholder by one level in the direction of `Step`.
+             *
+             * The window pointer is shifted in the opposite direction to compensate the subsequent `inc_k`.
+             */
+            template <class PlhInfo, class Step, class Ptr, class Strides>
+            GT_FORCE_INLINE void slide_k_cache(int_t i_size, Ptr &ptr, Strides const &strides) {
+                using extent_t = typename PlhInfo::extent_t;
+                using key_t = typename PlhInfo::key_t;
+                auto &&stride = sid::get_stride_element<key_t, dim::k>(strides);
+                auto &cur = host::at_key<key_t>(ptr);
+                auto dst = cur;
+                sid::shift(dst, stride, Step::value > 0 ? extent_t::kminus::value : extent_t::kplus::value);
+                for (int_t k = extent_t::kminus::value; k < extent_t::kplus::value; ++k) {
+                    auto src = dst;
+                    sid::shift(src, stride, Step());
+                    for (int_t i = 0; i < i_size; ++i)
+                        dst[i] = src[i];
+                    dst = src;
+                }
+                sid::shift(cur, stride, integral_constant<int_t, -Step::value>());
+            }
+        } // namespace cpu_ifirst_backend
+    }     // namespace stencil
+} // namespace gridtools
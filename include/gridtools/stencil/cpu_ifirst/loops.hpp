@@ -14,20 +14,29 @@
 
 #include "../../common/defs.hpp"
 #include "../../common/generic_metafunctions/for_each.hpp"
+#include "../../common/host_device.hpp"
+#include "../../common/hymap.hpp"
+#include "../../common/integral_constant.hpp"
 #include "../../common/omp.hpp"
 #include "../../common/tuple_util.hpp"
 #include "../../meta.hpp"
 #include "../../sid/concept.hpp"
 #include "../../thread_pool/concept.hpp"
+#include "../be_api.hpp"
+#include "../common/cached_view.hpp"
+#include "../common/caches.hpp"
 #include "../common/dim.hpp"
 #include "execinfo.hpp"
+#include "k_cache.hpp"
+#include "simd.hpp"
 
 namespace gridtools {
     namespace stencil {
         namespace cpu_ifirst_backend {
             namespace loops_impl_ {
                 template <class Stage, class Ptr, class Strides>
-                GT_FORCE_INLINE void i_loop(int_t size, Stage stage, Ptr &ptr, Strides const &strides) {
+                GT_FORCE_INLINE void i_loop(
+                    integral_constant<int_t, 0>, int_t size, Stage stage, Ptr &ptr, Strides const &strides) {
 #ifdef NDEBUG
 // TODO(anstaf & fthaler):
 //   Maybe we have to re-run tests with different combinations of pragmas on different compilers,
@@ -43,7 +52,13 @@ namespace gridtools {
                     sid::shift(ptr, sid::get_stride<dim::i>(strides), -size);
                 }
 
-                template <class Ptr, class Strides>
+                template <int_t Lanes, class Stage, class Ptr, class Strides>
+                GT_FORCE_INLINE void i_loop(
+                    integral_constant<int_t, Lanes>, int_t size, Stage stage, Ptr &ptr, Strides const &strides) {
+                    vectorized_i_loop<integral_constant<int_t, Lanes>>(size, stage, ptr, strides);
+                }
+
+                template <class Lanes, class Ptr, class Strides>
                 struct k_i_loops_f {
                     int_t m_i_size;
                     Ptr &m_ptr;
@@ -52,19 +67,29 @@ namespace gridtools {
                     template <class Cell, class KSize>
                     GT_FORCE_INLINE void operator()(Cell cell, KSize k_size) const {
                         for (int_t k = 0; k < k_size; ++k) {
-                            i_loop(m_i_size, cell, m_ptr, m_strides);
+                            i_loop(Lanes(), m_i_size, cell, m_ptr, m_strides);
                             cell.inc_k(m_ptr, m_strides);
                         }
                     }
                 };
 
-                template <class Ptr, class Strides>
-                GT_FORCE_INLINE k_i_loops_f<Ptr, Strides> make_k_i_loops(
+                template <class Lanes, class Ptr, class Strides>
+                GT_FORCE_INLINE k_i_loops_f<Lanes, Ptr, Strides> make_k_i_loops(
                     int_t i_size, Ptr &ptr, Strides const &strides) {
                     return {i_size, ptr, strides};
                 }
 
-                template <class ThreadPool, class Stage, class Grid, class Composite, class KSizes>
+                template <class... Cells, class Grid>
+                auto make_k_sizes(be_api::split_view_item<Cells...> stage, Grid const &grid) {
+                    return be_api::make_k_sizes(stage.cells(), grid);
+                }
+
+                template <class... IntervalInfos, class Grid>
+                auto make_k_sizes(be_api::fused_view_item<IntervalInfos...> stage, Grid const &grid) {
+                    return be_api::make_k_sizes(stage.interval_infos(), grid);
+                }
+
+                template <class ThreadPool, class Lanes, class Stage, class Grid, class Composite, class KSizes>
                 auto make_loop(std::true_type, Grid const &grid, Composite composite, KSizes k_sizes) {
                     using extent_t = typename Stage::extent_t;
                     using ptr_diff_t = sid::ptr_diff_type<Composite>;
@@ -93,7 +118,7 @@ namespace gridtools {
                             tuple_util::for_each(
                                 [&ptr, &strides, &cur, k = info.k, i_size](auto cell, auto k_size) {
                                     if (k >= cur && k < cur + k_size)
-                                        i_loop(i_size, cell, ptr, strides);
+                                        i_loop(Lanes(), i_size, cell, ptr, strides);
                                     cur += k_size;
                                 },
                                 Stage::cells(),
@@ -104,8 +129,7 @@ namespace gridtools {
                 }
 
                 template <class ThreadPool, class Grid, class Loops>
-                void run_loops(std::true_type, Grid const &grid, Loops loops) {
-                    execinfo info(ThreadPool(), grid);
+                void run_loops(std::true_type, Grid const &grid, execinfo const &info, Loops const &loops) {
                     int_t i_blocks = info.i_blocks();
                     int_t j_blocks = info.j_blocks();
                     int_t k_size = grid.k_size();
@@ -118,8 +142,8 @@ namespace gridtools {
                         j_blocks);
                 }
 
-                template <class ThreadPool, class Stage, class Grid, class Composite, class KSizes>
-                auto make_loop(std::false_type, Grid const &grid, Composite composite, KSizes k_sizes) {
+                template <class ThreadPool, class Lanes, class Stage, class Grid, class Composite, class KSizes>
+                auto make_loop(meta::list<>, Grid const &grid, Composite composite, KSizes k_sizes) {
                     using extent_t = typename Stage::extent_t;
                     using ptr_diff_t = sid::ptr_diff_type<Composite>;
 
@@ -144,7 +168,7 @@ namespace gridtools {
                         int_t j_size = extent_t::extend(dim::j(), info.j_block_size);
                         int_t i_size = extent_t::extend(dim::i(), info.i_block_size);
 
-                        auto k_i_loops = make_k_i_loops(i_size, ptr, strides);
+                        auto k_i_loops = make_k_i_loops<Lanes>(i_size, ptr, strides);
                         for (int_t j = 0; j < j_size; ++j) {
                             using namespace literals;
                             tuple_util::for_each(k_i_loops, Stage::cells(), k_sizes);
@@ -154,9 +178,120 @@ namespace gridtools {
                     };
                 }
 
+                /*
+                 *  All the stages of the multi stage are executed row by row, each row is processed level by level.
+                 *  K-cached placeholders are kept in the windows that slide along with the current level.
+                 */
+                template <class ThreadPool, class Lanes, class Stage, class Grid, class Composite, class KSizes>
+                auto make_loop(meta::list<cache_type::k>, Grid const &grid, Composite composite, KSizes k_sizes) {
+                    using extent_t = typename Stage::extent_t;
+                    using ptr_diff_t = sid::ptr_diff_type<Composite>;
+                    using k_caches_t =
+                        meta::filter<cached_view::is_cached_f<cache_type::k>::apply, typename Stage::plh_map_t>;
+
+                    auto strides = sid::get_strides(composite);
+                    ptr_diff_t offset{};
+                    sid::shift(offset, sid::get_stride<dim::i>(strides), extent_t::minus(dim::i()));
+                    sid::shift(offset, sid::get_stride<dim::j>(strides), extent_t::minus(dim::j()));
+                    auto k_start = grid.k_start(Stage::interval(), Stage::execution());
+                    sid::shift(offset, sid::get_stride<dim::k>(strides), k_start);
+                    // the windows are not shifted to the start level
+                    for_each<k_caches_t>([&](auto info) {
+                        using key_t = typename decltype(info)::key_t;
+                        sid::shift(
+                            host::at_key<key_t>(offset), sid::get_stride_element<key_t, dim::k>(strides), -k_start);
+                    });
+
+                    return [origin = sid::get_origin(composite) + offset,
+                               strides = std::move(strides),
+                               k_sizes = std::move(k_sizes)](execinfo_block_kserial const &info) {
+                        ptr_diff_t offset{};
+                        sid::shift(
+                            offset, sid::get_stride<dim::thread>(strides), thread_pool::get_thread_num(ThreadPool()));
+                        sid::shift(offset, sid::get_stride<sid::blocked_dim<dim::i>>(strides), info.i_block);
+                        sid::shift(offset, sid::get_stride<sid::blocked_dim<dim::j>>(strides), info.j_block);
+                        auto ptr = origin() + offset;
+
+                        int_t j_size = extent_t::extend(dim::j(), info.j_block_size);
+                        int_t i_size = extent_t::extend(dim::i(), info.i_block_size);
+
+                        for (int_t j = 0; j < j_size; ++j) {
+                            using namespace literals;
+                            auto row = ptr;
+                            tuple_util::for_each(
+                                [&row, &strides, i_size](auto interval, auto k_size) {
+                                    for (int_t k = 0; k < k_size; ++k) {
+                                        tuple_util::for_each(
+                                            [&](auto cell) { i_loop(Lanes(), i_size, cell, row, strides); },
+                                            interval.cells());
+                                        for_each<k_caches_t>([&](auto cache) {
+                                            slide_k_cache<decltype(cache), decltype(interval.k_step())>(
+                                                i_size, row, strides);
+                                        });
+                                        interval.inc_k(row, strides);
+                                    }
+                                },
+                                Stage::interval_infos(),
+                                k_sizes);
+                            sid::shift(ptr, sid::get_stride<dim::j>(strides), 1_c);
+                        }
+                    };
+                }
+
+                /*
+                 *  All the stages of the multi stage are executed for the given block level by level.
+                 *  IJ-cached placeholders are kept in the tiles that are reused for every level.
+                 */
+                template <class ThreadPool, class Lanes, class Stage, class Grid, class Composite, class KSizes>
+                auto make_loop(meta::list<cache_type::ij>, Grid const &grid, Composite composite, KSizes k_sizes) {
+                    using ptr_diff_t = sid::ptr_diff_type<Composite>;
+
+                    auto strides = sid::get_strides(composite);
+                    ptr_diff_t offset{};
+                    sid::shift(
+                        offset, sid::get_stride<dim::k>(strides), grid.k_start(Stage::interval(), Stage::execution()));
+
+                    return [origin = sid::get_origin(composite) + offset,
+                               strides = std::move(strides),
+                               k_sizes = std::move(k_sizes)](execinfo_block_kserial const &info) {
+                        ptr_diff_t offset{};
+                        sid::shift(
+                            offset, sid::get_stride<dim::thread>(strides), thread_pool::get_thread_num(ThreadPool()));
+                        sid::shift(offset, sid::get_stride<sid::blocked_dim<dim::i>>(strides), info.i_block);
+                        sid::shift(offset, sid::get_stride<sid::blocked_dim<dim::j>>(strides), info.j_block);
+                        auto ptr = origin() + offset;
+
+                        tuple_util::for_each(
+                            [&](auto interval, auto k_size) {
+                                for (int_t k = 0; k < k_size; ++k) {
+                                    tuple_util::for_each(
+                                        [&](auto cell) {
+                                            using namespace literals;
+                                            using extent_t = typename decltype(cell)::extent_t;
+                                            ptr_diff_t offset{};
+                                            sid::shift(
+                                                offset, sid::get_stride<dim::i>(strides), extent_t::minus(dim::i()));
+                                            sid::shift(
+                                                offset, sid::get_stride<dim::j>(strides), extent_t::minus(dim::j()));
+                                            auto row = ptr + offset;
+                                            int_t j_size = extent_t::extend(dim::j(), info.j_block_size);
+                                            int_t i_size = extent_t::extend(dim::i(), info.i_block_size);
+                                            for (int_t j = 0; j < j_size; ++j) {
+                                                i_loop(Lanes(), i_size, cell, row, strides);
+                                                sid::shift(row, sid::get_stride<dim::j>(strides), 1_c);
+                                            }
+                                        },
+                                        interval.cells());
+                                    interval.inc_k(ptr, strides);
+                                }
+                            },
+                            Stage::interval_infos(),
+                            k_sizes);
+                    };
+                }
+
                 template <class ThreadPool, class Grid, class Loops>
-                void run_loops(std::false_type, Grid const &grid, Loops loops) {
-                    execinfo info(ThreadPool(), grid);
+                void run_loops(std::false_type, Grid const &grid, execinfo const &info, Loops const &loops) {
                     thread_pool::parallel_for_loop(ThreadPool(),
                         [&](auto i, auto j) {
                             tuple_util::for_each([block = info.block(i, j)](auto &&loop) { loop(block); }, loops);
@@ -165,6 +300,7 @@ namespace gridtools {
                         info.j_blocks());
                 }
             } // namespace loops_impl_
+            using loops_impl_::make_k_sizes;
             using loops_impl_::make_loop;
             using loops_impl_::run_loops;
         } // namespace cpu_ifirst_backend
@@ -0,0 +1,167 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <type_traits>
+#include <utility>
+
+#include "../../common/defs.hpp"
+#include "../../common/generic_metafunctions/for_each.hpp"
+#include "../../common/host_device.hpp"
+#include "../../common/integral_constant.hpp"
+#include "../../common/simd.hpp"
+#include "../../meta.hpp"
+#include "../../sid/concept.hpp"
+#include "../common/dim.hpp"
+#include "../common/intent.hpp"
+
+/**
+ *  @file
+ *  The explicitly vectorized i-loop of `cpu_ifirst` (selected by the non-zero `Lanes` parameter of the backend).
+ *
+ *  The row is processed in chunks of `Lanes` points; the tail of the row is processed in chunks of halving width down
+ *  to a single point, so every point is computed exactly once with vector code. The stages get a `Deref` that makes
+ *  the accessors return:
+ *    - `simd::ref<T, Lanes>` for the fields with the unit i-stride (storages with the innermost i, temporaries and
+ *      caches);
+ *    - the plain reference for the fields that don't depend on i (masked i-dimension, global parameters);
+ *    - the `simd::vec` of the gathered values for the other read only data with the compile time i-stride
+ *      (i-positionals).
+ *  The fields with the run time i-stride are not supported.
+ *
+ *  Only the stages that declare `vectorizable_t` get the vector references, the others (like cache fill and flush)
+ *  are executed point by point.
+ */
+
+namespace gridtools {
+    namespace stencil {
+        template <class T, int N>
+        struct apply_intent_type<intent::in, simd::ref<T, N>> {
+            using type = simd::ref<T const, N>;
+        };
+
+        template <class T, int N>
+        struct apply_intent_type<intent::inout, simd::ref<T, N>> {
+            using type = simd::ref<T, N>;
+        };
+
+        template <class T, int N>
+        struct apply_intent_type<intent::inout, simd::ref<T const, N>> {};
+
+        namespace cpu_ifirst_backend {
+            namespace simd_impl_ {
+                template <class Fun, class = void>
+                struct is_vectorizable : std::false_type {};
+
+                template <class Fun>
+                struct is_vectorizable<Fun, void_t<typename Fun::vectorizable_t>> : Fun::vectorizable_t {};
+
+                template <class T, class = void>
+                struct is_zero : std::false_type {};
+
+                template <class T>
+                struct is_zero<T, std::enable_if_t<T::value == 0>> : std::true_type {};
+
+                template <class T, class = void>
+                struct is_one : std::false_type {};
+
+                template <class T>
+                struct is_one<T, std::enable_if_t<T::value == 1>> : std::true_type {};
+
+                template <int_t Lanes, class Stride, class Ptr>
+                GT_FORCE_INLINE decltype(auto) deref(std::true_type, Stride, Ptr const &ptr) {
+                    return *ptr;
+                }
+
+                template <int_t Lanes, class Stride, class T, std::enable_if_t<is_one<Stride>::value, int> = 0>
+                GT_FORCE_INLINE simd::ref<T, Lanes> deref(std::false_type, Stride, T *ptr) {
+                    return {ptr};
+                }
+
+                template <int_t Lanes,
+                    class Stride,
+                    class Ptr,
+                    std::enable_if_t<!is_one<Stride>::value || !std::is_pointer<Ptr>::value, int> = 0>
+                GT_FORCE_INLINE auto deref(std::false_type, Stride stride, Ptr ptr) {
+                    static_assert(std::is_empty<Stride>::value,
+                        "the vectorized cpu_ifirst backend doesn't support the fields with the run time i-stride");
+                    simd::vec<std::decay_t<decltype(*ptr)>, Lanes> res;
+                    for (int i = 0; i != Lanes; ++i) {
+                        using namespace literals;
+                        res.m_data[i] = *ptr;
+                        sid::shift(ptr, stride, 1_c);
+                    }
+                    return res;
+                }
+
+                template <int_t Lanes, class Strides>
+                struct deref_f {
+                    template <class Key, class Ptr>
+                    GT_FORCE_INLINE decltype(auto) operator()(Key, Ptr const &ptr) const {
+                        using stride_t = std::decay_t<decltype(
+                            sid::get_stride_element<Key, dim::i>(std::declval<Strides const &>()))>;
+                        return deref<Lanes>(is_zero<stride_t>(), stride_t(), ptr);
+                    }
+                };
+
+                template <class Fun, class Ptr, class Strides>
+                GT_FORCE_INLINE void chunk_loop(
+                    integral_constant<int_t, 0>, int_t, int_t &, Fun &, Ptr &, Strides const &) {}
+
+                /*
+                 *  Processes the chunks of `Lanes` points while they fit into the row, then continues with the halved
+                 *  width.
+                 */
+                template <int_t Lanes, class Fun, class Ptr, class Strides>
+                GT_FORCE_INLINE void chunk_loop(integral_constant<int_t, Lanes> lanes,
+                    int_t size,
+                    int_t &i,
+                    Fun &fun,
+                    Ptr &ptr,
+                    Strides const &strides) {
+                    for (; i + Lanes <= size; i += Lanes) {
+                        fun.template operator()<deref_f<Lanes, Strides>>(ptr, strides);
+                        sid::shift(ptr, sid::get_stride<dim::i>(strides), lanes);
+                    }
+                    chunk_loop(integral_constant<int_t, Lanes / 2>(), size, i, fun, ptr, strides);
+                }
+
+                template <class Lanes, class Fun, class Ptr, class Strides>
+                GT_FORCE_INLINE void fun_loop(std::true_type, int_t size, Fun fun, Ptr &ptr, Strides const &strides) {
+                    int_t i = 0;
+                    chunk_loop(Lanes(), size, i, fun, ptr, strides);
+                    sid::shift(ptr, sid::get_stride<dim::i>(strides), -size);
+                }
+
+                template <class Lanes, class Fun, class Ptr, class Strides>
+                GT_FORCE_INLINE void fun_loop(std::false_type, int_t size, Fun fun, Ptr &ptr, Strides const &strides) {
+                    for (int_t i = 0; i < size; ++i) {
+                        using namespace literals;
+                        fun(ptr, strides);
+                        sid::shift(ptr, sid::get_stride<dim::i>(strides), 1_c);
+                    }
+                    sid::shift(ptr, sid::get_stride<dim::i>(strides), -size);
+                }
+
+                /*
+                 *  The stages of the cell are executed one after another for the whole row. The stages within the cell
+                 *  don't access each other outputs at the i-offsets, so that is equivalent to the point by point order.
+                 */
+                template <class Lanes, class Cell, class Ptr, class Strides>
+                GT_FORCE_INLINE void vectorized_i_loop(int_t size, Cell, Ptr &ptr, Strides const &strides) {
+                    for_each<typename Cell::funs_t>([&](auto fun) {
+                        fun_loop<Lanes>(is_vectorizable<decltype(fun)>(), size, fun, ptr, strides);
+                    });
+                }
+            } // namespace simd_impl_
+            using simd_impl_::vectorized_i_loop;
+        } // namespace cpu_ifirst_backend
+    }     // namespace stencil
+} // namespace gridtools
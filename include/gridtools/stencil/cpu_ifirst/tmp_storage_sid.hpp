@@ -18,6 +18,7 @@
 #include "../../sid/simple_ptr_holder.hpp"
 #include "../../sid/synthetic.hpp"
 #include "../../thread_pool/concept.hpp"
+#include "../../thread_pool/first_touch.hpp"
 #include "../common/dim.hpp"
 #include "pos3.hpp"
 
@@ -63,14 +64,17 @@ namespace gridtools {
                     return bs.i * bs.j * bs.k * thread_pool::get_max_threads(ThreadPool()) + extra;
                 }
 
-                template <std::size_t, class>
+                template <std::size_t, class, bool>
                 struct strides_kind_impl;
 
                 /**
-                 * @brief Strides kind tag. Strides depend on data type size (due to cache-line alignment) and extent.
+                 * @brief Strides kind tag. Strides depend on data type size (due to cache-line alignment), extent and
+                 * on the presence of the k-dimension.
                  */
-                template <class T, class Extent>
-                using strides_kind = strides_kind_impl<sizeof(T), Extent>;
+                template <class T, class Extent, bool AllParallel>
+                using strides_kind = strides_kind_impl<sizeof(T),
+                    Extent,
+                    !AllParallel || Extent::kminus::value != 0 || Extent::kplus::value != 0>;
 
                 /**
                  * @brief Strides, depending on data type due to padding to cache-line size. Specialization for non-zero
@@ -114,18 +118,36 @@ namespace gridtools {
                     return pad<T>(offset);
                 }
 
+                /**
+                 * @brief Allocates the temporaries in huge pages. The per thread slabs are first touched by the
+                 * threads that own them, so the pool reuses them only for the same size and number of threads.
+                 */
+                template <class ThreadPool>
                 struct make_allocation_f {
                     auto operator()(size_t size) const {
-                        return std::unique_ptr<void, GT_INTEGRAL_CONSTANT_FROM_VALUE(&hugepage_free)>(
+                        auto res = std::unique_ptr<void, GT_INTEGRAL_CONSTANT_FROM_VALUE(&hugepage_free)>(
                             hugepage_alloc(size));
+                        thread_pool::first_touch(ThreadPool(), res.get(), size);
+                        return res;
+                    }
+
+                    friend std::size_t allocation_placement(make_allocation_f) {
+                        return thread_pool::get_max_threads(ThreadPool());
                     }
                 };
             } // namespace _impl_tmp
 
             /**
-             * @brief Simple allocator for temporaries.
+             * @brief Pooled allocator for temporaries.
+             */
+            template <class ThreadPool>
+            using tmp_allocator = sid::pooled_allocator<_impl_tmp::make_allocation_f<ThreadPool>>;
+
+            /**
+             * @brief Allocator for the temporaries of the compiled stencils, which keep them for their lifetime.
              */
-            using tmp_allocator = sid::cached_allocator<_impl_tmp::make_allocation_f>;
+            template <class ThreadPool>
+            using persistent_tmp_allocator = sid::allocator<_impl_tmp::make_allocation_f<ThreadPool>>;
 
             template <class T, class Extent, bool AllParallel, class ThreadPool, class Allocator>
             auto make_tmp_storage(Allocator &allocator, pos3<std::size_t> const &block_size) {
@@ -135,7 +157,7 @@ namespace gridtools {
                                                     _impl_tmp::storage_size<T, Extent, ThreadPool>(block_size)) +
                                                 _impl_tmp::origin_offset<T, Extent, AllParallel>(block_size))
                     .template set<sid::property::strides>(_impl_tmp::strides<T, Extent, AllParallel>(block_size))
-                    .template set<sid::property::strides_kind, _impl_tmp::strides_kind<T, Extent>>()
+                    .template set<sid::property::strides_kind, _impl_tmp::strides_kind<T, Extent, AllParallel>>()
                     .template set<sid::property::ptr_diff, int_t>();
             }
         } // namespace cpu_ifirst_backend
@@ -9,12 +9,16 @@
  */
 #pragma once
 
+#include <algorithm>
 #include <memory>
+#include <type_traits>
 #include <utility>
 
 #include "../common/defs.hpp"
+#include "../common/functional.hpp"
 #include "../common/generic_metafunctions/for_each.hpp"
 #include "../common/host_device.hpp"
+#include "../common/hymap.hpp"
 #include "../common/integral_constant.hpp"
 #include "../common/tuple.hpp"
 #include "../common/tuple_util.hpp"
@@ -28,89 +32,428 @@
 #include "../sid/loop.hpp"
 #include "../sid/sid_shift_origin.hpp"
 #include "../thread_pool/concept.hpp"
+#include "../thread_pool/first_touch.hpp"
 #include "../thread_pool/omp.hpp"
 #include "be_api.hpp"
+#include "common/cached_view.hpp"
+#include "common/caches.hpp"
 #include "common/dim.hpp"
+#include "common/extent.hpp"
+#include "common/fill_flush.hpp"
+#include "common/rebind.hpp"
+#include "common/thread_count_guard.hpp"
 
 namespace gridtools {
     namespace stencil {
         namespace cpu_kfirst_backend {
-            template <class ThreadPool, class Stage, class Grid, class DataStores>
-            auto make_stage_loop(ThreadPool, Stage, Grid const &grid, DataStores &data_stores) {
-                using extent_t = typename Stage::extent_t;
+            /*
+             *  `KBlockSize` enables tiling in k: if it is positive, the columns of the block are processed in slabs of
+             *  `KBlockSize` levels, so the temporaries only hold one slab. Tiling in k is applied only to the specs
+             *  where all multi stages are parallel and none of the written fields is accessed with k-offsets.
+             *
+             *  Tiling in k is experimental: k is the contiguous dimension of this backend and cutting it into slabs
+             *  shortens the vectorized inner loops. In the measurements of the fused horizontal diffusion it was slower
+             *  than the untiled backend in most configurations and only slightly faster for very long columns.
+             */
+            template <class IBlockSize = integral_constant<int_t, 8>,
+                class JBlockSize = integral_constant<int_t, 8>,
+                class ThreadPool = thread_pool::omp,
+                class KBlockSize = integral_constant<int_t, 0>>
+            struct cpu_kfirst {};
+
+            template <class IBlockSize, class JBlockSize, class ThreadPool, class KBlockSize, class KParallel>
+            struct first_touch_blocks_f {
+                template <class F>
+                void operator()(int_t i_size, int_t j_size, int_t k_size, F const &f) const {
+                    int_t k_block_size =
+                        KParallel::value && KBlockSize::value > 0 ? KBlockSize::value : std::max(k_size, 1);
+                    int_t NBI = (i_size + IBlockSize::value - 1) / IBlockSize::value;
+                    int_t NBJ = (j_size + JBlockSize::value - 1) / JBlockSize::value;
+                    int_t NBK = (k_size + k_block_size - 1) / k_block_size;
+                    thread_pool::parallel_for_loop(ThreadPool(),
+                        [&](auto bk, auto bj, auto bi) {
+                            int_t i = bi * IBlockSize::value;
+                            int_t j = bj * JBlockSize::value;
+                            int_t k = bk * k_block_size;
+                            f(i,
+                                std::min(i + IBlockSize::value, i_size),
+                                j,
+                                std::min(j + JBlockSize::value, j_size),
+                                k,
+                                std::min(k + k_block_size, k_size));
+                        },
+                        NBK,
+                        NBJ,
+                        NBI);
+                }
+            };
+
+            /*
+             *  The blocks in the order in which they are distributed over the threads by the entry point below.
+             *  To be passed to `storage::builder<...>.first_touch(...)`. With `KParallel` set the blocks are also
+             *  split into the slabs of `KBlockSize` levels, as the stencils that are tiled in k are.
+             */
+            template <class IBlockSize,
+                class JBlockSize,
+                class ThreadPool,
+                class KBlockSize,
+                class KParallel = std::false_type>
+            first_touch_blocks_f<IBlockSize, JBlockSize, ThreadPool, KBlockSize, KParallel> first_touch_blocks(
+                cpu_kfirst<IBlockSize, JBlockSize, ThreadPool, KBlockSize>, KParallel = {}) {
+                return {};
+            }
+
+            /*
+             *  The thread pool of the backend and the backend rebound to another pool (see `time_blocked_run`).
+             */
+            template <class IBlockSize, class JBlockSize, class ThreadPool, class KBlockSize>
+            ThreadPool backend_thread_pool(cpu_kfirst<IBlockSize, JBlockSize, ThreadPool, KBlockSize>) {
+                return {};
+            }
+
+            template <class IBlockSize, class JBlockSize, class ThreadPool, class KBlockSize, class Other>
+            cpu_kfirst<IBlockSize, JBlockSize, Other, KBlockSize> backend_with_thread_pool(
+                cpu_kfirst<IBlockSize, JBlockSize, ThreadPool, KBlockSize>, Other) {
+                return {};
+            }
 
+            template <class ThreadPool, class PlhInfo, class Allocator>
+            auto make_k_cache(PlhInfo, Allocator &alloc) {
+                using extent_t = typename PlhInfo::extent_t;
+                auto sizes = tuple_util::make<hymap::keys<dim::k, dim::thread>::values>(
+                    integral_constant<int_t, extent_t::kplus::value - extent_t::kminus::value + 1>(),
+                    thread_pool::get_max_threads(ThreadPool()));
+                using stride_kind = meta::list<cache_type::k, extent_t>;
+                return sid::shift_sid_origin(
+                    sid::make_contiguous<std::remove_const_t<typename PlhInfo::data_t>, int_t, stride_kind>(
+                        alloc, sizes),
+                    tuple_util::make<hymap::keys<dim::k>::values>(-extent_t::kminus::value));
+            }
+
+            template <class IBlockSize, class JBlockSize, class ThreadPool, class PlhInfo, class Allocator>
+            auto make_ij_cache(PlhInfo info, Allocator &alloc) {
+                auto extent = to_horizontal_extent<typename PlhInfo::extent_t>();
+                auto num_colors = info.num_colors();
+                auto sizes = tuple_util::make<hymap::keys<dim::c, dim::j, dim::i, dim::thread>::values>(num_colors,
+                    extent.extend(dim::j(), JBlockSize()),
+                    extent.extend(dim::i(), IBlockSize()),
+                    thread_pool::get_max_threads(ThreadPool()));
+                auto offsets = tuple_util::make<hymap::keys<dim::i, dim::j>::values>(
+                    -extent.minus(dim::i()), -extent.minus(dim::j()));
+                using stride_kind = meta::list<cache_type::ij, decltype(extent), decltype(num_colors)>;
+                return sid::shift_sid_origin(
+                    sid::make_contiguous<decltype(info.data()), int_t, stride_kind>(alloc, sizes), offsets);
+            }
+
+            /*
+             *  The ij- and k-caches of the stage, aligned with its `plh_map_t` (`meta::list<>` for not cached
+             *  placeholders). They don't depend on the external fields, so a compiled stencil allocates them once.
+             */
+            template <class IBlockSize,
+                class JBlockSize,
+                class ThreadPool,
+                class KBlockSize,
+                class Stage,
+                class Allocator>
+            auto make_caches(cpu_kfirst<IBlockSize, JBlockSize, ThreadPool, KBlockSize>, Stage, Allocator &alloc) {
+                using plh_map_t = typename Stage::plh_map_t;
+                return tuple_util::transform(
+                    overload(
+                        [&](meta::list<cache_type::ij>, auto info) {
+                            return make_ij_cache<IBlockSize, JBlockSize, ThreadPool>(info, alloc);
+                        },
+                        [&](meta::list<cache_type::k>, auto info) { return make_k_cache<ThreadPool>(info, alloc); },
+                        [&](meta::list<>, auto) { return meta::list<>(); }),
+                    meta::transform<cached_view::served_caches_f<Stage>::template apply, plh_map_t>(),
+                    plh_map_t());
+            }
+
+            template <class Stage, class DataStores, class Caches>
+            auto make_composite(Stage, DataStores &data_stores, Caches const &caches) {
                 using plh_map_t = typename Stage::plh_map_t;
                 using keys_t = meta::rename<sid::composite::keys, meta::transform<meta::first, plh_map_t>>;
-                auto composite = tuple_util::convert_to<keys_t::template values>(tuple_util::transform(
-                    [&](auto info) {
-                        return sid::add_const(info.is_const(), at_key<decltype(info.plh())>(data_stores));
-                    },
-                    Stage::plh_map()));
+                return tuple_util::convert_to<keys_t::template values>(tuple_util::transform(
+                    overload([&](auto cache, auto) { return cache; },
+                        [&](meta::list<>, auto info) {
+                            return sid::add_const(info.is_const(), at_key<decltype(info.plh())>(data_stores));
+                        }),
+                    caches,
+                    plh_map_t()));
+            }
+
+            template <class ThreadPool, class PtrDiff, class Strides>
+            PtrDiff make_block_offset(Strides const &strides, int_t i_block, int_t j_block, int_t k_block) {
+                PtrDiff offset{};
+                sid::shift(offset, sid::get_stride<dim::thread>(strides), thread_pool::get_thread_num(ThreadPool()));
+                sid::shift(offset, sid::get_stride<sid::blocked_dim<dim::i>>(strides), i_block);
+                sid::shift(offset, sid::get_stride<sid::blocked_dim<dim::j>>(strides), j_block);
+                sid::shift(offset, sid::get_stride<sid::blocked_dim<dim::k>>(strides), k_block);
+                return offset;
+            }
+
+            /*
+             *  Executes `fun` for the levels of the item that belong to the k-block `[k_from, k_from + k_block_size)`.
+             *  The item starts at the absolute level `start` and the pointer points to the first level of the k-block.
+             */
+            template <class Item, class Ptr, class Strides, class Fun>
+            GT_FORCE_INLINE void k_block_loop(Item item,
+                int_t start,
+                int_t size,
+                int_t k_from,
+                int_t k_block_size,
+                Ptr ptr,
+                Strides const &strides,
+                Fun const &fun) {
+                int_t lo = std::max(start, k_from);
+                int_t hi = std::min(start + size, k_from + k_block_size);
+                int_t first = be_api::is_backward<typename Item::execution_t>::value ? hi - 1 : lo;
+                sid::shift(ptr, sid::get_stride<dim::k>(strides), first - k_from);
+                for (int_t k = lo; k < hi; ++k) {
+                    fun(ptr, strides);
+                    item.inc_k(ptr, strides);
+                }
+            }
+
+            /*
+             *  Moves the k-cache window by one level in the direction of `Step`.
+             *  The window pointer is shifted in the opposite direction to compensate the subsequent `inc_k`.
+             */
+            template <class PlhInfo, class Step, class Ptr, class Strides>
+            void slide_k_cache(Ptr &ptr, Strides const &strides) {
+                using extent_t = typename PlhInfo::extent_t;
+                auto &&stride = sid::get_stride_element<typename PlhInfo::key_t, dim::k>(strides);
+                auto &cur = host::at_key<typename PlhInfo::key_t>(ptr);
+                auto dst = cur;
+                sid::shift(dst, stride, Step::value > 0 ? extent_t::kminus::value : extent_t::kplus::value);
+                for (int_t k = extent_t::kminus::value; k < extent_t::kplus::value; ++k) {
+                    auto src = dst;
+                    sid::shift(src, stride, Step());
+                    *dst = *src;
+                    dst = src;
+                }
+                sid::shift(cur, stride, integral_constant<int_t, -Step::value>());
+            }
+
+            template <class IBlockSize,
+                class JBlockSize,
+                class ThreadPool,
+                class KBlockSize,
+                class Stage,
+                class Grid,
+                class DataStores,
+                class Caches>
+            auto make_stage_loop(cpu_kfirst<IBlockSize, JBlockSize, ThreadPool, KBlockSize>,
+                meta::list<>,
+                Stage,
+                Grid const &grid,
+                DataStores &data_stores,
+                Caches const &caches,
+                int_t k_block_size) {
+                using extent_t = typename Stage::extent_t;
+
+                auto composite = make_composite(Stage(), data_stores, caches);
+                using ptr_diff_t = sid::ptr_diff_type<decltype(composite)>;
+
+                auto strides = sid::get_strides(composite);
+                ptr_diff_t offset{};
+                sid::shift(offset, sid::get_stride<dim::i>(strides), extent_t::minus(dim::i()));
+                sid::shift(offset, sid::get_stride<dim::j>(strides), extent_t::minus(dim::j()));
+
+                auto k_starts =
+                    tuple_util::transform([&](auto cell) { return grid.k_start(cell.interval()); }, Stage::cells());
+                auto k_sizes = be_api::make_k_sizes(Stage::cells(), grid);
+                return [origin = sid::get_origin(composite) + offset,
+                           strides = std::move(strides),
+                           k_starts = std::move(k_starts),
+                           k_sizes = std::move(k_sizes),
+                           k_block_size](int_t i_block, int_t j_block, int_t k_block, int_t i_size, int_t j_size) {
+                    auto ptr = origin() + make_block_offset<ThreadPool, ptr_diff_t>(strides, i_block, j_block, k_block);
+                    auto k_loop = [&](auto const &ptr, auto const &strides) {
+                        tuple_util::for_each(
+                            [&](auto cell, auto start, auto size) {
+                                k_block_loop(
+                                    cell, start, size, k_block * k_block_size, k_block_size, ptr, strides, cell);
+                            },
+                            Stage::cells(),
+                            k_starts,
+                            k_sizes);
+                    };
+                    auto i_loop = sid::make_loop<dim::i>(extent_t::extend(dim::i(), i_size));
+                    auto j_loop = sid::make_loop<dim::j>(extent_t::extend(dim::j(), j_size));
+                    i_loop(j_loop(k_loop))(ptr, strides);
+                };
+            }
+
+            /*
+             *  Column stage: all the stages of the multi stage are executed for the given column level by level.
+             *  K-cached placeholders are kept in per thread windows that slide along with the current level.
+             */
+            template <class IBlockSize,
+                class JBlockSize,
+                class ThreadPool,
+                class KBlockSize,
+                class Stage,
+                class Grid,
+                class DataStores,
+                class Caches>
+            auto make_stage_loop(cpu_kfirst<IBlockSize, JBlockSize, ThreadPool, KBlockSize>,
+                meta::list<cache_type::k>,
+                Stage,
+                Grid const &grid,
+                DataStores &data_stores,
+                Caches const &caches,
+                int_t k_block_size) {
+                using extent_t = typename Stage::extent_t;
+                using k_caches_t =
+                    meta::filter<cached_view::is_cached_f<cache_type::k>::apply, typename Stage::plh_map_t>;
+
+                auto composite = make_composite(Stage(), data_stores, caches);
                 using ptr_diff_t = sid::ptr_diff_type<decltype(composite)>;
 
                 auto strides = sid::get_strides(composite);
                 ptr_diff_t offset{};
                 sid::shift(offset, sid::get_stride<dim::i>(strides), extent_t::minus(dim::i()));
                 sid::shift(offset, sid::get_stride<dim::j>(strides), extent_t::minus(dim::j()));
-                sid::shift(
-                    offset, sid::get_stride<dim::k>(strides), grid.k_start(Stage::interval(), Stage::execution()));
+                auto k_start = grid.k_start(Stage::interval(), Stage::execution());
+                sid::shift(offset, sid::get_stride<dim::k>(strides), k_start);
+                // the windows are not shifted to the start level
+                for_each<k_caches_t>([&](auto info) {
+                    using key_t = typename decltype(info)::key_t;
+                    sid::shift(
+                        host::at_key<key_t>(offset), sid::get_stride_element<key_t, dim::k>(strides), -k_start);
+                });
 
-                auto shift_back = -grid.k_size(Stage::interval()) * Stage::k_step();
-                auto k_sizes =
-                    tuple_util::transform([&](auto cell) { return grid.k_size(cell.interval()); }, Stage::cells());
-                auto k_loop = [k_sizes = std::move(k_sizes), shift_back](auto &ptr, auto const &strides) {
+                auto k_loop = [k_sizes = be_api::make_k_sizes(Stage::interval_infos(), grid)](
+                                  auto const &column, auto const &strides) {
+                    auto ptr = column;
                     tuple_util::for_each(
-                        [&ptr, &strides](auto cell, auto size) {
+                        [&ptr, &strides](auto info, auto size) {
                             for (int_t k = 0; k < size; ++k) {
-                                cell(ptr, strides);
-                                cell.inc_k(ptr, strides);
+                                tuple_util::for_each([&](auto cell) { cell(ptr, strides); }, info.cells());
+                                for_each<k_caches_t>([&](auto cache) {
+                                    slide_k_cache<decltype(cache), decltype(info.k_step())>(ptr, strides);
+                                });
+                                info.inc_k(ptr, strides);
                             }
                         },
-                        Stage::cells(),
+                        Stage::interval_infos(),
                         k_sizes);
-                    sid::shift(ptr, sid::get_stride<dim::k>(strides), shift_back);
                 };
                 return [origin = sid::get_origin(composite) + offset,
                            strides = std::move(strides),
-                           k_loop = std::move(k_loop)](int_t i_block, int_t j_block, int_t i_size, int_t j_size) {
-                    ptr_diff_t offset{};
-                    sid::shift(
-                        offset, sid::get_stride<dim::thread>(strides), thread_pool::get_thread_num(ThreadPool()));
-                    sid::shift(offset, sid::get_stride<sid::blocked_dim<dim::i>>(strides), i_block);
-                    sid::shift(offset, sid::get_stride<sid::blocked_dim<dim::j>>(strides), j_block);
-                    auto ptr = origin() + offset;
+                           k_loop = std::move(k_loop)](
+                           int_t i_block, int_t j_block, int_t k_block, int_t i_size, int_t j_size) {
+                    auto ptr = origin() + make_block_offset<ThreadPool, ptr_diff_t>(strides, i_block, j_block, k_block);
                     auto i_loop = sid::make_loop<dim::i>(extent_t::extend(dim::i(), i_size));
                     auto j_loop = sid::make_loop<dim::j>(extent_t::extend(dim::j(), j_size));
                     i_loop(j_loop(k_loop))(ptr, strides);
                 };
             }
 
-            template <class IBlockSize = integral_constant<int_t, 8>,
-                class JBlockSize = integral_constant<int_t, 8>,
-                class ThreadPool = thread_pool::omp>
-            struct cpu_kfirst {};
+            /*
+             *  Level stage: all the stages of the multi stage are executed for the given block level by level.
+             *  IJ-cached placeholders are kept in per thread tiles that are reused for every level.
+             */
+            template <class IBlockSize,
+                class JBlockSize,
+                class ThreadPool,
+                class KBlockSize,
+                class Stage,
+                class Grid,
+                class DataStores,
+                class Caches>
+            auto make_stage_loop(cpu_kfirst<IBlockSize, JBlockSize, ThreadPool, KBlockSize>,
+                meta::list<cache_type::ij>,
+                Stage,
+                Grid const &grid,
+                DataStores &data_stores,
+                Caches const &caches,
+                int_t k_block_size) {
+                auto composite = make_composite(Stage(), data_stores, caches);
+                using ptr_diff_t = sid::ptr_diff_type<decltype(composite)>;
 
-            template <class IBlockSize, class JBlockSize, class ThreadPool, class Spec, class Grid, class DataStores>
-            void gridtools_backend_entry_point(cpu_kfirst<IBlockSize, JBlockSize, ThreadPool>,
+                auto strides = sid::get_strides(composite);
+                auto k_starts = tuple_util::transform(
+                    [&](auto info) { return grid.k_start(info.interval()); }, Stage::interval_infos());
+                auto k_sizes = be_api::make_k_sizes(Stage::interval_infos(), grid);
+
+                return [origin = sid::get_origin(composite),
+                           strides = std::move(strides),
+                           k_starts = std::move(k_starts),
+                           k_sizes = std::move(k_sizes),
+                           k_block_size](int_t i_block, int_t j_block, int_t k_block, int_t i_size, int_t j_size) {
+                    auto ptr = origin() + make_block_offset<ThreadPool, ptr_diff_t>(strides, i_block, j_block, k_block);
+                    tuple_util::for_each(
+                        [&](auto info, auto start, auto size) {
+                            auto level = [&](auto const &ptr, auto const &strides) {
+                                tuple_util::for_each(
+                                    [&](auto cell) {
+                                        using extent_t = typename decltype(cell)::extent_t;
+                                        ptr_diff_t offset{};
+                                        sid::shift(offset, sid::get_stride<dim::i>(strides), extent_t::minus(dim::i()));
+                                        sid::shift(offset, sid::get_stride<dim::j>(strides), extent_t::minus(dim::j()));
+                                        auto cell_ptr = ptr + offset;
+                                        auto i_loop = sid::make_loop<dim::i>(extent_t::extend(dim::i(), i_size));
+                                        auto j_loop = sid::make_loop<dim::j>(extent_t::extend(dim::j(), j_size));
+                                        i_loop(j_loop(cell))(cell_ptr, strides);
+                                    },
+                                    info.cells());
+                            };
+                            k_block_loop(info, start, size, k_block * k_block_size, k_block_size, ptr, strides, level);
+                        },
+                        Stage::interval_infos(),
+                        k_starts,
+                        k_sizes);
+                };
+            }
+
+            template <class PlhInfo>
+            using has_no_k_dependency = bool_constant<PlhInfo::is_const_t::value ||
+                                                      (PlhInfo::extent_t::kminus::value == 0 &&
+                                                          PlhInfo::extent_t::kplus::value == 0)>;
+
+            /*
+             *  The slabs of the column can be computed independently if the computation is parallel and no level
+             *  reads a field written by the other levels.
+             */
+            template <class KBlockSize, class Spec, class Stages>
+            using is_k_tiled = bool_constant<(KBlockSize::value > 0) &&
+                                             meta::all_of<cached_view::is_parallel_matrix, Spec>::value &&
+                                             meta::all_of<has_no_k_dependency, typename Stages::plh_map_t>::value>;
+
+            /*
+             *  Allocates the temporaries and the caches and returns the function that builds the loops of the stencil
+             *  over the given external fields. The loops are returned as a function without arguments (see
+             *  `common/rebind.hpp`). The allocator is owned by the returned function.
+             */
+            template <class IBlockSize,
+                class JBlockSize,
+                class ThreadPool,
+                class KBlockSize,
+                class Spec,
+                class Grid,
+                class Allocator>
+            auto make_loops(cpu_kfirst<IBlockSize, JBlockSize, ThreadPool, KBlockSize> backend,
                 Spec,
                 Grid const &grid,
-                DataStores external_data_stores) {
-                using stages_t = be_api::make_split_view<Spec>;
+                Allocator alloc) {
+                using stages_t = cached_view::make_view<Spec>;
+                using is_k_tiled_t = is_k_tiled<KBlockSize, Spec, stages_t>;
 
-                auto alloc = sid::make_cached_allocator(&std::make_unique<char[]>);
-
-                using tmp_plh_map_t = be_api::remove_caches_from_plh_map<typename stages_t::tmp_plh_map_t>;
+                // in the tiled case the temporaries are indexed relative to the first level of the slab
+                using tmp_plh_map_t = cached_view::tmp_plh_map<stages_t>;
                 auto temporaries = be_api::make_data_stores(tmp_plh_map_t(), [&grid, &alloc](auto info) {
                     auto extent = info.extent();
                     auto interval = stages_t::interval();
                     auto num_colors = info.num_colors();
-                    auto offsets =
-                        tuple_util::make<hymap::keys<dim::i, dim::j, dim::k>::values>(-extent.minus(dim::i()),
-                            -extent.minus(dim::j()),
-                            -grid.k_start(interval) - extent.minus(dim::k()));
+                    auto offsets = tuple_util::make<hymap::keys<dim::i, dim::j, dim::k>::values>(
+                        -extent.minus(dim::i()),
+                        -extent.minus(dim::j()),
+                        (is_k_tiled_t::value ? 0 : -grid.k_start(interval)) - extent.minus(dim::k()));
                     auto sizes =
                         tuple_util::make<hymap::keys<dim::c, dim::k, dim::j, dim::i, dim::thread>::values>(num_colors,
-                            grid.k_size(interval, extent),
+                            is_k_tiled_t::value ? extent.extend(dim::k(), KBlockSize::value)
+                                                : int_t(grid.k_size(interval, extent)),
                             extent.extend(dim::j(), JBlockSize()),
                             extent.extend(dim::i(), IBlockSize()),
                             thread_pool::get_max_threads(ThreadPool()));
@@ -120,33 +463,111 @@ namespace gridtools {
                         sid::make_contiguous<decltype(info.data()), int_t, stride_kind>(alloc, sizes), offsets);
                 });
 
-                auto blocked_external_data_stores = tuple_util::transform(
-                    [&](auto &&data_store) {
-                        return sid::block(std::forward<decltype(data_store)>(data_store),
-                            hymap::keys<dim::i, dim::j>::values<IBlockSize, JBlockSize>());
-                    },
-                    std::move(external_data_stores));
-
-                auto data_stores = hymap::concat(std::move(blocked_external_data_stores), std::move(temporaries));
-
-                auto stage_loops = tuple_util::transform(
-                    [&](auto stage) { return make_stage_loop(ThreadPool(), stage, grid, data_stores); },
-                    meta::rename<tuple, stages_t>());
-
-                int_t total_i = grid.i_size();
-                int_t total_j = grid.j_size();
-
-                int_t NBI = (total_i + IBlockSize::value - 1) / IBlockSize::value;
-                int_t NBJ = (total_j + JBlockSize::value - 1) / JBlockSize::value;
-
-                thread_pool::parallel_for_loop(ThreadPool(),
-                    [&](auto bj, auto bi) {
-                        int_t i_size = bi + 1 == NBI ? total_i - bi * IBlockSize::value : IBlockSize::value;
-                        int_t j_size = bj + 1 == NBJ ? total_j - bj * JBlockSize::value : JBlockSize::value;
-                        tuple_util::for_each([=](auto &&fun) { fun(bi, bj, i_size, j_size); }, stage_loops);
-                    },
-                    NBJ,
-                    NBI);
+                auto caches = tuple_util::transform(
+                    [&](auto stage) { return make_caches(backend, stage, alloc); }, meta::rename<tuple, stages_t>());
+
+                return [alloc = std::move(alloc),
+                           temporaries = std::move(temporaries),
+                           caches = std::move(caches),
+                           grid](auto external_data_stores) {
+                    using block_map_t = meta::if_<is_k_tiled_t,
+                        hymap::keys<dim::i, dim::j, dim::k>::values<IBlockSize, JBlockSize, KBlockSize>,
+                        hymap::keys<dim::i, dim::j>::values<IBlockSize, JBlockSize>>;
+                    auto blocked_external_data_stores = tuple_util::transform(
+                        [&](auto &&data_store) {
+                            return sid::block(std::forward<decltype(data_store)>(data_store), block_map_t());
+                        },
+                        std::move(external_data_stores));
+
+                    auto data_stores = hymap::concat(std::move(blocked_external_data_stores), temporaries);
+
+                    int_t total_i = grid.i_size();
+                    int_t total_j = grid.j_size();
+                    int_t total_k = grid.k_size();
+
+                    int_t k_block_size = is_k_tiled_t::value ? KBlockSize::value : std::max(total_k, 1);
+
+                    auto stage_loops = tuple_util::transform(
+                        [&](auto stage, auto const &stage_caches) {
+                            return make_stage_loop(cpu_kfirst<IBlockSize, JBlockSize, ThreadPool, KBlockSize>(),
+                                cached_view::stage_caches<decltype(stage)>(),
+                                stage,
+                                grid,
+                                data_stores,
+                                stage_caches,
+                                k_block_size);
+                        },
+                        meta::rename<tuple, stages_t>(),
+                        caches);
+
+                    int_t NBI = (total_i + IBlockSize::value - 1) / IBlockSize::value;
+                    int_t NBJ = (total_j + JBlockSize::value - 1) / JBlockSize::value;
+                    int_t NBK = (total_k + k_block_size - 1) / k_block_size;
+
+                    return [stage_loops = std::move(stage_loops), total_i, total_j, NBI, NBJ, NBK] {
+                        thread_pool::parallel_for_loop(ThreadPool(),
+                            [&](auto bk, auto bj, auto bi) {
+                                int_t i_size = bi + 1 == NBI ? total_i - bi * IBlockSize::value : IBlockSize::value;
+                                int_t j_size = bj + 1 == NBJ ? total_j - bj * JBlockSize::value : JBlockSize::value;
+                                tuple_util::for_each(
+                                    [=](auto &&fun) { fun(bi, bj, bk, i_size, j_size); }, stage_loops);
+                            },
+                            NBK,
+                            NBJ,
+                            NBI);
+                    };
+                };
+            }
+
+            template <class Spec, class DataStores>
+            auto transform_data_stores(Spec, DataStores data_stores) {
+                return fill_flush::transform_data_stores<typename cached_view::make_view<Spec>::plh_map_t>(
+                    std::move(data_stores));
+            }
+
+            template <class IBlockSize,
+                class JBlockSize,
+                class ThreadPool,
+                class KBlockSize,
+                class Spec,
+                class Grid,
+                class DataStores>
+            void gridtools_backend_entry_point(cpu_kfirst<IBlockSize, JBlockSize, ThreadPool, KBlockSize> backend,
+                Spec,
+                Grid const &grid,
+                DataStores external_data_stores) {
+                make_loops(backend,
+                    Spec(),
+                    grid,
+                    sid::make_pooled_allocator(thread_pool::first_touch_allocation_f<ThreadPool>()))(
+                    transform_data_stores(Spec(), std::move(external_data_stores)))();
+            }
+
+            /*
+             *  The executable of `stencil::compile`: the temporaries and the caches are allocated once and the loops
+             *  are built once and reused by every call.
+             */
+            template <class IBlockSize,
+                class JBlockSize,
+                class ThreadPool,
+                class KBlockSize,
+                class Spec,
+                class Grid,
+                class DataStores>
+            auto gridtools_backend_compile(cpu_kfirst<IBlockSize, JBlockSize, ThreadPool, KBlockSize> backend,
+                Spec,
+                Grid const &grid,
+                meta::list<DataStores>) {
+                using data_stores_t = decltype(transform_data_stores(Spec(), std::declval<DataStores>()));
+                return make_thread_count_guard<ThreadPool>([backend, grid] {
+                    return [executable = make_rebinding_executable<data_stores_t>(make_loops(backend,
+                                Spec(),
+                                grid,
+                                sid::make_allocator(thread_pool::first_touch_allocation_f<ThreadPool>())))](
+                               DataStores external_data_stores) mutable {
+                        executable(transform_data_stores(Spec(), std::move(external_data_stores)));
+                    };
+                });
             }
         } // namespace cpu_kfirst_backend
         using cpu_kfirst_backend::cpu_kfirst;
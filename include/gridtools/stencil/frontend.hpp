@@ -13,7 +13,10 @@
 #include "common/extent.hpp"
 #include "common/intent.hpp"
 #include "frontend/axis.hpp"
+#include "frontend/compile.hpp"
 #include "frontend/expandable_run.hpp"
 #include "frontend/make_grid.hpp"
 #include "frontend/make_param_list.hpp"
 #include "frontend/run.hpp"
+#include "frontend/run_async.hpp"
+#include "frontend/time_blocked_run.hpp"
@@ -68,8 +68,20 @@ namespace gridtools {
                     }
                 };
 
+                // functors opt out of the vectorized evaluation (e.g. if they branch on values) by declaring
+                // `using vectorizable_t = std::false_type;`
+                template <class Functor, class = void>
+                struct is_vectorizable_functor : std::true_type {};
+
+                template <class Functor>
+                struct is_vectorizable_functor<Functor, void_t<typename Functor::vectorizable_t>>
+                    : Functor::vectorizable_t {};
+
                 template <class Functor, class PlhMap>
                 struct stage {
+                    // all the accesses go through `Deref`, backends may pass it a vectorizing one
+                    using vectorizable_t = typename is_vectorizable_functor<Functor>::type;
+
                     template <class Deref = void, class Ptr, class Strides>
                     GT_FUNCTION void operator()(Ptr const &ptr, Strides const &strides) const {
                         using deref_t = meta::if_<std::is_void<Deref>, default_deref_f, Deref>;
@@ -0,0 +1,104 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <memory>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+
+#include "../../common/defs.hpp"
+#include "../../common/hymap.hpp"
+#include "../../meta.hpp"
+#include "../../sid/concept.hpp"
+#include "../core/backend.hpp"
+#include "../core/interval.hpp"
+#include "run.hpp"
+
+/**
+ *  @file
+ *  `auto stencil = compile(comp, backend, grid);` followed by `stencil(fields...);` is equivalent to
+ *  `run(comp, backend, grid, fields...);` but the setup that doesn't depend on the fields is done only once.
+ *
+ *  The setup is done on the first call for the given types of the fields (the types of the temporaries depend on
+ *  the element types of the fields) and is repeated only if the types change. The backends that support it
+ *  (`cpu_kfirst` and `cpu_ifirst`) allocate the temporaries and the software caches and compute the block
+ *  decomposition during the setup; the calls only bind the fields. For the other backends every call is a `run`.
+ *
+ *  The compiled stencil owns the temporaries, so it is movable but not copyable and it should not be called
+ *  concurrently.
+ */
+
+namespace gridtools {
+    namespace stencil {
+        namespace compile_frontend_impl_ {
+            using frontend_impl_::arg;
+
+            template <class T>
+            void delete_executable(void *ptr) {
+                delete static_cast<T *>(ptr);
+            }
+
+            template <class Comp, class Backend, class Grid>
+            class compiled {
+                static_assert(
+                    meta::is_instantiation_of<core::interval, typename Grid::interval_t>::value, "Invalid grid.");
+
+                Comp m_comp;
+                Grid m_grid;
+                std::type_info const *m_type = nullptr;
+                std::unique_ptr<void, void (*)(void *)> m_executable = {nullptr, nullptr};
+
+                template <class Spec>
+                static void check_spec() {
+                    static_assert(meta::is_instantiation_of<frontend_impl_::spec, Spec>::value,
+                        "Invalid stencil composition specification.");
+                    using functors_t = meta::transform<meta::first, meta::flatten<meta::transform<meta::second, Spec>>>;
+                    using check_t = frontend_impl_::check_valid_apply_overloads<typename Grid::interval_t>;
+                    static_assert(meta::all_of<check_t::template apply, functors_t>::value,
+                        "Invalid stencil operator detected.");
+                }
+
+                template <class... Fields, size_t... Is>
+                void call_impl(std::index_sequence<Is...>, Fields &... fields) {
+                    using spec_t = decltype(m_comp(arg<Is>()...));
+                    check_spec<spec_t>();
+                    frontend_impl_::check_bounds<spec_t>(m_grid, std::index_sequence<Is...>(), fields...);
+                    using data_store_map_t = typename hymap::keys<arg<Is>...>::template values<Fields &...>;
+                    using executable_t = core::backend_executable<Backend, spec_t, Grid, data_store_map_t>;
+                    if (!m_type || *m_type != typeid(executable_t)) {
+                        m_executable = {new executable_t(m_grid), &delete_executable<executable_t>};
+                        m_type = &typeid(executable_t);
+                    }
+                    (*static_cast<executable_t *>(m_executable.get()))(data_store_map_t{fields...});
+                }
+
+              public:
+                compiled(Comp comp, Grid const &grid) : m_comp(std::move(comp)), m_grid(grid) {}
+
+                Grid const &grid() const { return m_grid; }
+
+                template <class... Fields>
+                void operator()(Fields &&... fields) {
+                    static_assert(
+                        conjunction<is_sid<Fields>...>::value, "All computation fields must satisfy SID concept.");
+                    call_impl(std::index_sequence_for<Fields...>(), fields...);
+                }
+            };
+
+            template <class Comp, class Backend, class Grid>
+            compiled<Comp, Backend, Grid> compile(Comp comp, Backend, Grid const &grid) {
+                return {std::move(comp), grid};
+            }
+        } // namespace compile_frontend_impl_
+        using compile_frontend_impl_::compile;
+    } // namespace stencil
+} // namespace gridtools
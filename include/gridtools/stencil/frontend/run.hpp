@@ -198,24 +198,15 @@ namespace gridtools {
                 using apply = core::check_valid_apply_overloads<Functor, Interval>;
             };
 
-            template <class Comp, class Backend, class Grid, class... Fields, size_t... Is>
-            auto run_impl(Comp comp, Backend, Grid const &grid, std::index_sequence<Is...>, Fields &&... fields)
-                -> void_t<decltype(comp(arg<Is>()...))> {
-                using spec_t = decltype(comp(arg<Is>()...));
-                static_assert(
-                    meta::is_instantiation_of<spec, spec_t>::value, "Invalid stencil composition specification.");
-                static_assert(
-                    meta::is_instantiation_of<core::interval, typename Grid::interval_t>::value, "Invalid grid.");
-                using functors_t = meta::transform<meta::first, meta::flatten<meta::transform<meta::second, spec_t>>>;
-                static_assert(meta::all_of<check_valid_apply_overloads<typename Grid::interval_t>::template apply,
-                                  functors_t>::value,
-                    "Invalid stencil operator detected.");
-
-                using entry_point_t = core::backend_entry_point_f<Backend, spec_t>;
-                using data_store_map_t = typename hymap::keys<arg<Is>...>::template values<Fields &...>;
+            /*
+             *  In debug builds, asserts that the fields cover the computation domain extended by the extents with which
+             *  they are accessed.
+             */
+            template <class Spec, class Grid, class... Fields, size_t... Is>
+            void check_bounds(Grid const &grid, std::index_sequence<Is...>, Fields const &... fields) {
 #ifndef NDEBUG
-                using extent_map_t = core::get_extent_map_from_msses<spec_t>;
-                auto check_bounds = [origin = grid.origin(), size = grid.size()](auto arg, auto const &field) {
+                using extent_map_t = core::get_extent_map_from_msses<Spec>;
+                auto check = [origin = grid.origin(), size = grid.size()](auto arg, auto const &field) {
                     using extent_t = core::lookup_extent_map<extent_map_t, decltype(arg)>;
                     // There is no check in k-direction because at the fields may be used within subintervals
                     // TODO(anstaf): find the proper place to check k-bounds
@@ -233,8 +224,26 @@ namespace gridtools {
                         });
                     return 0;
                 };
-                (void)(int[]){check_bounds(arg<Is>(), fields)...};
+                (void)(int[]){check(arg<Is>(), fields)...};
 #endif
+            }
+
+            template <class Comp, class Backend, class Grid, class... Fields, size_t... Is>
+            auto run_impl(Comp comp, Backend, Grid const &grid, std::index_sequence<Is...>, Fields &&... fields)
+                -> void_t<decltype(comp(arg<Is>()...))> {
+                using spec_t = decltype(comp(arg<Is>()...));
+                static_assert(
+                    meta::is_instantiation_of<spec, spec_t>::value, "Invalid stencil composition specification.");
+                static_assert(
+                    meta::is_instantiation_of<core::interval, typename Grid::interval_t>::value, "Invalid grid.");
+                using functors_t = meta::transform<meta::first, meta::flatten<meta::transform<meta::second, spec_t>>>;
+                static_assert(meta::all_of<check_valid_apply_overloads<typename Grid::interval_t>::template apply,
+                                  functors_t>::value,
+                    "Invalid stencil operator detected.");
+
+                using entry_point_t = core::backend_entry_point_f<Backend, spec_t>;
+                using data_store_map_t = typename hymap::keys<arg<Is>...>::template values<Fields &...>;
+                check_bounds<spec_t>(grid, std::index_sequence<Is...>(), fields...);
                 entry_point_t()(grid, data_store_map_t{fields...});
             }
 
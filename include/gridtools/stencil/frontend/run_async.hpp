@@ -0,0 +1,334 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../../common/defs.hpp"
+#include "../../common/tuple.hpp"
+#include "../../common/tuple_util.hpp"
+#include "../../sid/concept.hpp"
+#include "../../thread_pool/concept.hpp"
+#include "../common/intent.hpp"
+#include "run.hpp"
+
+/**
+ *  @file
+ *  `run_async(comp, backend, grid, fields...)` schedules `run(comp, backend, grid, fields...)` for the asynchronous
+ *  execution and returns `std::shared_future<void>` that becomes ready when the stencil has completed.
+ *
+ *  The computations are ordered by their accesses to the fields (the intents are taken from the specification,
+ *  see `get_arg_intent`): a computation that reads a field waits for the previous computations that write it, a
+ *  computation that writes a field waits for all the previous computations that access it. Independent
+ *  computations run concurrently.
+ *
+ *  The fields are identified by their data pointers (the origin of the sid). The fields without a pointer (like
+ *  positionals or global parameters) are not tracked. The fields are captured by copy, so a storage stays alive
+ *  until the computations that use it have completed. The fields should not be accessed directly (host views,
+ *  halo exchanges, boundary conditions) before the future of the last computation that uses them is ready.
+ *
+ *  An exception thrown by a computation is stored in its future and in the futures of all the computations that
+ *  are scheduled after it and depend on it (until `wait_all`); those are not executed.
+ *
+ *  The number of the concurrently executed computations is given by the environment variable
+ *  `GT_ASYNC_CONCURRENCY` (2 by default). `async_scheduler::instance().wait_all()` waits for all the scheduled
+ *  computations.
+ *
+ *  The concurrently executed computations share the threads of the thread pool of their backend (see
+ *  `backend_thread_pool`): each of them runs its parallel loops with the number of threads that the pool has on the
+ *  thread that calls `run_async`, divided by the concurrency (see `thread_pool::set_num_threads`). For the backends
+ *  without a thread pool the computations are executed as they are.
+ */
+
+namespace gridtools {
+    namespace stencil {
+        namespace async_frontend_impl_ {
+            using frontend_impl_::arg;
+
+            /*
+             *  Executes the tasks in the order given by their accesses to the fields.
+             */
+            class async_scheduler {
+                struct task {
+                    std::function<void()> fun;
+                    std::promise<void> promise;
+                    std::size_t pending = 0;
+                    bool done = false;
+                    std::exception_ptr error;
+                    std::vector<std::shared_ptr<task>> dependents;
+                };
+                using task_ptr = std::shared_ptr<task>;
+
+                struct field_state {
+                    task_ptr writer;
+                    std::vector<task_ptr> readers;
+                };
+
+                std::size_t m_concurrency;
+                std::vector<std::thread> m_threads;
+                std::mutex m_mutex;
+                std::condition_variable m_ready_cv;
+                std::condition_variable m_idle_cv;
+                std::deque<task_ptr> m_ready;
+                std::unordered_map<void const *, field_state> m_fields;
+                std::size_t m_scheduled = 0;
+                bool m_stop = false;
+
+                static std::size_t default_concurrency() {
+                    if (char const *env = std::getenv("GT_ASYNC_CONCURRENCY")) {
+                        int res = std::atoi(env);
+                        if (res > 0)
+                            return res;
+                    }
+                    return 2;
+                }
+
+                // called with the lock held
+                void add_dependency(task_ptr const &dependency, task_ptr const &dependent) {
+                    if (!dependency || dependency == dependent)
+                        return;
+                    if (dependency->done) {
+                        if (dependency->error && !dependent->error)
+                            dependent->error = dependency->error;
+                        return;
+                    }
+                    auto &list = dependency->dependents;
+                    if (!list.empty() && list.back() == dependent)
+                        return;
+                    list.push_back(dependent);
+                    ++dependent->pending;
+                }
+
+                // called with the lock held
+                void start_workers() {
+                    while (m_threads.size() < m_concurrency)
+                        m_threads.emplace_back([this] { worker_loop(); });
+                }
+
+                void execute(task &t) {
+                    if (!t.error) {
+                        try {
+                            t.fun();
+                        } catch (...) {
+                            t.error = std::current_exception();
+                        }
+                    }
+                    // release the captured fields
+                    t.fun = nullptr;
+                    std::vector<task_ptr> dependents;
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        t.done = true;
+                        dependents.swap(t.dependents);
+                        for (auto &&dependent : dependents) {
+                            if (t.error && !dependent->error)
+                                dependent->error = t.error;
+                            if (--dependent->pending == 0)
+                                m_ready.push_back(dependent);
+                        }
+                    }
+                    if (t.error)
+                        t.promise.set_exception(t.error);
+                    else
+                        t.promise.set_value();
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if (--m_scheduled == 0)
+                        m_idle_cv.notify_all();
+                    if (!dependents.empty())
+                        m_ready_cv.notify_all();
+                }
+
+                void worker_loop() {
+                    while (true) {
+                        task_ptr t;
+                        {
+                            std::unique_lock<std::mutex> lock(m_mutex);
+                            m_ready_cv.wait(lock, [&] { return m_stop || !m_ready.empty(); });
+                            if (m_ready.empty())
+                                return;
+                            t = std::move(m_ready.front());
+                            m_ready.pop_front();
+                        }
+                        execute(*t);
+                    }
+                }
+
+              public:
+                explicit async_scheduler(std::size_t concurrency = default_concurrency())
+                    : m_concurrency(std::max<std::size_t>(concurrency, 1)) {}
+
+                std::size_t concurrency() const { return m_concurrency; }
+
+                async_scheduler(async_scheduler const &) = delete;
+                async_scheduler &operator=(async_scheduler const &) = delete;
+
+                ~async_scheduler() {
+                    wait_all();
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        m_stop = true;
+                    }
+                    m_ready_cv.notify_all();
+                    for (auto &thread : m_threads)
+                        thread.join();
+                }
+
+                static async_scheduler &instance() {
+                    static async_scheduler res;
+                    return res;
+                }
+
+                /**
+                 *  Schedules `fun` that accesses the given fields. `accesses` is the sequence of the pairs of the field
+                 *  keys and the flags that tell if the field is written. The null keys are ignored.
+                 */
+                std::shared_future<void> submit(
+                    std::function<void()> fun, std::vector<std::pair<void const *, bool>> accesses) {
+                    auto t = std::make_shared<task>();
+                    t->fun = std::move(fun);
+                    std::shared_future<void> res = t->promise.get_future().share();
+
+                    // a field that is passed several times is written if any of the accesses writes it
+                    std::sort(accesses.begin(), accesses.end(), [](auto const &lhs, auto const &rhs) {
+                        return lhs.first < rhs.first || (lhs.first == rhs.first && lhs.second > rhs.second);
+                    });
+                    accesses.erase(std::unique(accesses.begin(),
+                                       accesses.end(),
+                                       [](auto const &lhs, auto const &rhs) { return lhs.first == rhs.first; }),
+                        accesses.end());
+
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    for (auto &&access : accesses) {
+                        if (!access.first)
+                            continue;
+                        auto &state = m_fields[access.first];
+                        add_dependency(state.writer, t);
+                        if (access.second) {
+                            for (auto &&reader : state.readers)
+                                add_dependency(reader, t);
+                            state.writer = t;
+                            state.readers.clear();
+                        } else {
+                            state.readers.erase(std::remove_if(state.readers.begin(),
+                                                    state.readers.end(),
+                                                    [](task_ptr const &reader) { return reader->done; }),
+                                state.readers.end());
+                            state.readers.push_back(t);
+                        }
+                    }
+                    ++m_scheduled;
+                    start_workers();
+                    if (t->pending == 0) {
+                        m_ready.push_back(std::move(t));
+                        m_ready_cv.notify_one();
+                    }
+                    return res;
+                }
+
+                /**
+                 *  Waits until all the scheduled computations have completed.
+                 */
+                void wait_all() {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_idle_cv.wait(lock, [&] { return m_scheduled == 0; });
+                    m_fields.clear();
+                }
+            };
+
+            template <class Field, class Ptr = decltype(sid::get_origin(std::declval<Field const &>())())>
+            std::enable_if_t<std::is_pointer<Ptr>::value, void const *> field_key(Field const &field) {
+                return sid::get_origin(field)();
+            }
+
+            template <class Field, class Ptr = decltype(sid::get_origin(std::declval<Field const &>())())>
+            std::enable_if_t<!std::is_pointer<Ptr>::value, void const *> field_key(Field const &) {
+                return nullptr;
+            }
+
+            template <class Backend, class ThreadPool = decltype(backend_thread_pool(std::declval<Backend>()))>
+            int thread_share(Backend, std::size_t concurrency, int) {
+                return std::max<int>(thread_pool::get_max_threads(ThreadPool()) / concurrency, 1);
+            }
+
+            template <class Backend>
+            int thread_share(Backend, std::size_t, long) {
+                return 0;
+            }
+
+            template <class Backend, class ThreadPool = decltype(backend_thread_pool(std::declval<Backend>()))>
+            void set_thread_share(Backend, int num_threads, int) {
+                thread_pool::set_num_threads(ThreadPool(), num_threads);
+            }
+
+            template <class Backend>
+            void set_thread_share(Backend, int, long) {}
+
+            template <class Spec, size_t I>
+            constexpr bool is_written() {
+                return decltype(get_arg_intent(Spec(), arg<I>()))::value == intent::inout;
+            }
+
+            template <class Comp, class Backend, class Grid, class... Fields, size_t... Is>
+            std::shared_future<void> run_async_impl(async_scheduler &scheduler,
+                Comp comp,
+                Backend be,
+                Grid const &grid,
+                std::index_sequence<Is...>,
+                Fields &&... fields) {
+                using spec_t = decltype(comp(arg<Is>()...));
+                static_assert(meta::is_instantiation_of<frontend_impl_::spec, spec_t>::value,
+                    "Invalid stencil composition specification.");
+                std::vector<std::pair<void const *, bool>> accesses = {
+                    {field_key(fields), is_written<spec_t, Is>()}...};
+                // taken on the calling thread, the number of threads of the workers of the scheduler may differ
+                int threads = thread_share(be, scheduler.concurrency(), 0);
+                return scheduler.submit(
+                    [comp,
+                        be,
+                        grid,
+                        threads,
+                        fields = tuple<std::decay_t<Fields>...>(std::forward<Fields>(fields)...)]() {
+                        set_thread_share(be, threads, 0);
+                        tuple_util::apply([&](auto const &... fields) { run(comp, be, grid, fields...); }, fields);
+                    },
+                    std::move(accesses));
+            }
+
+            template <class Comp, class Backend, class Grid, class... Fields>
+            std::shared_future<void> run_async(Comp comp, Backend be, Grid const &grid, Fields &&... fields) {
+                static_assert(
+                    conjunction<is_sid<Fields>...>::value, "All computation fields must satisfy SID concept.");
+                return run_async_impl(async_scheduler::instance(),
+                    comp,
+                    be,
+                    grid,
+                    std::index_sequence_for<Fields...>(),
+                    std::forward<Fields>(fields)...);
+            }
+        } // namespace async_frontend_impl_
+        using async_frontend_impl_::async_scheduler;
+        using async_frontend_impl_::run_async;
+    } // namespace stencil
+} // namespace gridtools
@@ -0,0 +1,318 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../../common/defs.hpp"
+#include "../../common/hymap.hpp"
+#include "../../common/integral_constant.hpp"
+#include "../../meta.hpp"
+#include "../../sid/concept.hpp"
+#include "../../sid/simple_ptr_holder.hpp"
+#include "../../sid/synthetic.hpp"
+#include "../../thread_pool/concept.hpp"
+#include "../../thread_pool/dummy.hpp"
+#include "../common/dim.hpp"
+#include "../core/compute_extents_metafunctions.hpp"
+#include "../core/esf_metafunctions.hpp"
+#include "../core/is_tmp_arg.hpp"
+#include "run.hpp"
+
+/**
+ *  @file
+ *  `time_blocked_run<TimeBlock>(comp, backend, grid, steps, a, b, fields...)` is equivalent to
+ *
+ *      for (size_t n = 0; n != steps; ++n) {
+ *          run(comp, backend, grid, a, b, fields...);
+ *          std::swap(a, b);
+ *      }
+ *
+ *  but executes up to `TimeBlock` time steps per sweep through memory. The horizontal domain is split into
+ *  `ITile x JTile` tiles which are processed in parallel by the thread pool of the backend. For every tile the time
+ *  steps of the sweep are computed on the regions that shrink by the extent of the `a` argument per step (overlapped
+ *  tiling); the intermediate steps go to thread private buffers, only the last one is written to `b`. The points
+ *  around the tiles are computed redundantly, so the tiles should be large compared to `TimeBlock` times the extent.
+ *
+ *  Requirements to the computation `comp(a, b, fields...)`:
+ *    - `b` is the only written argument, it is written by a single stage and it is not read (no stage binds it to an
+ *      `in` accessor; the `inout` accessor of the stage that writes it should only be assigned to);
+ *    - the points of `a` and `b` outside of the computation domain (the halos) have the same values, they are never
+ *      written.
+ *
+ *  Temporal blocking needs a backend that can be rebound to the serial thread pool (`cpu_kfirst` and `cpu_ifirst`,
+ *  see `backend_thread_pool` / `backend_with_thread_pool`). For the other backends every step is a separate sweep.
+ */
+
+namespace gridtools {
+    namespace stencil {
+        namespace time_blocked_frontend_impl_ {
+            using frontend_impl_::arg;
+
+            template <class Comp, size_t... Is>
+            auto get_spec(Comp comp, std::index_sequence<Is...>) -> decltype(comp(arg<Is>()...));
+
+            template <class Backend, class = void>
+            struct is_rebindable : std::false_type {};
+
+            template <class Backend>
+            struct is_rebindable<Backend,
+                void_t<decltype(backend_thread_pool(std::declval<Backend>())),
+                    decltype(backend_with_thread_pool(std::declval<Backend>(), thread_pool::dummy()))>>
+                : std::true_type {};
+
+            template <class Mss>
+            using get_esfs = typename Mss::esf_sequence_t;
+
+            template <class Esf>
+            using writes_second_arg = meta::st_contains<core::esf_get_w_args_per_functor<Esf>, arg<1>>;
+
+            struct buffer_strides_kind;
+
+            struct range {
+                int_t lo;
+                int_t hi;
+            };
+
+            inline range intersect(range l, range r) { return {std::max(l.lo, r.lo), std::min(l.hi, r.hi)}; }
+
+            template <class Field>
+            auto ptr_at(Field const &field, int_t i, int_t j, int_t k) {
+                auto ptr = sid::get_origin(field)();
+                auto &&strides = sid::get_strides(field);
+                sid::shift(ptr, sid::get_stride<dim::i>(strides), i);
+                sid::shift(ptr, sid::get_stride<dim::j>(strides), j);
+                sid::shift(ptr, sid::get_stride<dim::k>(strides), k);
+                return ptr;
+            }
+
+            template <class Dim, class Field>
+            range bounds(Field const &field) {
+                auto &&lower = at_key_with_default<Dim, integral_constant<int_t, std::numeric_limits<int_t>::min()>>(
+                    sid::get_lower_bounds(field));
+                auto &&upper = at_key_with_default<Dim, integral_constant<int_t, std::numeric_limits<int_t>::max()>>(
+                    sid::get_upper_bounds(field));
+                return {lower, upper};
+            }
+
+            /*
+             *  Thread private buffer that covers the box `i x j x k` and is indexed with the global coordinates.
+             */
+            template <class T>
+            auto make_buffer(T *data, range i, range j, range k) {
+                using namespace literals;
+                int_t j_stride = i.hi - i.lo;
+                int_t k_stride = j_stride * (j.hi - j.lo);
+                return sid::synthetic()
+                    .set<sid::property::origin>(
+                        sid::host_device::make_simple_ptr_holder(data - i.lo - j.lo * j_stride - k.lo * k_stride))
+                    .template set<sid::property::strides>(
+                        hymap::keys<dim::i, dim::j, dim::k>::values<integral_constant<int_t, 1>, int_t, int_t>(
+                            1_c, j_stride, k_stride))
+                    .template set<sid::property::strides_kind, buffer_strides_kind>()
+                    .template set<sid::property::ptr_diff, int_t>();
+            }
+
+            template <class Backend, class Comp, class Grid, class Field, class... Fields>
+            void sweep(Comp comp, Grid const &grid, size_t steps, Field &a, Field &b, Fields &&... fields) {
+                for (size_t n = 0; n != steps; ++n) {
+                    run(comp, Backend(), grid, a, b, fields...);
+                    std::swap(a, b);
+                }
+            }
+
+            template <size_t TimeBlock,
+                size_t ITile,
+                size_t JTile,
+                class Comp,
+                class Backend,
+                class Grid,
+                class Field,
+                class... Fields>
+            void time_blocked_run_impl(std::false_type,
+                Comp comp,
+                Backend,
+                Grid const &grid,
+                size_t steps,
+                Field &a,
+                Field &b,
+                Fields &&... fields) {
+                sweep<Backend>(comp, grid, steps, a, b, fields...);
+            }
+
+            template <size_t TimeBlock,
+                size_t ITile,
+                size_t JTile,
+                class Comp,
+                class Backend,
+                class Grid,
+                class Field,
+                class... Fields>
+            void time_blocked_run_impl(std::true_type,
+                Comp comp,
+                Backend backend,
+                Grid const &grid,
+                size_t steps,
+                Field &a,
+                Field &b,
+                Fields &&... fields) {
+                using spec_t = decltype(get_spec(comp, std::make_index_sequence<2 + sizeof...(Fields)>()));
+                using rw_args_t =
+                    meta::filter<meta::not_<core::is_tmp_arg>::apply, frontend_impl_::all_rw_args<spec_t>>;
+                static_assert(meta::length<rw_args_t>::value == 1 && meta::st_contains<rw_args_t, arg<1>>::value,
+                    "time_blocked_run: the second argument should be the only one that is written.");
+                using esfs_t = meta::flatten<meta::transform<get_esfs, spec_t>>;
+                static_assert(!meta::st_contains<core::compute_read_only_args<esfs_t>, arg<1>>::value,
+                    "time_blocked_run: the second argument should not be read.");
+                static_assert(meta::length<meta::filter<writes_second_arg, esfs_t>>::value == 1,
+                    "time_blocked_run: the second argument should be written by a single stage.");
+                using extent_map_t = core::get_extent_map_from_msses<spec_t>;
+                static_assert(std::is_same<core::lookup_extent_map<extent_map_t, arg<1>>, extent<>>::value,
+                    "time_blocked_run: the second argument should not be read with offsets.");
+                using extent_t = core::lookup_extent_map<extent_map_t, arg<0>>;
+                using thread_pool_t = decltype(backend_thread_pool(backend));
+                using serial_t = decltype(backend_with_thread_pool(backend, thread_pool::dummy()));
+                using data_t = std::remove_const_t<sid::element_type<Field>>;
+
+                constexpr int_t i_minus = extent_t::iminus::value;
+                constexpr int_t i_plus = extent_t::iplus::value;
+                constexpr int_t j_minus = extent_t::jminus::value;
+                constexpr int_t j_plus = extent_t::jplus::value;
+
+                auto origin = grid.origin();
+                range dom_i = {at_key<dim::i>(origin), at_key<dim::i>(origin) + grid.i_size()};
+                range dom_j = {at_key<dim::j>(origin), at_key<dim::j>(origin) + grid.j_size()};
+                range dom_k = {at_key<dim::k>(origin), at_key<dim::k>(origin) + grid.k_size()};
+                range box_k = {dom_k.lo + extent_t::kminus::value, dom_k.hi + extent_t::kplus::value};
+                // the points that may be read but are never computed
+                range halo_i = intersect({dom_i.lo + i_minus, dom_i.hi + i_plus}, bounds<dim::i>(a));
+                range halo_j = intersect({dom_j.lo + j_minus, dom_j.hi + j_plus}, bounds<dim::j>(a));
+                range halo_k = intersect(box_k, bounds<dim::k>(a));
+
+                int_t i_tiles = (grid.i_size() + ITile - 1) / ITile;
+                int_t j_tiles = (grid.j_size() + JTile - 1) / JTile;
+                size_t buffer_size = (ITile + TimeBlock * (i_plus - i_minus)) *
+                                     (JTile + TimeBlock * (j_plus - j_minus)) * (box_k.hi - box_k.lo);
+                std::vector<std::unique_ptr<data_t[]>> buffers(2 * thread_pool::get_max_threads(thread_pool_t()));
+
+                for (size_t done = 0; done < steps;) {
+                    size_t block = std::min(TimeBlock, steps - done);
+                    if (block == 1) {
+                        sweep<Backend>(comp, grid, 1, a, b, fields...);
+                        ++done;
+                        continue;
+                    }
+                    thread_pool::parallel_for_loop(
+                        thread_pool_t(),
+                        [&](auto i_tile, auto j_tile) {
+                            range tile_i = {dom_i.lo + int_t(i_tile) * int_t(ITile),
+                                std::min(dom_i.lo + int_t(i_tile + 1) * int_t(ITile), dom_i.hi)};
+                            range tile_j = {dom_j.lo + int_t(j_tile) * int_t(JTile),
+                                std::min(dom_j.lo + int_t(j_tile + 1) * int_t(JTile), dom_j.hi)};
+                            auto region = [&](size_t step) {
+                                int_t n = block - 1 - step;
+                                return std::make_pair(
+                                    intersect({tile_i.lo + n * i_minus, tile_i.hi + n * i_plus}, dom_i),
+                                    intersect({tile_j.lo + n * j_minus, tile_j.hi + n * j_plus}, dom_j));
+                            };
+                            range box_i = {tile_i.lo + int_t(block) * i_minus, tile_i.hi + int_t(block) * i_plus};
+                            range box_j = {tile_j.lo + int_t(block) * j_minus, tile_j.hi + int_t(block) * j_plus};
+
+                            int_t thread = thread_pool::get_thread_num(thread_pool_t());
+                            std::unique_ptr<data_t[]> *data = &buffers[2 * thread];
+                            if (!data[0]) {
+                                data[0].reset(new data_t[buffer_size]);
+                                data[1].reset(new data_t[buffer_size]);
+                            }
+                            auto buf0 = make_buffer(data[0].get(), box_i, box_j, box_k);
+                            auto buf1 = make_buffer(data[1].get(), box_i, box_j, box_k);
+
+                            // the halo points around the domain are read from the buffers by the later steps
+                            auto copy = [&](range i_range, int_t j, int_t k) {
+                                for (int_t i = i_range.lo; i < i_range.hi; ++i) {
+                                    auto &&val = *ptr_at(a, i, j, k);
+                                    *ptr_at(buf0, i, j, k) = val;
+                                    *ptr_at(buf1, i, j, k) = val;
+                                }
+                            };
+                            range copy_i = intersect(box_i, halo_i);
+                            range copy_j = intersect(box_j, halo_j);
+                            for (int_t k = halo_k.lo; k < halo_k.hi; ++k)
+                                for (int_t j = copy_j.lo; j < copy_j.hi; ++j) {
+                                    if (k < dom_k.lo || k >= dom_k.hi || j < dom_j.lo || j >= dom_j.hi) {
+                                        copy(copy_i, j, k);
+                                    } else {
+                                        copy({copy_i.lo, std::min(copy_i.hi, dom_i.lo)}, j, k);
+                                        copy({std::max(copy_i.lo, dom_i.hi), copy_i.hi}, j, k);
+                                    }
+                                }
+
+                            auto run_region = [&](size_t step, auto &src, auto &dst) {
+                                auto r = region(step);
+                                run(comp,
+                                    serial_t(),
+                                    grid.horizontal_subgrid(
+                                        r.first.lo, r.first.hi - r.first.lo, r.second.lo, r.second.hi - r.second.lo),
+                                    src,
+                                    dst,
+                                    fields...);
+                            };
+                            run_region(0, a, buf0);
+                            for (size_t step = 1; step + 1 < block; ++step) {
+                                if (step % 2)
+                                    run_region(step, buf0, buf1);
+                                else
+                                    run_region(step, buf1, buf0);
+                            }
+                            if (block % 2)
+                                run_region(block - 1, buf1, b);
+                            else
+                                run_region(block - 1, buf0, b);
+                        },
+                        i_tiles,
+                        j_tiles);
+                    std::swap(a, b);
+                    done += block;
+                }
+            }
+
+            template <size_t TimeBlock,
+                size_t ITile = 64,
+                size_t JTile = 32,
+                class Comp,
+                class Backend,
+                class Grid,
+                class Field,
+                class... Fields>
+            void time_blocked_run(
+                Comp comp, Backend backend, Grid const &grid, size_t steps, Field &a, Field &b, Fields &&... fields) {
+                static_assert(TimeBlock > 0 && ITile > 0 && JTile > 0, "time_blocked_run: invalid block sizes.");
+                static_assert(is_sid<Field>::value && conjunction<is_sid<Fields>...>::value,
+                    "All computation fields must satisfy SID concept.");
+                time_blocked_run_impl<TimeBlock, ITile, JTile>(is_rebindable<Backend>(),
+                    comp,
+                    backend,
+                    grid,
+                    steps,
+                    a,
+                    b,
+                    std::forward<Fields>(fields)...);
+            }
+        } // namespace time_blocked_frontend_impl_
+        using time_blocked_frontend_impl_::time_blocked_run;
+    } // namespace stencil
+} // namespace gridtools
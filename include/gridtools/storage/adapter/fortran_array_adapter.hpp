@@ -9,12 +9,40 @@
  */
 #pragma once
 
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
 #include <cpp_bindgen/fortran_array_view.hpp>
 
 #include "../../layout_transformation.hpp"
+#include "../../meta.hpp"
 #include "../data_store.hpp"
+#include "../sid.hpp"
 
 namespace gridtools {
+    namespace fortran_array_adapter_impl_ {
+        /*
+         *  True if the innermost dimension of the data store is the first unmasked one, which is contiguous in the
+         *  Fortran arrays. The strides of the other dimensions are run time values in both cases.
+         */
+        template <class Layout>
+        constexpr bool is_fortran_compatible() {
+            for (size_t i = 0; i != Layout::masked_length; ++i)
+                if (Layout::at(i) >= 0)
+                    return Layout::at(i) + 1 == int(Layout::unmasked_length);
+            return true;
+        }
+
+        template <class DataStorePtr>
+        class direct_binding;
+
+        template <class DataStorePtr>
+        class copy_binding;
+    } // namespace fortran_array_adapter_impl_
+
     template <class DataStorePtr>
     class fortran_array_adapter {
         static_assert(storage::is_data_store_ptr<DataStorePtr>::value, "");
@@ -79,5 +107,111 @@ namespace gridtools {
             transform_layout(
                 fortran_ptr(), src->get_target_ptr(), src->lengths(), fortran_strides(src), src->strides());
         }
+
+        /**
+         *  Binds the Fortran array to the computations; the result models SID and is passed to `stencil::run`.
+         *  `ds` describes the field: its lengths, halos and layout.
+         *
+         *  If the innermost dimension of `ds` is the one that is contiguous in the Fortran array (like for
+         *  `storage::cpu_ifirst`), the result refers to the Fortran memory with the strides of the Fortran array and
+         *  nothing is copied.
+         *  Otherwise the Fortran array is copied into `ds` and the result refers to `ds`. In both cases `sync()` has to
+         *  be called on the result after the computations that modify the field; it copies `ds` back into the Fortran
+         *  array if needed.
+         */
+        template <class Layout = typename data_store_t::layout_t,
+            std::enable_if_t<fortran_array_adapter_impl_::is_fortran_compatible<Layout>(), int> = 0>
+        fortran_array_adapter_impl_::direct_binding<DataStorePtr> bind(DataStorePtr const &ds) const {
+            check_fortran_lengths(ds);
+            if (reinterpret_cast<std::uintptr_t>(m_descriptor.data) % alignof(decltype(*fortran_ptr())))
+                throw std::runtime_error("fortran array is not aligned");
+            auto &&strides = fortran_strides(ds);
+            for (size_t i = 0; i < strides.size(); ++i)
+                if (strides[i] * ds->lengths()[i] > (uint_t)std::numeric_limits<int_t>::max())
+                    throw std::runtime_error("fortran array is too large");
+            return {ds, fortran_ptr(), strides};
+        }
+
+        template <class Layout = typename data_store_t::layout_t,
+            std::enable_if_t<!fortran_array_adapter_impl_::is_fortran_compatible<Layout>(), int> = 0>
+        fortran_array_adapter_impl_::copy_binding<DataStorePtr> bind(DataStorePtr const &ds) const {
+            transform_to(ds);
+            return {ds, *this};
+        }
     };
+
+    namespace fortran_array_adapter_impl_ {
+        struct fortran_kind;
+
+        template <class DataStorePtr>
+        class direct_binding {
+            using data_store_t = typename DataStorePtr::element_type;
+            using data_t = typename data_store_t::data_t;
+            using strides_t = decltype(storage::sid_get_strides(std::declval<DataStorePtr const &>()));
+            using ptr_diff_t = decltype(storage::sid_get_ptr_diff(std::declval<DataStorePtr const &>()));
+
+            DataStorePtr m_ds;
+            data_t *m_ptr;
+            strides_t m_strides;
+
+            friend storage::storage_sid_impl_::ptr_holder<data_t> sid_get_origin(direct_binding const &obj) {
+                return {obj.m_ptr};
+            }
+            friend strides_t sid_get_strides(direct_binding const &obj) { return obj.m_strides; }
+            // the strides differ from the ones of the data stores of the same kind
+            friend meta::list<fortran_kind, typename data_store_t::kind_t> sid_get_strides_kind(
+                direct_binding const &) {
+                return {};
+            }
+            friend ptr_diff_t sid_get_ptr_diff(direct_binding const &) { return {}; }
+            friend auto sid_get_lower_bounds(direct_binding const &obj) {
+                return storage::sid_get_lower_bounds(obj.m_ds);
+            }
+            friend auto sid_get_upper_bounds(direct_binding const &obj) {
+                return storage::sid_get_upper_bounds(obj.m_ds);
+            }
+
+          public:
+            template <class Strides>
+            direct_binding(DataStorePtr ds, data_t *ptr, Strides const &strides)
+                : m_ds(std::move(ds)), m_ptr(ptr),
+                  m_strides(storage::storage_sid_impl_::convert_strides_f<typename data_store_t::layout_t>()(strides)) {
+            }
+
+            static constexpr bool is_zero_copy() { return true; }
+
+            void sync() const {}
+        };
+
+        template <class DataStorePtr>
+        class copy_binding {
+            DataStorePtr m_ds;
+            fortran_array_adapter<DataStorePtr> m_adapter;
+
+            friend auto sid_get_origin(copy_binding const &obj) { return storage::sid_get_origin(obj.m_ds); }
+            friend auto sid_get_strides(copy_binding const &obj) { return storage::sid_get_strides(obj.m_ds); }
+            friend decltype(storage::sid_get_strides_kind(std::declval<DataStorePtr const &>())) sid_get_strides_kind(
+                copy_binding const &) {
+                return {};
+            }
+            friend decltype(storage::sid_get_ptr_diff(std::declval<DataStorePtr const &>())) sid_get_ptr_diff(
+                copy_binding const &) {
+                return {};
+            }
+            friend auto sid_get_lower_bounds(copy_binding const &obj) {
+                return storage::sid_get_lower_bounds(obj.m_ds);
+            }
+            friend auto sid_get_upper_bounds(copy_binding const &obj) {
+                return storage::sid_get_upper_bounds(obj.m_ds);
+            }
+
+          public:
+            copy_binding(DataStorePtr ds, fortran_array_adapter<DataStorePtr> const &adapter)
+                : m_ds(std::move(ds)), m_adapter(adapter) {}
+
+            static constexpr bool is_zero_copy() { return false; }
+
+            void sync() const { m_adapter.transform_from(m_ds); }
+        };
+    } // namespace fortran_array_adapter_impl_
 } // namespace gridtools
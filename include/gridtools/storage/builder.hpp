@@ -9,15 +9,22 @@
  */
 #pragma once
 
+#include <algorithm>
 #include <tuple>
 #include <type_traits>
 
+#include "../common/array.hpp"
 #include "../common/defs.hpp"
 #include "../common/generic_metafunctions/accumulate.hpp"
 #include "../common/generic_metafunctions/for_each.hpp"
 #include "../common/hymap.hpp"
 #include "../common/layout_map.hpp"
+#include "../common/integral_constant.hpp"
+#include "../common/omp.hpp"
 #include "../meta.hpp"
+#include "../sid/concept.hpp"
+#include "../sid/multi_shift.hpp"
+#include "bundle.hpp"
 #include "data_store.hpp"
 #include "traits.hpp"
 
@@ -32,37 +39,256 @@ namespace gridtools {
                 struct halos {};
                 struct initializer {};
                 struct layout {};
+                struct first_touch {};
+                struct bundle {};
+                struct padding {};
             } // namespace param
 
-            template <class Fun, class T, class Layout, size_t N, size_t... Is>
-            void initializer_impl(
-                Fun const &fun, T *dst, Layout layout, info<N> const &info, std::index_sequence<Is...>) {
-                int length = info.length();
-#pragma omp parallel for
-                for (int i = 0; i < length; ++i) {
-                    auto indices = info.indices(layout, i);
-                    dst[i] = fun(indices[Is]...);
+            /**
+             *  Calls `fun(index, indices, size)` for the rows `[first, last)` of the box `[from, to)`. A row is the
+             *  run of the box along the inner most dimension, it starts at the storage offset `index` and the
+             *  `indices`, the offsets `index + n` for `n < size` correspond to the indices incremented by `n` along the
+             *  inner most dimension. The rows are enumerated in the memory order, the indices are decoded once and
+             *  updated incrementally from row to row.
+             */
+            template <class Layout, size_t N, class Fun>
+            void for_each_row(Layout,
+                info<N> const &info,
+                array<int, N> const &from,
+                array<int, N> const &to,
+                size_t first,
+                size_t last,
+                Fun const &fun) {
+                constexpr size_t inner = Layout::unmasked_length == 0 ? 0 : Layout::find(Layout::max_arg);
+                int size = Layout::unmasked_length == 0 ? 1 : to[inner] - from[inner];
+                auto indices = from;
+                size_t row = first;
+                for (int arg = Layout::max_arg - 1; arg >= 0; --arg) {
+                    size_t d = Layout::find(arg);
+                    size_t n = to[d] - from[d];
+                    indices[d] = from[d] + row % n;
+                    row /= n;
                 }
+                for (row = first; row != last; ++row) {
+                    fun(info.index(indices), indices, size);
+                    for (int arg = Layout::max_arg - 1; arg >= 0; --arg) {
+                        size_t d = Layout::find(arg);
+                        if (++indices[d] < to[d])
+                            break;
+                        indices[d] = from[d];
+                    }
+                }
+            }
+
+            template <class Layout, size_t N>
+            size_t rows_count(Layout, array<int, N> const &from, array<int, N> const &to) {
+                size_t res = 1;
+                for (int arg = 0; arg < Layout::max_arg; ++arg)
+                    res *= to[Layout::find(arg)] - from[Layout::find(arg)];
+                return res;
+            }
+
+            template <class Layout, size_t N>
+            array<int, N> whole_box_lower(Layout, info<N> const &info) {
+                array<int, N> res;
+                for (size_t d = 0; d != N; ++d)
+                    res[d] = Layout::at(d) < 0 ? info.lengths()[d] - 1 : 0;
+                return res;
+            }
+
+            template <size_t N>
+            array<int, N> whole_box_upper(info<N> const &info) {
+                array<int, N> res;
+                for (size_t d = 0; d != N; ++d)
+                    res[d] = info.lengths()[d];
+                return res;
+            }
+
+            /**
+             *  Calls `fun(index, indices, size)` for all rows of the storage (see `for_each_row`), the rows are
+             *  distributed over the threads in equal contiguous chunks without regard to the decomposition of the
+             *  stencil computation.
+             */
+            struct flat_loop_f {
+                template <class Layout, size_t N, class Fun>
+                void operator()(Layout layout, info<N> const &info, Fun const &fun) const {
+                    auto from = whole_box_lower(layout, info);
+                    auto to = whole_box_upper(info);
+                    size_t rows = rows_count(layout, from, to);
+#pragma omp parallel
+                    {
+                        size_t threads = omp_get_num_threads();
+                        size_t thread = omp_get_thread_num();
+                        size_t chunk = (rows + threads - 1) / threads;
+                        size_t first = std::min(rows, thread * chunk);
+                        size_t last = std::min(rows, first + chunk);
+                        for_each_row(layout, info, from, to, first, last, fun);
+                    }
+                }
+            };
+
+            /**
+             *  Calls `fun(index, indices, size)` for all rows of the storage (see `for_each_row`), the rows are
+             *  distributed over the threads in the same blocks as the stencil computation. Thereby, on first touch
+             *  NUMA systems the pages of the storage are placed on the nodes that compute on them.
+             *
+             *  `Decomposition` is invoked with the i, j and k sizes of the compute domain (the storage without the
+             *  halos) and a callback `f(i_begin, i_end, j_begin, j_end, k_begin, k_end)`. It should call the callback
+             *  for every block from the thread that will process it. The halo points are assigned to the adjacent
+             *  blocks.
+             *
+             *  The storage dimensions 0, 1 and 2 are i, j and k as in the stencil computation, the layout only orders
+             *  them in memory (the rows of a block are enumerated by `for_each_row`). A masked dimension is touched
+             *  only by the blocks at its start, the dimensions after k are not split.
+             */
+            template <class Decomposition, size_t N>
+            struct blocked_loop_f {
+                static_assert(N >= 2, "first touch decomposition needs the i and j dimensions");
+
+                static constexpr size_t blocked_dims = N < 3 ? N : 3;
+
+                Decomposition m_decomposition;
+                array<int, N> m_halos;
+
+                template <class Layout, class Fun>
+                void operator()(Layout layout, info<N> const &info, Fun const &fun) const {
+                    auto lo = whole_box_lower(layout, info);
+                    auto hi = whole_box_upper(info);
+                    array<int_t, 3> sizes = {1, 1, 1};
+                    for (size_t d = 0; d != blocked_dims; ++d) {
+                        sizes[d] = hi[d] - 2 * m_halos[d];
+                        if (sizes[d] <= 0)
+                            return flat_loop_f()(layout, info, fun);
+                    }
+                    m_decomposition(sizes[0],
+                        sizes[1],
+                        sizes[2],
+                        [&](int_t i_begin, int_t i_end, int_t j_begin, int_t j_end, int_t k_begin, int_t k_end) {
+                            array<int_t, 3> begin = {i_begin, j_begin, k_begin};
+                            array<int_t, 3> end = {i_end, j_end, k_end};
+                            auto from = lo;
+                            auto to = hi;
+                            for (size_t d = 0; d != blocked_dims; ++d) {
+                                if (Layout::at(d) < 0) {
+                                    if (begin[d] != 0)
+                                        return;
+                                    continue;
+                                }
+                                from[d] = begin[d] == 0 ? 0 : begin[d] + m_halos[d];
+                                to[d] = end[d] == sizes[d] ? hi[d] : end[d] + m_halos[d];
+                            }
+                            for (size_t d = 0; d != N; ++d)
+                                if (from[d] >= to[d])
+                                    return;
+                            for_each_row(layout, info, from, to, 0, rows_count(layout, from, to), fun);
+                        });
+                }
+            };
+
+            template <class Layout>
+            constexpr size_t inner_dim(Layout) {
+                return Layout::unmasked_length == 0 ? 0 : Layout::find(Layout::max_arg);
+            }
+
+            // the inner most index is the only one that varies within a row, the others are passed as they are
+            template <size_t Inner, size_t I, class Indices>
+            int row_index(Indices const &indices, int n) {
+                return I == Inner ? indices[I] + n : indices[I];
+            }
+
+            template <class Fun, class T, class Layout, size_t N, class Loop, size_t... Is>
+            void initializer_impl(Fun const &fun,
+                T *dst,
+                Layout layout,
+                info<N> const &info,
+                Loop const &loop,
+                std::index_sequence<Is...>) {
+                constexpr size_t inner = inner_dim(Layout());
+                loop(layout, info, [&](size_t index, array<int, N> const &indices, int size) {
+                    auto const row = indices;
+                    T *ptr = dst + index;
+                    for (int n = 0; n < size; ++n)
+                        ptr[n] = fun(row_index<inner, Is>(row, n)...);
+                });
             };
 
             template <class Fun>
             auto wrap_initializer(Fun fun) {
-                return [fun = std::move(fun)](auto *dst, auto layout, auto const &info) {
-                    initializer_impl(
-                        fun, dst, layout, info, std::make_index_sequence<std::decay_t<decltype(info)>::ndims>());
+                return [fun = std::move(fun)](auto *dst, auto layout, auto const &info, auto const &loop) {
+                    initializer_impl(fun,
+                        dst,
+                        layout,
+                        info,
+                        loop,
+                        std::make_index_sequence<std::decay_t<decltype(info)>::ndims>());
                 };
             }
 
             template <class T>
             auto wrap_value(T const &value) {
-                return [value = std::move(value)](auto *dst, auto, auto const &info) {
-                    int length = info.length();
-#pragma omp parallel for
-                    for (int i = 0; i < length; ++i)
-                        dst[i] = value;
+                return [value = std::move(value)](auto *dst, auto layout, auto const &info, auto const &loop) {
+                    loop(layout, info, [&](size_t index, auto const &, int size) {
+                        std::fill_n(dst + index, size, value);
+                    });
+                };
+            }
+
+            // copies the strided source row into the contiguous destination row
+            template <class T, class Ptr, class Stride>
+            void copy_row(T *dst, Ptr src, Stride stride, int size) {
+#pragma omp simd
+                for (int n = 0; n < size; ++n)
+                    dst[n] = *(src + n * stride);
+            }
+
+            template <class Src>
+            auto wrap_sid(Src const &src) {
+                return [origin = sid::get_origin(src), strides = sid::get_strides(src)](
+                           auto *dst, auto layout, auto const &info, auto const &loop) {
+                    constexpr size_t inner = inner_dim(decltype(layout)());
+                    auto &&inner_stride = sid::get_stride<integral_constant<int_t, inner>>(strides);
+                    loop(layout, info, [&](size_t index, auto const &indices, int size) {
+                        auto ptr = origin();
+                        sid::multi_shift(ptr, strides, indices);
+                        copy_row(dst + index, ptr, inner_stride, size);
+                    });
                 };
             }
 
+            template <class T>
+            auto wrap_fortran(T const *src) {
+                return [src](auto *dst, auto layout, auto const &info, auto const &loop) {
+                    using layout_t = decltype(layout);
+                    constexpr size_t n = std::decay_t<decltype(info)>::ndims;
+                    // the unmasked dimensions are contiguous in the given order
+                    array<int_t, n> strides;
+                    int_t stride = 1;
+                    for (size_t d = 0; d != n; ++d) {
+                        strides[d] = layout_t::at(d) < 0 ? 0 : stride;
+                        if (layout_t::at(d) >= 0)
+                            stride *= info.lengths()[d];
+                    }
+                    constexpr size_t inner = inner_dim(layout_t());
+                    loop(layout, info, [&](size_t index, auto const &indices, int size) {
+                        T const *ptr = src;
+                        for (size_t d = 0; d != n; ++d)
+                            ptr += strides[d] * indices[d];
+                        copy_row(dst + index, ptr, strides[inner], size);
+                    });
+                };
+            }
+
+            template <class Initializer, class Loop>
+            auto bind_loop(Initializer initializer, Loop loop) {
+                return [initializer = std::move(initializer), loop = std::move(loop)](
+                           auto *dst, auto layout, auto const &info) { initializer(dst, layout, info, loop); };
+            }
+
+            template <class Loop>
+            uninitialized bind_loop(uninitialized, Loop const &) {
+                return {};
+            }
+
             template <class Traits, class Layout>
             struct custom_traits : Traits {
                 friend Layout storage_layout(custom_traits, std::integral_constant<size_t, Layout::masked_length>) {
@@ -70,6 +296,11 @@ namespace gridtools {
                 }
             };
 
+            template <class Traits, class Padding>
+            struct padded_traits : Traits {
+                friend Padding storage_padding(padded_traits) { return {}; }
+            };
+
             template <class... Keys>
             struct keys {
                 template <class... Vals>
@@ -180,6 +411,17 @@ namespace gridtools {
                         [](auto param) { check_dimensions_number<N>(param); });
                 }
 
+                template <size_t N, bool HasFirstTouch = has<param::first_touch>::value>
+                std::enable_if_t<!HasFirstTouch, flat_loop_f> make_loop(array<int, N> const &) const {
+                    return {};
+                }
+
+                template <size_t N, bool HasFirstTouch = has<param::first_touch>::value>
+                std::enable_if_t<HasFirstTouch, blocked_loop_f<value_type<param::first_touch>, N>> make_loop(
+                    array<int, N> const &halos) const {
+                    return {value<param::first_touch>(), halos};
+                }
+
                 constexpr builder_type(Params params) : m_params(std::move(params)) {}
 
                 template <class, class>
@@ -251,21 +493,109 @@ namespace gridtools {
                     return add_value<param::initializer>(wrap_value(std::move(value)));
                 }
 
+                /**
+                 *  Initializes the storage with the values of the SID `src`, the element at the indices `i, j, ...` is
+                 *  taken from `src` shifted by `i, j, ...` along the dimensions `integral_constant<int_t, 0>, ...`
+                 *  (the dimensions of the SIDs of the data stores). `src` may be another data store of any layout.
+                 */
+                template <class Src>
+                auto copy_from(Src const &src) const {
+                    static_assert(!has<param::initializer>::value, "storage initializer/value is set twice");
+                    static_assert(sid::is_sid<Src>::value, "builder.copy_from(...) argument should model SID");
+                    return add_value<param::initializer>(wrap_sid(src));
+                }
+
+                /**
+                 *  Initializes the storage with the values of the contiguous Fortran array `src`. The array has the
+                 *  unmasked dimensions of the storage (the first one is contiguous), as the arrays given to the
+                 *  `fortran_array_adapter`.
+                 */
+                template <class T>
+                auto copy_from_fortran(T const *src) const {
+                    static_assert(!has<param::initializer>::value, "storage initializer/value is set twice");
+                    return add_value<param::initializer>(wrap_fortran(src));
+                }
+
+                /**
+                 *  The initialization distributes the storage over the threads in the same blocks as the stencil
+                 *  computation. The decomposition of a backend is given by `first_touch_blocks(backend)`.
+                 */
+                template <class Decomposition>
+                auto first_touch(Decomposition decomposition) const {
+                    static_assert(!has<param::first_touch>::value, "storage first touch decomposition is set twice");
+                    return add_value<param::first_touch>(std::move(decomposition));
+                }
+
+                /**
+                 *  Allocates `N` fields of the given shape in one storage, see `bundle.hpp`. `build()` returns a
+                 *  `field_bundle` then. The initializer gets the field number as the last argument.
+                 */
+                template <size_t N, bundle_kind Kind = bundle_kind::blocked>
+                auto bundle() const {
+                    static_assert(!has<param::bundle>::value, "storage bundle is set twice");
+                    static_assert(N > 0, "bundle should have at least one field");
+                    return add_type<param::bundle, bundle_impl_::bundle_spec<N, Kind>>();
+                }
+
+                /**
+                 *  Sets the stride padding policy, `anti_aliasing` pads the outer strides to avoid the cache set
+                 *  conflicts between the neighbouring rows and planes.
+                 */
+                template <class Padding>
+                auto padding() const {
+                    static_assert(!has<param::padding>::value, "storage padding is set twice");
+                    return add_type<param::padding, Padding>();
+                }
+
                 auto build() const {
                     static_assert(has<param::type>::value, "storage type is not set");
                     static_assert(has<param::lengths>::value, "storage lengths are not set");
-                    using traits_t =
+                    return build(has<param::bundle>());
+                }
+
+                auto operator()() const { return build(); }
+
+              private:
+                template <class T>
+                using apply_padding_t =
+                    meta::if_c<has<param::padding>::value, padded_traits<T, value_type<param::padding>>, T>;
+
+                auto build(std::false_type) const {
+                    using base_traits_t =
                         meta::if_c<has<param::layout>::value, custom_traits<Traits, value_type<param::layout>>, Traits>;
+                    using traits_t = apply_padding_t<base_traits_t>;
                     auto &&lengths = value<param::lengths>();
                     auto &&name = value<param::name, std::string>();
                     constexpr auto n = tuple_util::size<decltype(lengths)>::value;
                     auto &&halos = value<param::halos, array<int, n>>();
-                    auto initializer = value<param::initializer, uninitialized>();
+                    auto initializer = bind_loop(value<param::initializer, uninitialized>(), make_loop(halos));
                     return make_data_store<traits_t, typename value_type<param::type>::type, value_type<param::id>>(
                         name, lengths, halos, initializer);
                 }
 
-                auto operator()() const { return build(); }
+                auto build(std::true_type) const {
+                    using spec_t = value_type<param::bundle>;
+                    auto &&lengths = value<param::lengths>();
+                    auto &&name = value<param::name, std::string>();
+                    constexpr auto n = tuple_util::size<decltype(lengths)>::value;
+                    auto &&halos = value<param::halos, array<int, n>>();
+                    using base_layout_t = meta::
+                        if_c<has<param::layout>::value, value_type<param::layout>, traits::layout_type<Traits, n>>;
+                    using layout_t = typename bundle_impl_::bundle_layout<base_layout_t, spec_t::kind>::type;
+                    using traits_t = apply_padding_t<bundle_impl_::bundle_traits<Traits, layout_t, spec_t::kind>>;
+                    array<uint_t, n + 1> bundle_lengths;
+                    array<int, n + 1> bundle_halos;
+                    for (size_t i = 0; i != n; ++i) {
+                        bundle_lengths[i] = lengths[i];
+                        bundle_halos[i] = halos[i];
+                    }
+                    bundle_lengths[n] = spec_t::size;
+                    bundle_halos[n] = 0;
+                    auto initializer = bind_loop(value<param::initializer, uninitialized>(), make_loop(bundle_halos));
+                    auto ds = make_data_store<traits_t, typename value_type<param::type>::type, value_type<param::id>>(
+                        name, bundle_lengths, bundle_halos, initializer);
+                    return field_bundle<typename decltype(ds)::element_type, spec_t::size>(std::move(ds));
+                }
             };
             template <class Traits>
             constexpr builder_type<Traits, keys<>::values<>> builder = {};
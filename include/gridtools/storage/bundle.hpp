@@ -0,0 +1,120 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <memory>
+#include <utility>
+
+#include "../common/integral_constant.hpp"
+#include "../common/layout_map.hpp"
+#include "../common/tuple.hpp"
+#include "data_store.hpp"
+
+/**
+ *  @file
+ *  Field bundles: `N` fields of the same shape in one allocation.
+ *
+ *  A bundle is a data store with an additional last dimension that enumerates the fields. With
+ *  `bundle_kind::blocked` this dimension is the outermost one: the fields are co-located blocks that have the same
+ *  layout as the standalone fields. With `bundle_kind::interleaved` it is the innermost one (without padding): the
+ *  values of the fields at the same point are adjacent.
+ *
+ *  `bundle.field<I>()` is a SID for the `I`-th field (with `sid.hpp` included). All the fields of a bundle have the
+ *  same strides kind, so `sid::composite` keeps one copy of their strides and pointer differences.
+ */
+
+namespace gridtools {
+    namespace storage {
+        enum class bundle_kind { blocked, interleaved };
+
+        namespace bundle_impl_ {
+            template <class Layout, bundle_kind Kind>
+            struct bundle_layout;
+
+            template <int... Args>
+            struct bundle_layout<layout_map<Args...>, bundle_kind::blocked> {
+                using type = layout_map<(Args < 0 ? -1 : Args + 1)..., 0>;
+            };
+
+            template <int... Args>
+            struct bundle_layout<layout_map<Args...>, bundle_kind::interleaved> {
+                using type = layout_map<Args..., layout_map<Args...>::unmasked_length>;
+            };
+
+            template <size_t N, bundle_kind Kind>
+            struct bundle_spec {
+                static constexpr size_t size = N;
+                static constexpr bundle_kind kind = Kind;
+            };
+
+            // the traits of the bundle data store: the layout is extended, the interleaved bundles are not padded
+            template <class Traits, class Layout, bundle_kind Kind>
+            struct bundle_traits : Traits {
+                friend Layout storage_layout(bundle_traits, std::integral_constant<size_t, Layout::masked_length>) {
+                    return {};
+                }
+            };
+
+            template <class Traits, class Layout>
+            struct bundle_traits<Traits, Layout, bundle_kind::interleaved> : Traits {
+                friend Layout storage_layout(bundle_traits, std::integral_constant<size_t, Layout::masked_length>) {
+                    return {};
+                }
+                friend integral_constant<size_t, 1> storage_alignment(bundle_traits) { return {}; }
+            };
+
+            /**
+             *  The `I`-th field of a bundle.
+             */
+            template <class DataStore, size_t I>
+            class bundle_field {
+                std::shared_ptr<DataStore> m_data_store;
+
+              public:
+                static constexpr size_t index = I;
+
+                explicit bundle_field(std::shared_ptr<DataStore> data_store) : m_data_store(std::move(data_store)) {}
+
+                std::shared_ptr<DataStore> const &data_store() const { return m_data_store; }
+            };
+
+            template <class DataStore, size_t N>
+            class field_bundle {
+                std::shared_ptr<DataStore> m_data_store;
+
+                template <size_t... Is>
+                auto fields(std::index_sequence<Is...>) const {
+                    return tuple<bundle_field<DataStore, Is>...>(field<Is>()...);
+                }
+
+              public:
+                static constexpr size_t size = N;
+
+                explicit field_bundle(std::shared_ptr<DataStore> data_store) : m_data_store(std::move(data_store)) {}
+
+                /**
+                 *  The data store of the whole bundle, the last index is the field number.
+                 */
+                std::shared_ptr<DataStore> const &data_store() const { return m_data_store; }
+
+                template <size_t I>
+                bundle_field<DataStore, I> field() const {
+                    static_assert(I < N, "bundle field index out of range");
+                    return bundle_field<DataStore, I>(m_data_store);
+                }
+
+                auto fields() const { return fields(std::make_index_sequence<N>()); }
+            };
+        } // namespace bundle_impl_
+
+        using bundle_impl_::bundle_field;
+        using bundle_impl_::field_bundle;
+    } // namespace storage
+} // namespace gridtools
@@ -0,0 +1,524 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "data_store.hpp"
+
+/**
+ *  @file
+ *  Checkpoint/restart of data stores.
+ *
+ *  `checkpoint_writer` writes a set of data stores into a self-describing binary container, `checkpoint_reader`
+ *  restores them. The container consists of a header and one data section per data store:
+ *
+ *      char magic[8]            "GTCKPT1\n"
+ *      uint64 header_size       multiple of the block size (4096)
+ *      uint64 num_records
+ *      records[num_records]:
+ *          uint64 name_size, char name[name_size]
+ *          uint32 element_size, uint32 element_kind ('f', 'i', 'u' or 'b' for the other trivially copyable types)
+ *          uint32 ndims, uint32 reserved
+ *          int32 layout[ndims], uint64 lengths[ndims], uint64 strides[ndims]
+ *          uint64 length        number of the elements in the data section
+ *          uint64 offset        offset of the data section in the file (multiple of the block size)
+ *
+ *  All integers are in the native byte order. A data section is the memory of the data store as is (including the
+ *  padding), so the restore reads directly into the memory of the data store without reformatting; it requires the
+ *  same element type, layout, lengths and strides.
+ *
+ *  The data sections are split into chunks that are written/read in parallel by a pool of threads. With `direct_io`
+ *  the file is opened with `O_DIRECT` (if the file system supports it) and the chunks go through aligned buffers.
+ *  The number of threads is taken from the environment variable `GT_CHECKPOINT_THREADS` (the number of the hardware
+ *  threads by default).
+ *
+ *  For the data stores with different host and target spaces the host copy is written and read (the target is
+ *  updated on the next target access).
+ */
+
+namespace gridtools {
+    namespace storage {
+        namespace checkpoint_impl_ {
+            constexpr size_t block_size = 4096;
+            constexpr char magic[8] = {'G', 'T', 'C', 'K', 'P', 'T', '1', '\n'};
+
+            inline size_t round_up(size_t size) { return (size + block_size - 1) / block_size * block_size; }
+
+            inline size_t default_threads() {
+                if (char const *env = std::getenv("GT_CHECKPOINT_THREADS")) {
+                    int res = std::atoi(env);
+                    if (res > 0)
+                        return res;
+                }
+                return std::max(std::thread::hardware_concurrency(), 1u);
+            }
+
+            [[noreturn]] inline void fail(std::string const &what, std::string const &path) {
+                throw std::runtime_error("checkpoint: " + what + " " + path + ": " + std::strerror(errno));
+            }
+
+            template <class T>
+            constexpr std::uint32_t element_kind() {
+                return std::is_floating_point<T>::value ? 'f'
+                                                        : std::is_signed<T>::value
+                                                              ? 'i'
+                                                              : std::is_unsigned<T>::value ? 'u' : 'b';
+            }
+
+            struct aligned_deleter {
+                void operator()(void *ptr) const { std::free(ptr); }
+            };
+            using aligned_buffer = std::unique_ptr<char, aligned_deleter>;
+
+            inline aligned_buffer make_aligned_buffer(size_t size) {
+                void *res = nullptr;
+                if (posix_memalign(&res, block_size, size ? size : block_size))
+                    throw std::bad_alloc();
+                return aligned_buffer(static_cast<char *>(res));
+            }
+
+            class file {
+                int m_fd = -1;
+                bool m_direct = false;
+
+              public:
+                file(std::string const &path, int flags, bool direct) {
+#ifdef O_DIRECT
+                    if (direct) {
+                        m_fd = open(path.c_str(), flags | O_DIRECT | O_CLOEXEC, 0644);
+                        m_direct = m_fd >= 0;
+                        // file systems like tmpfs don't support O_DIRECT, the regular I/O is used there
+                        if (m_fd < 0 && errno != EINVAL)
+                            fail("failed to open", path);
+                    }
+#endif
+                    if (m_fd < 0)
+                        m_fd = open(path.c_str(), flags | O_CLOEXEC, 0644);
+                    if (m_fd < 0)
+                        fail("failed to open", path);
+                }
+                file(file const &) = delete;
+                file &operator=(file const &) = delete;
+                ~file() { close(m_fd); }
+
+                bool direct() const { return m_direct; }
+
+                void write(void const *src, size_t size, size_t offset, std::string const &path) const {
+                    auto ptr = static_cast<char const *>(src);
+                    while (size) {
+                        auto res = pwrite(m_fd, ptr, size, offset);
+                        if (res < 0 && errno == EINTR)
+                            continue;
+                        if (res <= 0)
+                            fail("failed to write", path);
+                        ptr += res;
+                        size -= res;
+                        offset += res;
+                    }
+                }
+
+                void read(void *dst, size_t size, size_t offset, std::string const &path) const {
+                    auto ptr = static_cast<char *>(dst);
+                    while (size) {
+                        auto res = pread(m_fd, ptr, size, offset);
+                        if (res < 0 && errno == EINTR)
+                            continue;
+                        if (res < 0)
+                            fail("failed to read", path);
+                        if (res == 0)
+                            throw std::runtime_error("checkpoint: unexpected end of file " + path);
+                        ptr += res;
+                        size -= res;
+                        offset += res;
+                    }
+                }
+
+                void resize(size_t size, std::string const &path) const {
+                    if (ftruncate(m_fd, size))
+                        fail("failed to resize", path);
+                }
+            };
+
+            /**
+             *  The description of a data store in the checkpoint.
+             */
+            struct checkpoint_entry {
+                std::string name;
+                std::uint32_t element_size;
+                std::uint32_t element_kind;
+                std::vector<int> layout;
+                std::vector<std::uint64_t> lengths;
+                std::vector<std::uint64_t> strides;
+                std::uint64_t length;
+                std::uint64_t offset;
+
+                std::uint64_t bytes() const { return length * element_size; }
+            };
+
+            template <class DataStore>
+            checkpoint_entry make_entry(DataStore const &ds) {
+                using data_t = typename DataStore::data_t;
+                using layout_t = typename DataStore::layout_t;
+                checkpoint_entry res = {ds.name(), sizeof(data_t), element_kind<data_t>(), {}, {}, {}, ds.length(), 0};
+                for (size_t i = 0; i != DataStore::ndims; ++i) {
+                    res.layout.push_back(layout_t::at(i));
+                    res.lengths.push_back(ds.lengths()[i]);
+                    res.strides.push_back(ds.strides()[i]);
+                }
+                return res;
+            }
+
+            inline bool is_compatible(checkpoint_entry const &lhs, checkpoint_entry const &rhs) {
+                return lhs.element_size == rhs.element_size && lhs.element_kind == rhs.element_kind &&
+                       lhs.layout == rhs.layout && lhs.lengths == rhs.lengths && lhs.strides == rhs.strides &&
+                       lhs.length == rhs.length;
+            }
+
+            class serializer {
+                std::vector<char> m_data;
+
+              public:
+                template <class T>
+                void put(T const &val) {
+                    auto ptr = reinterpret_cast<char const *>(&val);
+                    m_data.insert(m_data.end(), ptr, ptr + sizeof(T));
+                }
+                void put(std::string const &val) {
+                    put(std::uint64_t(val.size()));
+                    m_data.insert(m_data.end(), val.begin(), val.end());
+                }
+                template <class T>
+                void put(std::vector<T> const &val) {
+                    for (auto &&item : val)
+                        put(item);
+                }
+                std::vector<char> &data() { return m_data; }
+            };
+
+            class deserializer {
+                char const *m_cur;
+                char const *m_end;
+
+                void check(size_t size) const {
+                    if (size_t(m_end - m_cur) < size)
+                        throw std::runtime_error("checkpoint: corrupted header");
+                }
+
+              public:
+                deserializer(char const *first, char const *last) : m_cur(first), m_end(last) {}
+
+                template <class T>
+                T get() {
+                    check(sizeof(T));
+                    T res;
+                    std::memcpy(&res, m_cur, sizeof(T));
+                    m_cur += sizeof(T);
+                    return res;
+                }
+                std::string get_string() {
+                    auto size = get<std::uint64_t>();
+                    check(size);
+                    std::string res(m_cur, size);
+                    m_cur += size;
+                    return res;
+                }
+                template <class T>
+                std::vector<T> get_vector(size_t size) {
+                    std::vector<T> res;
+                    for (size_t i = 0; i != size; ++i)
+                        res.push_back(get<T>());
+                    return res;
+                }
+            };
+
+            // one piece of the parallel transfer
+            struct chunk {
+                char *memory;
+                size_t size;
+                size_t offset;
+            };
+
+            inline std::vector<chunk> make_chunks(
+                std::vector<checkpoint_entry> const &entries, std::vector<char *> const &memory, size_t chunk_size) {
+                std::vector<chunk> res;
+                for (size_t i = 0; i != entries.size(); ++i)
+                    for (size_t start = 0; start < entries[i].bytes(); start += chunk_size)
+                        res.push_back({memory[i] + start,
+                            std::min(chunk_size, size_t(entries[i].bytes() - start)),
+                            size_t(entries[i].offset + start)});
+                return res;
+            }
+
+            // runs `fun(chunk, buffer)` for all the chunks on `num_threads` threads
+            template <class Fun>
+            void for_each_chunk(std::vector<chunk> const &chunks, size_t num_threads, size_t buffer_size, Fun fun) {
+                std::atomic<size_t> next{0};
+                std::exception_ptr error;
+                std::mutex mutex;
+                auto worker = [&] {
+                    try {
+                        aligned_buffer buffer;
+                        if (buffer_size)
+                            buffer = make_aligned_buffer(buffer_size);
+                        for (size_t i = next++; i < chunks.size(); i = next++)
+                            fun(chunks[i], buffer.get());
+                    } catch (...) {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        if (!error)
+                            error = std::current_exception();
+                        next = chunks.size();
+                    }
+                };
+                num_threads = std::max<size_t>(std::min(num_threads, chunks.size()), 1);
+                std::vector<std::thread> threads;
+                for (size_t i = 1; i < num_threads; ++i)
+                    threads.emplace_back(worker);
+                worker();
+                for (auto &thread : threads)
+                    thread.join();
+                if (error)
+                    std::rethrow_exception(error);
+            }
+
+            /**
+             *  The parameters of the parallel I/O.
+             */
+            struct checkpoint_options {
+                bool direct_io = false;
+                size_t threads = default_threads();
+                // multiple of the block size
+                size_t chunk_size = size_t(16) << 20;
+            };
+
+            inline size_t checked_chunk_size(checkpoint_options const &options) {
+                return std::max(round_up(options.chunk_size), block_size);
+            }
+
+            /**
+             *  Collects the data stores with `add` and writes them into the file with `write`. The data stores should
+             *  stay alive and unmodified until `write` is called. The names of the data stores should be unique.
+             */
+            class checkpoint_writer {
+                std::string m_path;
+                checkpoint_options m_options;
+                std::vector<checkpoint_entry> m_entries;
+                std::vector<char *> m_memory;
+
+              public:
+                explicit checkpoint_writer(std::string path, checkpoint_options options = {})
+                    : m_path(std::move(path)), m_options(options) {}
+
+                template <class DataStorePtr>
+                checkpoint_writer &add(DataStorePtr const &ds) {
+                    static_assert(is_data_store_ptr<DataStorePtr>::value, "data store pointer expected");
+                    using data_t = typename DataStorePtr::element_type::data_t;
+                    static_assert(!std::is_const<data_t>::value, "const data stores can not be checkpointed");
+                    static_assert(std::is_trivially_copyable<data_t>::value,
+                        "checkpoint requires trivially copyable element types");
+                    for (auto &&entry : m_entries)
+                        if (entry.name == ds->name())
+                            throw std::runtime_error("checkpoint: duplicate data store name " + ds->name());
+                    m_entries.push_back(make_entry(*ds));
+                    m_memory.push_back(reinterpret_cast<char *>(const_cast<data_t *>(ds->get_const_host_ptr())));
+                    return *this;
+                }
+
+                void write() {
+                    // the offsets depend on the header size and vice versa
+                    size_t header_size = block_size;
+                    std::vector<char> header;
+                    while (true) {
+                        size_t offset = header_size;
+                        for (auto &entry : m_entries) {
+                            entry.offset = offset;
+                            offset += round_up(entry.bytes());
+                        }
+                        serializer out;
+                        for (char c : magic)
+                            out.put(c);
+                        out.put(std::uint64_t(header_size));
+                        out.put(std::uint64_t(m_entries.size()));
+                        for (auto &&entry : m_entries) {
+                            out.put(entry.name);
+                            out.put(entry.element_size);
+                            out.put(entry.element_kind);
+                            out.put(std::uint32_t(entry.layout.size()));
+                            out.put(std::uint32_t(0));
+                            out.put(std::vector<std::int32_t>(entry.layout.begin(), entry.layout.end()));
+                            out.put(entry.lengths);
+                            out.put(entry.strides);
+                            out.put(entry.length);
+                            out.put(entry.offset);
+                        }
+                        header = std::move(out.data());
+                        if (header.size() <= header_size)
+                            break;
+                        header_size = round_up(header.size());
+                    }
+                    size_t total_size = header_size;
+                    if (!m_entries.empty())
+                        total_size = m_entries.back().offset + round_up(m_entries.back().bytes());
+
+                    file f(m_path, O_WRONLY | O_CREAT | O_TRUNC, m_options.direct_io);
+                    f.resize(total_size, m_path);
+                    auto header_buffer = make_aligned_buffer(header_size);
+                    std::memset(header_buffer.get(), 0, header_size);
+                    std::memcpy(header_buffer.get(), header.data(), header.size());
+                    f.write(header_buffer.get(), header_size, 0, m_path);
+
+                    size_t chunk_size = checked_chunk_size(m_options);
+                    bool direct = f.direct();
+                    for_each_chunk(make_chunks(m_entries, m_memory, chunk_size),
+                        m_options.threads,
+                        direct ? chunk_size : 0,
+                        [&](chunk const &c, char *buffer) {
+                            if (!direct)
+                                return f.write(c.memory, c.size, c.offset, m_path);
+                            // the sections are padded to the block size
+                            size_t size = round_up(c.size);
+                            std::memcpy(buffer, c.memory, c.size);
+                            std::memset(buffer + c.size, 0, size - c.size);
+                            f.write(buffer, size, c.offset, m_path);
+                        });
+                    m_entries.clear();
+                    m_memory.clear();
+                }
+            };
+
+            /**
+             *  Reads the header of the checkpoint on construction. The data stores are registered with `add` (by
+             *  their names) and restored with `read`.
+             */
+            class checkpoint_reader {
+                std::string m_path;
+                checkpoint_options m_options;
+                std::vector<checkpoint_entry> m_entries;
+                std::vector<checkpoint_entry> m_pending;
+                std::vector<char *> m_memory;
+
+              public:
+                explicit checkpoint_reader(std::string path, checkpoint_options options = {})
+                    : m_path(std::move(path)), m_options(options) {
+                    file f(m_path, O_RDONLY, m_options.direct_io);
+                    auto buffer = make_aligned_buffer(block_size);
+                    f.read(buffer.get(), block_size, 0, m_path);
+                    if (!std::equal(std::begin(magic), std::end(magic), buffer.get()))
+                        throw std::runtime_error("checkpoint: " + m_path + " is not a checkpoint");
+                    std::uint64_t header_size;
+                    std::memcpy(&header_size, buffer.get() + sizeof(magic), sizeof(header_size));
+                    if (header_size < block_size || header_size % block_size)
+                        throw std::runtime_error("checkpoint: corrupted header");
+                    if (header_size > block_size) {
+                        buffer = make_aligned_buffer(header_size);
+                        f.read(buffer.get(), header_size, 0, m_path);
+                    }
+                    deserializer in(buffer.get() + sizeof(magic) + sizeof(header_size), buffer.get() + header_size);
+                    auto num_records = in.get<std::uint64_t>();
+                    for (std::uint64_t i = 0; i != num_records; ++i) {
+                        checkpoint_entry entry;
+                        entry.name = in.get_string();
+                        entry.element_size = in.get<std::uint32_t>();
+                        entry.element_kind = in.get<std::uint32_t>();
+                        auto ndims = in.get<std::uint32_t>();
+                        in.get<std::uint32_t>();
+                        auto layout = in.get_vector<std::int32_t>(ndims);
+                        entry.layout.assign(layout.begin(), layout.end());
+                        entry.lengths = in.get_vector<std::uint64_t>(ndims);
+                        entry.strides = in.get_vector<std::uint64_t>(ndims);
+                        entry.length = in.get<std::uint64_t>();
+                        entry.offset = in.get<std::uint64_t>();
+                        m_entries.push_back(std::move(entry));
+                    }
+                }
+
+                std::vector<checkpoint_entry> const &entries() const { return m_entries; }
+
+                checkpoint_entry const *find(std::string const &name) const {
+                    for (auto &&entry : m_entries)
+                        if (entry.name == name)
+                            return &entry;
+                    return nullptr;
+                }
+
+                template <class DataStorePtr>
+                checkpoint_reader &add(DataStorePtr const &ds) {
+                    static_assert(is_data_store_ptr<DataStorePtr>::value, "data store pointer expected");
+                    using data_t = typename DataStorePtr::element_type::data_t;
+                    static_assert(!std::is_const<data_t>::value, "const data stores can not be restored");
+                    auto entry = find(ds->name());
+                    if (!entry)
+                        throw std::runtime_error("checkpoint: " + ds->name() + " is not found in " + m_path);
+                    if (!is_compatible(*entry, make_entry(*ds)))
+                        throw std::runtime_error(
+                            "checkpoint: the data store " + ds->name() + " doesn't match the checkpoint " + m_path);
+                    m_pending.push_back(*entry);
+                    m_memory.push_back(reinterpret_cast<char *>(ds->get_host_ptr()));
+                    return *this;
+                }
+
+                void read() {
+                    file f(m_path, O_RDONLY, m_options.direct_io);
+                    size_t chunk_size = checked_chunk_size(m_options);
+                    bool direct = f.direct();
+                    for_each_chunk(make_chunks(m_pending, m_memory, chunk_size),
+                        m_options.threads,
+                        direct ? chunk_size : 0,
+                        [&](chunk const &c, char *buffer) {
+                            if (!direct)
+                                return f.read(c.memory, c.size, c.offset, m_path);
+                            f.read(buffer, round_up(c.size), c.offset, m_path);
+                            std::memcpy(c.memory, buffer, c.size);
+                        });
+                    m_pending.clear();
+                    m_memory.clear();
+                }
+            };
+
+            template <class... DataStorePtrs>
+            void save_checkpoint(std::string path, DataStorePtrs const &... data_stores) {
+                checkpoint_writer writer(std::move(path));
+                (void)(int[]){0, (writer.add(data_stores), 0)...};
+                writer.write();
+            }
+
+            template <class... DataStorePtrs>
+            void load_checkpoint(std::string path, DataStorePtrs const &... data_stores) {
+                checkpoint_reader reader(std::move(path));
+                (void)(int[]){0, (reader.add(data_stores), 0)...};
+                reader.read();
+            }
+        } // namespace checkpoint_impl_
+
+        using checkpoint_impl_::checkpoint_entry;
+        using checkpoint_impl_::checkpoint_options;
+        using checkpoint_impl_::checkpoint_reader;
+        using checkpoint_impl_::checkpoint_writer;
+        using checkpoint_impl_::load_checkpoint;
+        using checkpoint_impl_::save_checkpoint;
+    } // namespace storage
+} // namespace gridtools
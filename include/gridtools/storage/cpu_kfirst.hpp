@@ -9,7 +9,9 @@
  */
 #pragma once
 
+#include <cstdlib>
 #include <memory>
+#include <new>
 #include <type_traits>
 
 #include "../common/integral_constant.hpp"
@@ -38,6 +40,13 @@ namespace gridtools {
             struct make_layout<N, std::index_sequence<Dim0, Dim1, Dim2, Dims...>> {
                 using type = layout_map<Dim0 + N - 3, Dim1 + N - 3, Dim2 + N - 3, (Dims - 3)...>;
             };
+
+            struct deleter {
+                template <class T>
+                void operator()(T *ptr) const {
+                    std::free(ptr);
+                }
+            };
         } // namespace cpu_kfirst_impl_
 
         struct cpu_kfirst {
@@ -51,9 +60,23 @@ namespace gridtools {
 
             friend integral_constant<size_t, 1> storage_alignment(cpu_kfirst) { return {}; }
 
-            template <class LazyType, class T = typename LazyType::type>
+            // the memory is zeroed by `calloc`: the zero pages of large allocations are mapped lazily and stay untouched
+            // until written, so that they are placed by the (possibly parallel) initialization
+            template <class LazyType,
+                class T = typename LazyType::type,
+                std::enable_if_t<std::is_trivial<T>::value, int> = 0>
+            friend auto storage_allocate(cpu_kfirst, LazyType, size_t size) {
+                auto *ptr = static_cast<T *>(std::calloc(size, sizeof(T)));
+                if (!ptr && size)
+                    throw std::bad_alloc();
+                return std::unique_ptr<T[], cpu_kfirst_impl_::deleter>(ptr);
+            }
+
+            template <class LazyType,
+                class T = typename LazyType::type,
+                std::enable_if_t<!std::is_trivial<T>::value, int> = 0>
             friend auto storage_allocate(cpu_kfirst, LazyType, size_t size) {
-                return std::make_unique<T[]>(size);
+                return std::unique_ptr<T[]>(new T[size]());
             }
         };
     } // namespace storage
@@ -12,6 +12,7 @@
 #include <memory>
 #include <string>
 #include <type_traits>
+#include <vector>
 
 #include "../common/array.hpp"
 #include "../common/array_addons.hpp"
@@ -19,6 +20,7 @@
 #include "../common/layout_map.hpp"
 #include "data_view.hpp"
 #include "info.hpp"
+#include "region.hpp"
 #include "traits.hpp"
 
 namespace gridtools {
@@ -45,6 +47,7 @@ namespace gridtools {
 
                 std::string m_name;
                 storage::info<N> m_info;
+                array<int, N> m_halos;
                 traits::target_ptr_type<Traits, mutable_data_t> m_target_ptr_holder;
                 mutable_data_t *m_target_ptr;
 
@@ -55,18 +58,22 @@ namespace gridtools {
 
                 using kind_t = meta::list<layout_t,
                     meta::if_c<(layout_t::unmasked_length > 0), Id, void>,
-                    meta::if_c<(layout_t::unmasked_length > 1), std::integral_constant<size_t, alignment>, void>>;
+                    meta::if_c<(layout_t::unmasked_length > 1), std::integral_constant<size_t, alignment>, void>,
+                    meta::if_c<(layout_t::unmasked_length > 1), traits::padding_type<Traits>, void>>;
 
                 auto const &name() const { return m_name; }
                 auto const &info() const { return m_info; }
+                auto const &halos() const { return m_halos; }
                 auto const &lengths() const { return m_info.lengths(); }
                 auto const &strides() const { return m_info.strides(); }
                 auto length() const { return m_info.length(); }
 
               protected:
                 base(std::string name, array<uint_t, N> const &lengths, array<int, N> const &halos)
-                    : m_name(std::move(name)), m_info(layout_t(), alignment, lengths),
-                      m_target_ptr_holder(traits::allocate<Traits, mutable_data_t>(m_info.length() + alignment)) {
+                    : m_name(std::move(name)),
+                      m_info(layout_t(), alignment, lengths, traits::padding_type<Traits>(), sizeof(T)), m_halos(halos),
+                      m_target_ptr_holder(
+                          traits::allocate<Traits, mutable_data_t>(m_info.length() + alignment, m_name)) {
                     auto offset_to_align = m_info.index(halos);
                     auto byte_offset = offset_to_align * sizeof(T);
                     auto address_to_align = reinterpret_cast<std::uintptr_t>(m_target_ptr_holder.get()) + byte_offset;
@@ -85,27 +92,61 @@ namespace gridtools {
                 bool = traits::is_host_referenceable<Traits>>
             class data_store_impl;
 
+            /**
+             *  The host and the target copies are tracked with a three state flag. The outdated side is either
+             *  entirely invalid or only in the regions that were declared by the region taking accessors
+             *  (`get_host_ptr(region)`, `host_view(region)`, etc.). In the latter case the synchronization copies only
+             *  these regions. The list of regions is bounded, beyond `max_dirty_regions` the whole side is outdated.
+             */
             template <class Traits, class T, size_t N, class Id>
             class data_store_impl<Traits, T, N, Id, false, false> : public base<Traits, T, N, Id> {
                 enum state { synced, invalid_host, invalid_target };
                 state m_state;
+                std::vector<region<N>> m_dirty_regions;
                 std::unique_ptr<T[]> m_host_ptr;
 
+                template <class Copy>
+                void copy(Copy &&copy) {
+                    if (m_dirty_regions.empty())
+                        return copy(size_t(0), size_t(this->info().length()));
+                    for (auto &&r : m_dirty_regions)
+                        region_impl_::for_each_run(typename data_store_impl::layout_t(), this->info(), r, copy);
+                    m_dirty_regions.clear();
+                }
+
                 void update_target() {
                     if (m_state != invalid_target)
                         return;
-                    traits::update_target<Traits>(this->raw_target_ptr(), m_host_ptr.get(), this->info().length());
+                    copy([&](size_t offset, size_t size) {
+                        traits::update_target<Traits>(this->raw_target_ptr() + offset, m_host_ptr.get() + offset, size);
+                    });
                     m_state = synced;
                 }
 
                 void update_host() {
                     if (m_state != invalid_host)
                         return;
-                    traits::update_host<Traits>(m_host_ptr.get(), this->raw_target_ptr(), this->info().length());
+                    copy([&](size_t offset, size_t size) {
+                        traits::update_host<Traits>(m_host_ptr.get() + offset, this->raw_target_ptr() + offset, size);
+                    });
                     m_state = synced;
                 }
 
+                void invalidate(state s) {
+                    m_state = s;
+                    m_dirty_regions.clear();
+                }
+
+                void invalidate(state s, region<N> const &r) {
+                    if (m_state == s && (m_dirty_regions.empty() || m_dirty_regions.size() == max_dirty_regions))
+                        return invalidate(s);
+                    m_state = s;
+                    m_dirty_regions.push_back(r);
+                }
+
               public:
+                static constexpr size_t max_dirty_regions = 16;
+
                 data_store_impl(std::string name,
                     array<uint_t, N> const &lengths,
                     array<int, N> const &halos,
@@ -125,7 +166,16 @@ namespace gridtools {
 
                 T *get_target_ptr() {
                     update_target();
-                    m_state = invalid_host;
+                    invalidate(invalid_host);
+                    return this->raw_target_ptr();
+                }
+
+                /**
+                 *  Only the region `r` of the target copy is going to be modified.
+                 */
+                T *get_target_ptr(region<N> const &r) {
+                    update_target();
+                    invalidate(invalid_host, r);
                     return this->raw_target_ptr();
                 }
 
@@ -136,7 +186,16 @@ namespace gridtools {
 
                 T *get_host_ptr() {
                     update_host();
-                    m_state = invalid_target;
+                    invalidate(invalid_target);
+                    return m_host_ptr.get();
+                }
+
+                /**
+                 *  Only the region `r` of the host copy is going to be modified.
+                 */
+                T *get_host_ptr(region<N> const &r) {
+                    update_host();
+                    invalidate(invalid_target, r);
                     return m_host_ptr.get();
                 }
 
@@ -146,9 +205,13 @@ namespace gridtools {
                 }
 
                 auto host_view() { return make_host_view(get_host_ptr(), this->info()); }
+                auto host_view(region<N> const &r) { return make_host_view(get_host_ptr(r), this->info()); }
                 auto const_host_view() { return make_host_view(get_const_host_ptr(), this->info()); }
 
                 auto target_view() { return traits::make_target_view<Traits>(get_target_ptr(), this->info()); }
+                auto target_view(region<N> const &r) {
+                    return traits::make_target_view<Traits>(get_target_ptr(r), this->info());
+                }
                 auto const_target_view() {
                     return traits::make_target_view<Traits>(get_const_target_ptr(), this->info());
                 }
@@ -184,6 +247,12 @@ namespace gridtools {
                 T const *get_const_host_ptr() { return get_const_target_ptr(); }
                 auto host_view() const { return target_view(); }
                 auto const_host_view() const { return const_target_view(); }
+
+                // there is nothing to track if the host and the target memory is the same
+                T *get_target_ptr(region<N> const &) const { return get_target_ptr(); }
+                T *get_host_ptr(region<N> const &) { return get_target_ptr(); }
+                auto target_view(region<N> const &) const { return target_view(); }
+                auto host_view(region<N> const &) const { return target_view(); }
             };
 
             template <class Traits, class T, size_t N, class Id, bool IsHostRefrenceable>
@@ -49,6 +49,25 @@ namespace gridtools {
                 return {make_stride(layout, LayoutArgs, padded_lengths)...};
             }
 
+            template <int... Dims, int... LayoutArgs, class Array, class Padding>
+            Array make_strides(layout_map<LayoutArgs...> layout,
+                uint_t align,
+                Array const &lengths,
+                Padding const &padding,
+                size_t element_size) {
+                using layout_t = layout_map<LayoutArgs...>;
+                Array res = make_strides<Dims...>(layout, align, lengths);
+                // the strides are recomputed from the inner most to the outer most dimension
+                for (int arg = layout_t::max_arg - 1; arg >= 0; --arg) {
+                    int inner = layout_t::find(arg + 1);
+                    uint_t stride = res[inner] * make_padded_length(layout, arg + 1, align, lengths[inner]);
+                    res[layout_t::find(arg)] = padding(stride, element_size, align);
+                }
+                return res;
+            }
+
+            constexpr uint_t gcd(uint_t a, uint_t b) { return b == 0 ? a : gcd(b, a % b); }
+
             template <class>
             struct base;
 
@@ -74,6 +93,20 @@ namespace gridtools {
                       m_length(accumulate(logical_and(), true, m_lengths[Dims]...) ? index((m_lengths[Dims] - 1)...) + 1
                                                                                    : 0) {}
 
+                /**
+                 *  The strides of the outer dimensions are adjusted by the `Padding` policy, see `anti_aliasing`.
+                 */
+                template <int... LayoutArgs, class Padding>
+                base(layout_map<LayoutArgs...> layout,
+                    uint_t align,
+                    array_t const &lengths,
+                    Padding const &padding,
+                    size_t element_size)
+                    : m_lengths(lengths),
+                      m_strides(make_strides<Dims...>(layout, align, m_lengths, padding, element_size)),
+                      m_length(accumulate(logical_and(), true, m_lengths[Dims]...) ? index((m_lengths[Dims] - 1)...) + 1
+                                                                                   : 0) {}
+
                 GT_FUNCTION GT_CONSTEXPR auto const &lengths() const { return m_lengths; }
                 GT_FUNCTION GT_CONSTEXPR auto const &strides() const { return m_strides; }
 
@@ -85,19 +118,50 @@ namespace gridtools {
                     return index(indices[Dims]...);
                 }
 
+                // the indices are peeled off from the outer most dimension, the strides of the outer dimensions are
+                // not necessarily multiples of the inner ones if padded
                 template <int... LayoutArgs>
                 GT_FUNCTION GT_CONSTEXPR array_t indices(layout_map<LayoutArgs...>, uint_t index) const {
-                    return {(LayoutArgs == -1
-                                 ? m_lengths[Dims] - 1
-                                 : LayoutArgs ? index % m_strides[layout_map<LayoutArgs...>::find(LayoutArgs - 1)] /
-                                                    m_strides[Dims]
-                                              : index / m_strides[Dims])...};
+                    using layout_t = layout_map<LayoutArgs...>;
+                    array_t res = {(LayoutArgs == -1 ? m_lengths[Dims] - 1 : 0)...};
+                    for (int arg = 0; arg <= layout_t::max_arg; ++arg) {
+                        int dim = layout_t::find(arg);
+                        res[dim] = index / m_strides[dim];
+                        index %= m_strides[dim];
+                    }
+                    return res;
                 }
 
                 GT_FUNCTION GT_CONSTEXPR auto length() const { return m_length; }
             };
         } // namespace info_impl_
 
+        /**
+         *  The default padding policy: only the inner most dimension is padded to the alignment.
+         */
+        struct no_padding {
+            uint_t operator()(uint_t stride, size_t, uint_t) const { return stride; }
+        };
+
+        /**
+         *  Pads the strides of the outer dimensions to an odd number of cache lines. Thereby the neighbouring rows and
+         *  planes of a storage don't map to the same cache sets and their distances are never multiples of 4 KiB, which
+         *  is the case for the power of two domains otherwise. The strides shorter than 16 cache lines are left as they
+         *  are, hence the memory overhead is below 1/16.
+         */
+        struct anti_aliasing {
+            static constexpr uint_t cache_line_size = 64;
+
+            uint_t operator()(uint_t stride, size_t element_size, uint_t align) const {
+                // the smallest number of elements that is a multiple of the cache line and of the alignment
+                uint_t line = cache_line_size / info_impl_::gcd(element_size, cache_line_size);
+                uint_t unit = line / info_impl_::gcd(line, align) * align;
+                if (stride < 16 * unit)
+                    return stride;
+                return ((stride + unit - 1) / unit | 1) * unit;
+            }
+        };
+
         template <size_t N>
         struct info : info_impl_::base<std::make_index_sequence<N>> {
             using info_impl_::base<std::make_index_sequence<N>>::base;
@@ -0,0 +1,107 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+#include "cpu_kfirst.hpp"
+#include "data_view.hpp"
+#include "traits.hpp"
+
+/**
+ *  @file
+ *  Storage traits that emulate a separate target memory space on the host.
+ *
+ *  `mirror<Base>` takes the layout, the alignment and the allocation from `Base`, but is not host referenceable: the
+ *  data stores keep a separate host copy and synchronize it with `memcpy`. The transfers are counted, which makes the
+ *  host/target synchronization logic testable without a GPU.
+ */
+
+namespace gridtools {
+    namespace storage {
+        struct mirror_statistics {
+            std::size_t to_target_copies;
+            std::size_t to_target_bytes;
+            std::size_t to_host_copies;
+            std::size_t to_host_bytes;
+        };
+
+        namespace mirror_impl_ {
+            struct counters {
+                std::atomic<std::size_t> to_target_copies{0};
+                std::atomic<std::size_t> to_target_bytes{0};
+                std::atomic<std::size_t> to_host_copies{0};
+                std::atomic<std::size_t> to_host_bytes{0};
+            };
+
+            inline counters &get_counters() {
+                static counters res;
+                return res;
+            }
+        } // namespace mirror_impl_
+
+        inline mirror_statistics get_mirror_statistics() {
+            auto &&c = mirror_impl_::get_counters();
+            return {c.to_target_copies, c.to_target_bytes, c.to_host_copies, c.to_host_bytes};
+        }
+
+        inline void reset_mirror_statistics() {
+            auto &&c = mirror_impl_::get_counters();
+            c.to_target_copies = 0;
+            c.to_target_bytes = 0;
+            c.to_host_copies = 0;
+            c.to_host_bytes = 0;
+        }
+
+        template <class Base = cpu_kfirst>
+        struct mirror {
+            static_assert(traits::is_host_referenceable<Base>, "mirror requires host referenceable base traits");
+
+            friend std::false_type storage_is_host_referenceable(mirror) { return {}; }
+
+            template <size_t Dims>
+            friend decltype(storage_layout(Base(), std::integral_constant<size_t, Dims>())) storage_layout(
+                mirror, std::integral_constant<size_t, Dims>) {
+                return {};
+            }
+
+            friend decltype(storage_alignment(Base())) storage_alignment(mirror) { return {}; }
+
+            template <class LazyType, class T = typename LazyType::type>
+            friend auto storage_allocate(mirror, LazyType, size_t size) {
+                return traits::allocate<Base, T>(size);
+            }
+
+            template <class T>
+            friend void storage_update_target(mirror, T *dst, T const *src, size_t size) {
+                std::memcpy(dst, src, size * sizeof(T));
+                auto &&c = mirror_impl_::get_counters();
+                ++c.to_target_copies;
+                c.to_target_bytes += size * sizeof(T);
+            }
+
+            template <class T>
+            friend void storage_update_host(mirror, T *dst, T const *src, size_t size) {
+                std::memcpy(dst, src, size * sizeof(T));
+                auto &&c = mirror_impl_::get_counters();
+                ++c.to_host_copies;
+                c.to_host_bytes += size * sizeof(T);
+            }
+
+            template <class T, size_t N>
+            friend host_view<T, N> storage_make_target_view(mirror, T *ptr, info<N> const &info) {
+                return make_host_view(ptr, info);
+            }
+        };
+    } // namespace storage
+} // namespace gridtools
@@ -0,0 +1,196 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "cpu_kfirst.hpp"
+#include "traits.hpp"
+
+/**
+ *  @file
+ *  File backed storage traits.
+ *
+ *  `mmap_file<Base>` takes the layout and the alignment from `Base` and maps the target memory of a named data store
+ *  from the file `<directory>/<name>`. A new (or empty) file is resized to the size of the data store, an existing
+ *  one is mapped as is, so that its content becomes the content of the data store. The file holds the raw target
+ *  memory of the data store (including the padding), it can be reused by the data stores with the same type, traits,
+ *  dimensions and halos. The writes go to the file (`MAP_SHARED`), the files that can not be opened for writing are
+ *  mapped copy-on-write. The unnamed data stores get an anonymous mapping.
+ *
+ *  The pages are loaded by the OS on the first access and evicted under the memory pressure, so the fields can be
+ *  larger than the physical memory. Note that the initializers of the builder overwrite the file content, the data
+ *  stores that should be read from a prepared file have to be created without an initializer.
+ *
+ *  The directory is taken from the environment variable `GT_MMAP_DIR` (the working directory by default). If
+ *  `GT_MMAP_HUGEPAGES` is set to a nonzero value, the mappings are advised to use transparent huge pages.
+ *  Both can be changed by `set_mmap_directory` and `set_mmap_huge_pages`.
+ */
+
+namespace gridtools {
+    namespace storage {
+        namespace mmap_file_impl_ {
+            inline std::string default_directory() {
+                char const *env = std::getenv("GT_MMAP_DIR");
+                return env && *env ? env : ".";
+            }
+
+            inline bool default_huge_pages() {
+                char const *env = std::getenv("GT_MMAP_HUGEPAGES");
+                return env && std::atoi(env) != 0;
+            }
+
+            struct config {
+                std::mutex mutex;
+                std::string directory = default_directory();
+                bool huge_pages = default_huge_pages();
+            };
+
+            inline config &get_config() {
+                static config res;
+                return res;
+            }
+
+            inline std::string get_mmap_directory() {
+                auto &cfg = get_config();
+                std::lock_guard<std::mutex> lock(cfg.mutex);
+                return cfg.directory;
+            }
+
+            inline void set_mmap_directory(std::string directory) {
+                auto &cfg = get_config();
+                std::lock_guard<std::mutex> lock(cfg.mutex);
+                cfg.directory = std::move(directory);
+            }
+
+            inline bool get_mmap_huge_pages() {
+                auto &cfg = get_config();
+                std::lock_guard<std::mutex> lock(cfg.mutex);
+                return cfg.huge_pages;
+            }
+
+            inline void set_mmap_huge_pages(bool value) {
+                auto &cfg = get_config();
+                std::lock_guard<std::mutex> lock(cfg.mutex);
+                cfg.huge_pages = value;
+            }
+
+            [[noreturn]] inline void fail(std::string const &what, std::string const &path) {
+                throw std::runtime_error("mmap_file: " + what + " " + path + ": " + std::strerror(errno));
+            }
+
+            // maps `bytes` bytes of the file with the given name or anonymous memory if the name is empty
+            inline void *map(size_t bytes, std::string const &name) {
+                void *res;
+                if (name.empty()) {
+                    res = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                    if (res == MAP_FAILED)
+                        fail("failed to map", "anonymous memory");
+                } else {
+                    auto path = get_mmap_directory() + "/" + name;
+                    int flags = MAP_SHARED;
+                    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+                    if (fd < 0 && errno == EACCES) {
+                        flags = MAP_PRIVATE;
+                        fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+                    }
+                    if (fd < 0)
+                        fail("failed to open", path);
+                    struct stat st;
+                    if (fstat(fd, &st) != 0) {
+                        close(fd);
+                        fail("failed to stat", path);
+                    }
+                    if (st.st_size == 0 && flags == MAP_SHARED) {
+                        if (ftruncate(fd, bytes) != 0) {
+                            close(fd);
+                            fail("failed to resize", path);
+                        }
+                    } else if (size_t(st.st_size) != bytes) {
+                        close(fd);
+                        throw std::runtime_error("mmap_file: the size of " + path + " is " +
+                                                 std::to_string(st.st_size) + " bytes, " + std::to_string(bytes) +
+                                                 " bytes are expected");
+                    }
+                    res = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, flags, fd, 0);
+                    close(fd);
+                    if (res == MAP_FAILED)
+                        fail("failed to map", path);
+                }
+#ifdef MADV_HUGEPAGE
+                // only an advice: the error (e.g. no huge page support for the file system) is ignored
+                if (get_mmap_huge_pages())
+                    madvise(res, bytes, MADV_HUGEPAGE);
+#endif
+                return res;
+            }
+
+            struct unmap_f {
+                size_t m_bytes;
+
+                template <class T>
+                void operator()(T *ptr) const {
+                    munmap(const_cast<std::remove_cv_t<T> *>(ptr), m_bytes);
+                }
+            };
+
+            template <class T>
+            std::unique_ptr<T[], unmap_f> allocate(size_t size, std::string const &name) {
+                static_assert(std::is_trivially_copyable<T>::value, "mmap_file requires trivially copyable types");
+                // mmap doesn't accept zero length
+                size_t bytes = size ? size * sizeof(T) : 1;
+                return {static_cast<T *>(map(bytes, name)), unmap_f{bytes}};
+            }
+        } // namespace mmap_file_impl_
+
+        using mmap_file_impl_::get_mmap_directory;
+        using mmap_file_impl_::get_mmap_huge_pages;
+        using mmap_file_impl_::set_mmap_directory;
+        using mmap_file_impl_::set_mmap_huge_pages;
+
+        template <class Base = cpu_kfirst>
+        struct mmap_file {
+            static_assert(traits::is_host_referenceable<Base>, "mmap_file requires host referenceable base traits");
+
+            friend std::true_type storage_is_host_referenceable(mmap_file) { return {}; }
+
+            template <size_t Dims>
+            friend decltype(storage_layout(Base(), std::integral_constant<size_t, Dims>())) storage_layout(
+                mmap_file, std::integral_constant<size_t, Dims>) {
+                return {};
+            }
+
+            friend decltype(storage_alignment(Base())) storage_alignment(mmap_file) { return {}; }
+
+            template <class LazyType, class T = typename LazyType::type>
+            friend auto storage_allocate(mmap_file, LazyType, size_t size) {
+                return mmap_file_impl_::allocate<T>(size, "");
+            }
+
+            template <class LazyType, class T = typename LazyType::type>
+            friend auto storage_allocate(mmap_file, LazyType, size_t size, std::string const &name) {
+                return mmap_file_impl_::allocate<T>(size, name);
+            }
+        };
+    } // namespace storage
+} // namespace gridtools
@@ -0,0 +1,90 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+#include "../common/hugepage_alloc.hpp"
+#include "../common/integral_constant.hpp"
+#include "../sid/allocator.hpp"
+#include "cpu_ifirst.hpp"
+#include "traits.hpp"
+
+/**
+ *  @file
+ *  Pooled storage traits.
+ *
+ *  `pooled<Base>` takes the layout, the alignment and the padding from `Base` and allocates the target memory from the
+ *  pool of `sid::pooled_allocator`. A freed block is stashed in the pool and reused by the next data store that fits
+ *  into it, independently of the builder, the element type and the dimensions. Thereby the data stores that are built
+ *  and discarded repeatedly don't hit the system allocator in the steady state. The blocks are allocated by
+ *  `hugepage_alloc`.
+ *
+ *  The blocks count towards the limit of the pool (`sid::set_pool_limit`) and show up in `sid::get_pool_stats`,
+ *  `sid::release_pooled_memory` frees them.
+ */
+
+namespace gridtools {
+    namespace storage {
+        namespace pooled_impl_ {
+            struct allocation_f {
+                std::unique_ptr<void, GT_INTEGRAL_CONSTANT_FROM_VALUE(&hugepage_free)> operator()(
+                    std::size_t size) const {
+                    return {hugepage_alloc(size), {}};
+                }
+            };
+
+            using proxy_t = sid::allocator_impl_::pooled_proxy_f<allocation_f>;
+            using block_t = decltype(proxy_t()(0));
+
+            // returns the block to the pool
+            struct deleter {
+                typename block_t::deleter_type m_impl;
+
+                template <class T>
+                void operator()(T *ptr) const {
+                    if (ptr)
+                        m_impl(const_cast<std::remove_cv_t<T> *>(ptr));
+                }
+            };
+
+            template <class T>
+            std::unique_ptr<T[], deleter> allocate(std::size_t size) {
+                auto block = proxy_t()(size * sizeof(T));
+                deleter d = {block.get_deleter()};
+                return {static_cast<T *>(block.release()), d};
+            }
+        } // namespace pooled_impl_
+
+        template <class Base = cpu_ifirst>
+        struct pooled {
+            static_assert(traits::is_host_referenceable<Base>, "pooled requires host referenceable base traits");
+
+            friend std::true_type storage_is_host_referenceable(pooled) { return {}; }
+
+            template <size_t Dims>
+            friend decltype(storage_layout(Base(), std::integral_constant<size_t, Dims>())) storage_layout(
+                pooled, std::integral_constant<size_t, Dims>) {
+                return {};
+            }
+
+            friend decltype(storage_alignment(Base())) storage_alignment(pooled) { return {}; }
+
+            friend traits::padding_type<Base> storage_padding(pooled) { return {}; }
+
+            template <class LazyType, class T = typename LazyType::type>
+            friend auto storage_allocate(pooled, LazyType, size_t size) {
+                return pooled_impl_::allocate<T>(size);
+            }
+        };
+    } // namespace storage
+} // namespace gridtools
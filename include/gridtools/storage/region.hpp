@@ -0,0 +1,119 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+#include "../common/array.hpp"
+#include "../common/defs.hpp"
+#include "info.hpp"
+
+/**
+ *  @file
+ *  Regions of data stores: the boxes `[lower, upper)` in the storage index space. They are used to declare which part
+ *  of a data store is modified on the host or on the target side, so that the synchronization copies only that part.
+ */
+
+namespace gridtools {
+    namespace storage {
+        template <size_t N>
+        struct region {
+            array<int, N> lower;
+            array<int, N> upper;
+        };
+
+        enum class side { lower, upper };
+
+        /**
+         *  The whole data store.
+         */
+        template <class DataStore>
+        region<DataStore::ndims> whole_region(DataStore const &ds) {
+            region<DataStore::ndims> res;
+            for (size_t d = 0; d != DataStore::ndims; ++d) {
+                res.lower[d] = 0;
+                res.upper[d] = ds.lengths()[d];
+            }
+            return res;
+        }
+
+        /**
+         *  The levels `[begin, end)` of the dimension `dim` (the vertical one by default).
+         */
+        template <class DataStore>
+        region<DataStore::ndims> slab_region(DataStore const &ds, int begin, int end, size_t dim = 2) {
+            auto res = whole_region(ds);
+            res.lower[dim] = begin;
+            res.upper[dim] = end;
+            return res;
+        }
+
+        /**
+         *  The halo of the data store (as given to the builder) at the lower or the upper side of the dimension `dim`.
+         */
+        template <class DataStore>
+        region<DataStore::ndims> halo_region(DataStore const &ds, size_t dim, side s) {
+            int halo = ds.halos()[dim];
+            int length = ds.lengths()[dim];
+            return s == side::lower ? slab_region(ds, 0, halo, dim) : slab_region(ds, length - halo, length, dim);
+        }
+
+        namespace region_impl_ {
+            /**
+             *  Calls `fun(offset, size)` for the contiguous memory runs that cover the region, in the increasing order
+             *  of the offsets. The adjacent runs are merged; if the region spans the inner most dimension, the runs
+             *  include the padding, so that the region made of whole rows or planes is covered by few large runs.
+             */
+            template <class Layout, size_t N, class Fun>
+            void for_each_run(Layout, info<N> const &info, region<N> const &r, Fun &&fun) {
+                auto &&lengths = info.lengths();
+                auto &&strides = info.strides();
+                array<int, N> lo, hi;
+                for (size_t d = 0; d != N; ++d) {
+                    lo[d] = Layout::at(d) < 0 ? 0 : std::max(r.lower[d], 0);
+                    hi[d] = Layout::at(d) < 0 ? 1 : std::min(r.upper[d], (int)lengths[d]);
+                    if (lo[d] >= hi[d])
+                        return;
+                }
+                if (Layout::unmasked_length == 0)
+                    return fun(size_t(0), size_t(1));
+                int inner = Layout::find(Layout::max_arg);
+                size_t run = hi[inner] - lo[inner];
+                if (Layout::max_arg > 0 && lo[inner] == 0 && hi[inner] == (int)lengths[inner])
+                    run = strides[Layout::find(Layout::max_arg - 1)];
+                size_t begin = 0, end = 0;
+                auto indices = lo;
+                while (true) {
+                    size_t offset = info.index(indices);
+                    size_t last = std::min<size_t>(offset + run, info.length());
+                    if (end != 0 && offset == end) {
+                        end = last;
+                    } else {
+                        if (end != 0)
+                            fun(begin, end - begin);
+                        begin = offset;
+                        end = last;
+                    }
+                    int arg = Layout::max_arg - 1;
+                    for (; arg >= 0; --arg) {
+                        int d = Layout::find(arg);
+                        if (++indices[d] < hi[d])
+                            break;
+                        indices[d] = lo[d];
+                    }
+                    if (arg < 0)
+                        break;
+                }
+                fun(begin, end - begin);
+            }
+        } // namespace region_impl_
+    }     // namespace storage
+} // namespace gridtools
@@ -22,7 +22,9 @@
 #include "../meta/if.hpp"
 #include "../meta/macros.hpp"
 #include "../meta/make_indices.hpp"
+#include "../meta/pop_back.hpp"
 #include "../meta/transform.hpp"
+#include "bundle.hpp"
 #include "data_store.hpp"
 
 namespace gridtools {
@@ -180,5 +182,55 @@ namespace gridtools {
             using generators_t = meta::transform<storage_sid_impl_::upper_bound_generator_f, keys_t>;
             return tuple_util::generate<generators_t, res_t>(ds->lengths());
         }
+
+        /**
+         *   The fields of a bundle model `SID` as well. They are the bundle data store without the last dimension,
+         *   shifted by the field number. The fields of the same bundle share the strides kind.
+         */
+        namespace storage_sid_impl_ {
+            struct bundle_field_tag;
+
+            template <class DataStore,
+                class Value,
+                class Layout = typename DataStore::layout_t,
+                class Dims = meta::pop_back<get_unmasked_dims<Layout>>,
+                class Values = meta::repeat_c<Layout::unmasked_length - 1, Value>>
+            using bundle_bounds_type = hymap::from_keys_values<Dims, Values>;
+        } // namespace storage_sid_impl_
+
+        template <class DataStore, size_t I>
+        storage_sid_impl_::ptr_holder<typename DataStore::data_t> sid_get_origin(
+            bundle_field<DataStore, I> const &field) {
+            auto &&ds = field.data_store();
+            return {ds->get_target_ptr() + I * ds->strides()[DataStore::ndims - 1]};
+        }
+
+        template <class DataStore, size_t I>
+        auto sid_get_strides(bundle_field<DataStore, I> const &field) {
+            auto &&ds = field.data_store();
+            using convert_strides_t = storage_sid_impl_::convert_strides_f<typename DataStore::layout_t>;
+            return tuple_util::pop_back(convert_strides_t()(ds->strides()));
+        }
+
+        template <class DataStore, size_t I>
+        meta::list<typename DataStore::kind_t, storage_sid_impl_::bundle_field_tag> sid_get_strides_kind(
+            bundle_field<DataStore, I> const &);
+
+        template <class DataStore, size_t I>
+        int_t sid_get_ptr_diff(bundle_field<DataStore, I> const &);
+
+        template <class DataStore, size_t I>
+        storage_sid_impl_::bundle_bounds_type<DataStore, integral_constant<int_t, 0>> sid_get_lower_bounds(
+            bundle_field<DataStore, I> const &) {
+            return {};
+        }
+
+        template <class DataStore, size_t I>
+        auto sid_get_upper_bounds(bundle_field<DataStore, I> const &field) {
+            using res_t = storage_sid_impl_::bundle_bounds_type<DataStore, int_t>;
+            using keys_t = get_keys<res_t>;
+            using generators_t = meta::transform<storage_sid_impl_::upper_bound_generator_f, keys_t>;
+            return tuple_util::generate<generators_t, res_t>(field.data_store()->lengths());
+        }
     } // namespace storage
 } // namespace gridtools
@@ -9,6 +9,7 @@
  */
 #pragma once
 
+#include <string>
 #include <type_traits>
 
 #include "../meta.hpp"
@@ -18,7 +19,24 @@
 namespace gridtools {
     namespace storage {
         namespace traits {
-            namespace impl_ {}
+            namespace impl_ {
+                template <class Traits, class T>
+                auto allocate(size_t size, std::string const &name, int)
+                    -> decltype(storage_allocate(Traits(), meta::lazy::id<T>(), size, name)) {
+                    return storage_allocate(Traits(), meta::lazy::id<T>(), size, name);
+                }
+
+                template <class Traits, class T>
+                auto allocate(size_t size, std::string const &, long) {
+                    return storage_allocate(Traits(), meta::lazy::id<T>(), size);
+                }
+
+                template <class Traits>
+                auto padding(int) -> decltype(storage_padding(std::declval<Traits>()));
+
+                template <class Traits>
+                no_padding padding(long);
+            } // namespace impl_
 
             template <class Traits>
             constexpr bool is_host_referenceable =
@@ -31,11 +49,26 @@ namespace gridtools {
             using layout_type =
                 decltype(storage_layout(std::declval<Traits>(), std::integral_constant<size_t, Dims>()));
 
+            /**
+             *  The stride padding policy, `no_padding` unless the traits define `storage_padding(Traits)`.
+             */
+            template <class Traits>
+            using padding_type = decltype(impl_::padding<Traits>(0));
+
             template <class Traits, class T>
             auto allocate(size_t size) {
                 return storage_allocate(Traits(), meta::lazy::id<T>(), size);
             }
 
+            /**
+             *  The traits that define `storage_allocate(Traits, LazyType, size_t, std::string const &)` receive the
+             *  name of the data store.
+             */
+            template <class Traits, class T>
+            auto allocate(size_t size, std::string const &name) {
+                return impl_::allocate<Traits, T>(size, name, 0);
+            }
+
             template <class Traits, class T>
             using target_ptr_type = decltype(allocate<Traits, T>(0));
 
@@ -25,6 +25,10 @@
  *     thread_pool_parallel_for_loop(pool, func, lim0, lim1, lim2);
  *     etc.
  *   They are optional and could be provided for performance reasons.
+ *
+ *   Optionally the number of threads that are used by the loops started from the calling thread can be limited:
+ *     thread_pool_set_num_threads(pool, num_threads);
+ *   By default it is a no-op.
  */
 
 #include <tuple>
@@ -57,6 +61,19 @@ namespace gridtools {
                     stride_util::total_size(lims));
             }
 
+            template <class T>
+            auto set_num_threads(T const &obj, int num_threads, int) -> decltype(thread_pool_set_num_threads(obj, 0)) {
+                return thread_pool_set_num_threads(obj, num_threads);
+            }
+
+            template <class T>
+            void set_num_threads(T const &, int, long) {}
+
+            template <class T>
+            void set_num_threads(T const &obj, int num_threads) {
+                set_num_threads(obj, num_threads, 0);
+            }
+
             template <class T, class F, class... Dims>
             auto parallel_for_loop(T const &obj, F const &f, Dims... limits)
                 -> decltype(thread_pool_parallel_for_loop(obj, f, limits...)) {
@@ -67,5 +84,6 @@ namespace gridtools {
         using concept_impl_::get_max_threads;
         using concept_impl_::get_thread_num;
         using concept_impl_::parallel_for_loop;
+        using concept_impl_::set_num_threads;
     } // namespace thread_pool
 } // namespace gridtools
\ No newline at end of file
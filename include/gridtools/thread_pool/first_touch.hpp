@@ -0,0 +1,57 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+
+#include "concept.hpp"
+
+namespace gridtools {
+    namespace thread_pool {
+        /**
+         *  Zeroes the buffer in `get_max_threads(pool)` equal contiguous slabs, the slab `n` is written by the `n`th
+         *  iteration of a parallel loop. With a static schedule that is the thread `n`, so on first touch NUMA systems
+         *  the pages of a buffer with per thread slabs (thread stride outermost) are mapped to the owning threads.
+         *  Pages that straddle two slabs end up on the node of one of them.
+         */
+        template <class ThreadPool>
+        void first_touch(ThreadPool, void *ptr, std::size_t size) {
+            std::size_t slabs = get_max_threads(ThreadPool());
+            auto slab = [=](std::size_t n) { return size * n / slabs; };
+            parallel_for_loop(
+                ThreadPool(),
+                [&](auto n) {
+                    std::memset(static_cast<char *>(ptr) + slab(n), 0, slab(n + 1) - slab(n));
+                },
+                slabs);
+        }
+
+        /**
+         *  Allocation functor for `sid::allocator`: the allocated memory is first touched by the threads of the pool.
+         *  The placement depends on the number of threads, `sid::pooled_allocator` reuses the buffers only for the
+         *  same size and number of threads.
+         */
+        template <class ThreadPool>
+        struct first_touch_allocation_f {
+            std::unique_ptr<char[]> operator()(std::size_t size) const {
+                std::unique_ptr<char[]> res(new char[size]);
+                first_touch(ThreadPool(), res.get(), size);
+                return res;
+            }
+
+            friend std::size_t allocation_placement(first_touch_allocation_f) {
+                return get_max_threads(ThreadPool());
+            }
+        };
+    } // namespace thread_pool
+} // namespace gridtools
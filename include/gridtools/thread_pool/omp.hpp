@@ -20,6 +20,7 @@ namespace gridtools {
 #ifdef _OPENMP
             friend auto thread_pool_get_thread_num(omp) { return omp_get_thread_num(); }
             friend auto thread_pool_get_max_threads(omp) { return omp_get_max_threads(); }
+            friend void thread_pool_set_num_threads(omp, int num_threads) { omp_set_num_threads(num_threads); }
 
             template <class F, class I>
             friend void thread_pool_parallel_for_loop(omp, F const &f, I lim) {
@@ -0,0 +1,378 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/*
+ *  Thread pool with persistent workers and work stealing.
+ *
+ *  The workers are started on the first use and live until the end of the program. A parallel loop distributes
+ *  equal slices of the iteration space to the workers (the calling thread is worker zero). Each worker splits its
+ *  slice in halves, keeps the lower half and pushes the upper half to its Chase-Lev deque. Idle workers steal the
+ *  largest pending range from the other deques. The iteration space of multidimensional loops is linearized, but
+ *  the index is decoded only once per range and then incremented.
+ *
+ *  The number of workers is given by the environment variable `GT_NUM_THREADS` or is the hardware concurrency.
+ *  Nested parallel loops are executed serially by the calling worker. The loops that are started concurrently from
+ *  different threads are serialized. To run them side by side, `set_num_threads(work_stealing(), n)` with `n` smaller
+ *  than the number of workers gives the calling thread its own pool of `n` workers (the calling thread included) that
+ *  is used by the loops started from this thread.
+ *
+ *  If the loop body throws, the remaining ranges are dropped without being executed and the first exception is
+ *  rethrown on the calling thread once all the workers have left the loop.
+ *
+ *  If the environment variable `GT_PIN_THREADS` is set to a non-zero value, the worker `n` is pinned to the `n`th
+ *  processor of the affinity mask of the process (on Linux). The calling thread is not pinned. Together with the
+ *  first touch initialization of the storages this keeps the data of a block on the node of the thread that
+ *  computes it.
+ */
+
+namespace gridtools {
+    namespace thread_pool {
+        namespace work_stealing_impl_ {
+            struct range {
+                std::int64_t begin;
+                std::int64_t end;
+            };
+
+            /*
+             *  Bounded Chase-Lev deque following "Correct and Efficient Work-Stealing for Weak Memory Models"
+             *  by Lê et al. The owner pushes and takes at the bottom, the thieves steal at the top.
+             *  The ranges are split in halves, so the capacity bounds the logarithm of the iteration count.
+             */
+            class deque {
+                static constexpr std::int64_t capacity = 128;
+
+                struct slot {
+                    std::atomic<std::int64_t> begin;
+                    std::atomic<std::int64_t> end;
+                };
+
+                alignas(64) std::atomic<std::int64_t> m_top{0};
+                alignas(64) std::atomic<std::int64_t> m_bottom{0};
+                slot m_slots[capacity];
+
+                range load(std::int64_t i) const {
+                    auto &s = m_slots[i % capacity];
+                    return {s.begin.load(std::memory_order_relaxed), s.end.load(std::memory_order_relaxed)};
+                }
+
+              public:
+                void push(range r) {
+                    auto b = m_bottom.load(std::memory_order_relaxed);
+                    assert(b - m_top.load(std::memory_order_acquire) < capacity);
+                    auto &s = m_slots[b % capacity];
+                    s.begin.store(r.begin, std::memory_order_relaxed);
+                    s.end.store(r.end, std::memory_order_relaxed);
+                    std::atomic_thread_fence(std::memory_order_release);
+                    m_bottom.store(b + 1, std::memory_order_relaxed);
+                }
+
+                bool take(range &r) {
+                    auto b = m_bottom.load(std::memory_order_relaxed) - 1;
+                    m_bottom.store(b, std::memory_order_relaxed);
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    auto t = m_top.load(std::memory_order_relaxed);
+                    if (t > b) {
+                        m_bottom.store(b + 1, std::memory_order_relaxed);
+                        return false;
+                    }
+                    r = load(b);
+                    if (t < b)
+                        return true;
+                    bool res = m_top.compare_exchange_strong(
+                        t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+                    m_bottom.store(b + 1, std::memory_order_relaxed);
+                    return res;
+                }
+
+                bool steal(range &r) {
+                    auto t = m_top.load(std::memory_order_acquire);
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    auto b = m_bottom.load(std::memory_order_acquire);
+                    if (t >= b)
+                        return false;
+                    auto res = load(t);
+                    if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                        return false;
+                    r = res;
+                    return true;
+                }
+            };
+
+            struct job {
+                std::int64_t size;
+                std::int64_t grain;
+                std::atomic<std::int64_t> remaining;
+                void (*run)(void const *, range);
+                void const *fun;
+                std::atomic<bool> failed{false};
+                std::exception_ptr error;
+            };
+
+            inline int &this_worker() {
+                static thread_local int res = 0;
+                return res;
+            }
+
+            inline bool &in_parallel() {
+                static thread_local bool res = false;
+                return res;
+            }
+
+            class pool {
+                int m_size;
+                std::unique_ptr<deque[]> m_deques;
+                std::vector<std::thread> m_threads;
+
+                std::mutex m_mutex;
+                std::condition_variable m_cv;
+                std::atomic<std::uint64_t> m_generation{0};
+                std::atomic<int> m_busy{0};
+                std::atomic<job *> m_job{nullptr};
+                bool m_stop = false;
+
+                // serializes the loops that are started concurrently from different threads
+                std::mutex m_loop_mutex;
+
+                static int default_size() {
+                    if (char const *env = std::getenv("GT_NUM_THREADS")) {
+                        int res = std::atoi(env);
+                        if (res > 0)
+                            return res;
+                    }
+                    return std::max<int>(std::thread::hardware_concurrency(), 1);
+                }
+
+                void work(int id, job &j) {
+                    auto &own = m_deques[id];
+                    auto slice = [&](int i) { return j.size * i / m_size; };
+                    range r = {slice(id), slice(id + 1)};
+                    std::uint32_t seed = id * 2654435761u + 1;
+                    while (true) {
+                        if (r.begin < r.end) {
+                            // after a failure the ranges are only drained, so that the deques are empty for the next
+                            // loop
+                            if (!j.failed.load(std::memory_order_relaxed)) {
+                                while (r.end - r.begin > j.grain) {
+                                    auto mid = r.begin + (r.end - r.begin) / 2;
+                                    own.push({mid, r.end});
+                                    r.end = mid;
+                                }
+                                try {
+                                    j.run(j.fun, r);
+                                } catch (...) {
+                                    if (!j.failed.exchange(true, std::memory_order_acq_rel))
+                                        j.error = std::current_exception();
+                                }
+                            }
+                            j.remaining.fetch_sub(r.end - r.begin, std::memory_order_acq_rel);
+                        }
+                        if (own.take(r))
+                            continue;
+                        r = {0, 0};
+                        if (j.remaining.load(std::memory_order_acquire) == 0)
+                            return;
+                        if (m_size > 1) {
+                            seed = seed * 1664525u + 1013904223u;
+                            int victim = (id + 1 + seed % (m_size - 1)) % m_size;
+                            if (!m_deques[victim].steal(r))
+                                std::this_thread::yield();
+                        }
+                    }
+                }
+
+                static bool pin_threads() {
+                    char const *env = std::getenv("GT_PIN_THREADS");
+                    return env && std::atoi(env);
+                }
+
+                static void pin(int id) {
+#ifdef __linux__
+                    cpu_set_t allowed;
+                    if (sched_getaffinity(0, sizeof(allowed), &allowed))
+                        return;
+                    int target = id % std::max(CPU_COUNT(&allowed), 1);
+                    for (int cpu = 0; cpu != CPU_SETSIZE; ++cpu) {
+                        if (!CPU_ISSET(cpu, &allowed) || target-- != 0)
+                            continue;
+                        cpu_set_t set;
+                        CPU_ZERO(&set);
+                        CPU_SET(cpu, &set);
+                        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+                        return;
+                    }
+#endif
+                }
+
+                void worker_loop(int id) {
+                    this_worker() = id;
+                    in_parallel() = true;
+                    std::uint64_t seen = 0;
+                    while (true) {
+                        // spin for a while before falling asleep to keep the latency of consecutive loops low
+                        for (int i = 0; i < 1 << 14 && m_generation.load(std::memory_order_acquire) == seen; ++i)
+                            std::this_thread::yield();
+                        if (m_generation.load(std::memory_order_acquire) == seen) {
+                            std::unique_lock<std::mutex> lock(m_mutex);
+                            m_cv.wait(lock, [&] { return m_stop || m_generation.load() != seen; });
+                            if (m_stop)
+                                return;
+                        }
+                        seen = m_generation.load(std::memory_order_acquire);
+                        work(id, *m_job.load(std::memory_order_acquire));
+                        m_busy.fetch_sub(1, std::memory_order_acq_rel);
+                    }
+                }
+
+              public:
+                explicit pool(int size, bool pinned = false) : m_size(size), m_deques(new deque[size]) {
+                    for (int id = 1; id < size; ++id)
+                        m_threads.emplace_back([this, id, pinned] {
+                            if (pinned)
+                                pin(id);
+                            worker_loop(id);
+                        });
+                }
+
+                ~pool() {
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        m_stop = true;
+                    }
+                    m_cv.notify_all();
+                    for (auto &thread : m_threads)
+                        thread.join();
+                }
+
+                static pool &instance() {
+                    static pool res(default_size(), pin_threads());
+                    return res;
+                }
+
+                int size() const { return m_size; }
+
+                template <class F>
+                void parallel_for(std::int64_t size, F const &f) {
+                    if (size <= 0)
+                        return;
+                    if (m_size == 1 || in_parallel()) {
+                        f(range{0, size});
+                        return;
+                    }
+                    std::lock_guard<std::mutex> loop_lock(m_loop_mutex);
+                    in_parallel() = true;
+                    job j;
+                    j.size = size;
+                    j.grain = std::max<std::int64_t>(size / (m_size * 16), 1);
+                    j.remaining.store(size, std::memory_order_relaxed);
+                    j.run = [](void const *fun, range r) { (*static_cast<F const *>(fun))(r); };
+                    j.fun = &f;
+                    m_busy.store(m_size - 1, std::memory_order_relaxed);
+                    m_job.store(&j, std::memory_order_release);
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        m_generation.fetch_add(1, std::memory_order_acq_rel);
+                    }
+                    m_cv.notify_all();
+                    work(0, j);
+                    // the job lives on this stack, so wait until all workers have left it
+                    while (m_busy.load(std::memory_order_acquire) != 0)
+                        std::this_thread::yield();
+                    in_parallel() = false;
+                    if (j.error)
+                        std::rethrow_exception(j.error);
+                }
+            };
+
+            // the own pool of the calling thread, see `set_num_threads`
+            inline std::unique_ptr<pool> &local_pool() {
+                static thread_local std::unique_ptr<pool> res;
+                return res;
+            }
+
+            inline pool &current_pool() {
+                auto &local = local_pool();
+                return local ? *local : pool::instance();
+            }
+
+            inline void set_num_threads(int num_threads) {
+                auto &local = local_pool();
+                if (num_threads >= pool::instance().size())
+                    local.reset();
+                else if (!local || local->size() != num_threads)
+                    local.reset(new pool(std::max(num_threads, 1)));
+            }
+
+            /*
+             *  Executes `f` for the linear indices of the range. The multi index is decoded only for the first
+             *  iteration of the range. The first limit is the inner most dimension.
+             */
+            template <class F, class... Dims, std::size_t... Is>
+            void run_range(range r,
+                F const &f,
+                std::array<std::int64_t, sizeof...(Dims)> const &lims,
+                std::index_sequence<Is...>) {
+                constexpr std::size_t n = sizeof...(Dims);
+                std::array<std::int64_t, n> index;
+                auto rest = r.begin;
+                for (std::size_t d = 0; d != n; ++d) {
+                    index[d] = rest % lims[d];
+                    rest /= lims[d];
+                }
+                for (auto i = r.begin; i != r.end; ++i) {
+                    f(static_cast<Dims>(index[Is])...);
+                    for (std::size_t d = 0; d != n && ++index[d] == lims[d]; ++d)
+                        index[d] = 0;
+                }
+            }
+        } // namespace work_stealing_impl_
+
+        struct work_stealing {
+            friend int thread_pool_get_thread_num(work_stealing) { return work_stealing_impl_::this_worker(); }
+            friend int thread_pool_get_max_threads(work_stealing) { return work_stealing_impl_::current_pool().size(); }
+            friend void thread_pool_set_num_threads(work_stealing, int num_threads) {
+                work_stealing_impl_::set_num_threads(num_threads);
+            }
+
+            template <class F, class... Dims>
+            friend void thread_pool_parallel_for_loop(work_stealing, F const &f, Dims... limits) {
+                static_assert(sizeof...(Dims) > 0, "at least one loop limit is expected");
+                std::array<std::int64_t, sizeof...(Dims)> lims = {(std::int64_t)limits...};
+                std::int64_t size = 1;
+                for (auto lim : lims)
+                    size *= std::max<std::int64_t>(lim, 0);
+                work_stealing_impl_::current_pool().parallel_for(size, [&](work_stealing_impl_::range r) {
+                    work_stealing_impl_::run_range<F, Dims...>(r, f, lims, std::index_sequence_for<Dims...>());
+                });
+            }
+        };
+    } // namespace thread_pool
+} // namespace gridtools
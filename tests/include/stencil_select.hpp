@@ -135,62 +135,71 @@ namespace gridtools {
         inline char const *backend_name(naive const &) { return "naive"; }
 
         namespace cpu_kfirst_backend {
-            template <class, class, class>
+            template <class, class, class, class>
             struct cpu_kfirst;
 
-            template <class I, class J, class T>
-            storage::cpu_kfirst backend_storage_traits(cpu_kfirst<I, J, T>);
+            template <class I, class J, class T, class K>
+            storage::cpu_kfirst backend_storage_traits(cpu_kfirst<I, J, T, K>);
 
-            template <class I, class J, class T>
-            timer_omp backend_timer_impl(cpu_kfirst<I, J, T>);
+            template <class I, class J, class T, class K>
+            timer_omp backend_timer_impl(cpu_kfirst<I, J, T, K>);
 
-            template <class I, class J, class T>
-            char const *backend_name(cpu_kfirst<I, J, T> const &) {
+            template <class I, class J, class T, class K>
+            char const *backend_name(cpu_kfirst<I, J, T, K> const &) {
                 return "cpu_kfirst";
             }
 
 #if defined(GT_STENCIL_CPU_KFIRST_HPX)
-            template <class I, class J>
-            char const *backend_name(cpu_kfirst<I, J, thread_pool::hpx> const &) {
+            template <class I, class J, class K>
+            char const *backend_name(cpu_kfirst<I, J, thread_pool::hpx, K> const &) {
                 return "cpu_kfirst_hpx";
             }
 
-            template <class I, class J>
-            void backend_init(cpu_kfirst<I, J, thread_pool::hpx>, int &argc, char **argv) {
+            template <class I, class J, class K>
+            void backend_init(cpu_kfirst<I, J, thread_pool::hpx, K>, int &argc, char **argv) {
                 hpx_start(argc, argv);
             }
 
-            template <class I, class J>
-            void backend_finalize(cpu_kfirst<I, J, thread_pool::hpx>) {
+            template <class I, class J, class K>
+            void backend_finalize(cpu_kfirst<I, J, thread_pool::hpx, K>) {
                 hpx_stop();
             }
 #endif
         } // namespace cpu_kfirst_backend
 
         namespace cpu_ifirst_backend {
-            template <class>
+            template <class, class, class, class>
             struct cpu_ifirst;
 
-            template <class T>
-            storage::cpu_ifirst backend_storage_traits(cpu_ifirst<T>);
+            template <class T, class I, class J, class L>
+            storage::cpu_ifirst backend_storage_traits(cpu_ifirst<T, I, J, L>);
 
-            template <class T>
-            std::false_type backend_supports_icosahedral(cpu_ifirst<T>);
+            template <class T, class I, class J, class L>
+            std::false_type backend_supports_icosahedral(cpu_ifirst<T, I, J, L>);
 
-            template <class T>
-            timer_omp backend_timer_impl(cpu_ifirst<T>);
+            template <class T, class I, class J, class L>
+            timer_omp backend_timer_impl(cpu_ifirst<T, I, J, L>);
 
-            template <class T>
-            char const *backend_name(cpu_ifirst<T> const &) {
+            template <class T, class I, class J, class L>
+            char const *backend_name(cpu_ifirst<T, I, J, L> const &) {
                 return "cpu_ifirst";
             }
 
 #if defined(GT_STENCIL_CPU_IFIRST_HPX)
-            inline char const *backend_name(cpu_ifirst<thread_pool::hpx> const &) { return "cpu_ifirst_hpx"; }
+            template <class I, class J, class L>
+            char const *backend_name(cpu_ifirst<thread_pool::hpx, I, J, L> const &) {
+                return "cpu_ifirst_hpx";
+            }
 
-            inline void backend_init(cpu_ifirst<thread_pool::hpx>, int &argc, char **argv) { hpx_start(argc, argv); }
+            template <class I, class J, class L>
+            void backend_init(cpu_ifirst<thread_pool::hpx, I, J, L>, int &argc, char **argv) {
+                hpx_start(argc, argv);
+            }
 
-            inline void backend_finalize(cpu_ifirst<thread_pool::hpx>) { hpx_stop(); }
+            template <class I, class J, class L>
+            void backend_finalize(cpu_ifirst<thread_pool::hpx, I, J, L>) {
+                hpx_stop();
+            }
 #endif
         } // namespace cpu_ifirst_backend
 
@@ -0,0 +1,153 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <gridtools/storage/checkpoint.hpp>
+
+#include <storage_select.hpp>
+#include <test_environment.hpp>
+
+using namespace gridtools;
+
+namespace {
+    // the prognostic and diagnostic fields of a model, the throughput is measured over all of them
+    constexpr int num_fields = 16;
+
+    std::size_t file_size(char const *path) {
+        struct stat st;
+        return stat(path, &st) == 0 ? st.st_size : 0;
+    }
+
+    // the writes are measured until the data is on the device
+    void sync_file(char const *path) {
+        int fd = open(path, O_RDONLY);
+        if (fd < 0)
+            return;
+        fdatasync(fd);
+        close(fd);
+    }
+
+    // the reads are measured from the device, not from the page cache
+    void drop_page_cache(char const *path) {
+        int fd = open(path, O_RDONLY);
+        if (fd < 0)
+            return;
+        fdatasync(fd);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+
+    bool supports_direct_io(char const *path) {
+#ifdef O_DIRECT
+        int fd = open(path, O_RDONLY | O_DIRECT);
+        if (fd < 0)
+            return false;
+        close(fd);
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /*
+     *  Runs `fun` as the benchmark `name` and prints the throughput in bytes/s, the size of the checkpoint file over
+     *  the time of `fun` (the first call is the warm up). `prepare` is called before every call and is not timed.
+     */
+    template <class TestEnv, class Prepare, class Fun>
+    void benchmark_throughput(std::string const &name, char const *path, Prepare const &prepare, Fun const &fun) {
+        double seconds = 0;
+        std::size_t calls = 0;
+        bool warm = false;
+        TestEnv::benchmark(name, [&] {
+            prepare();
+            auto start = std::chrono::steady_clock::now();
+            fun();
+            auto time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (warm) {
+                seconds += time;
+                ++calls;
+            }
+            warm = true;
+        });
+        if (calls == 0)
+            return;
+        double bytes = double(file_size(path)) * calls;
+        std::cout << name << ": " << bytes / seconds << " bytes/s (" << bytes / seconds / (1 << 30) << " GiB/s, "
+                  << file_size(path) << " bytes per checkpoint)" << std::endl;
+    }
+} // namespace
+
+GT_REGRESSION_TEST(checkpoint, test_environment<>, storage_traits_t) {
+    char path[] = "gt_checkpoint_XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    close(fd);
+
+    using data_store_t = decltype(TypeParam::builder().name("")());
+    std::vector<data_store_t> fields, restored;
+    auto reset_restored = [&] {
+        restored.clear();
+        for (int n = 0; n != num_fields; ++n)
+            restored.push_back(TypeParam::builder().name("field_" + std::to_string(n)).value(-1)());
+    };
+    for (int n = 0; n != num_fields; ++n) {
+        auto fun = [n](int i, int j, int k) { return i + j + k + n; };
+        fields.push_back(TypeParam::builder().name("field_" + std::to_string(n)).initializer(fun)());
+    }
+
+    auto make_options = [](bool direct) {
+        storage::checkpoint_options res;
+        res.direct_io = direct;
+        return res;
+    };
+    auto save = [&](bool direct) {
+        storage::checkpoint_writer writer(path, make_options(direct));
+        for (auto &&field : fields)
+            writer.add(field);
+        writer.write();
+        sync_file(path);
+    };
+    auto load = [&](bool direct) {
+        storage::checkpoint_reader reader(path, make_options(direct));
+        for (auto &&field : restored)
+            reader.add(field);
+        reader.read();
+    };
+
+    for (bool direct : {false, true}) {
+        reset_restored();
+        save(direct);
+        load(direct);
+        for (int n = 0; n != num_fields; ++n)
+            TypeParam::verify(fields[n], restored[n]);
+    }
+
+    auto nothing = [] {};
+    auto drop = [&] { drop_page_cache(path); };
+    benchmark_throughput<TypeParam>("checkpoint_write_buffered", path, nothing, [&] { save(false); });
+    benchmark_throughput<TypeParam>("checkpoint_read_buffered", path, drop, [&] { load(false); });
+    if (supports_direct_io(path)) {
+        benchmark_throughput<TypeParam>("checkpoint_write_direct", path, nothing, [&] { save(true); });
+        benchmark_throughput<TypeParam>("checkpoint_read_direct", path, drop, [&] { load(true); });
+    } else {
+        std::cout << "checkpoint: O_DIRECT is not supported by the file system of " << path << std::endl;
+    }
+
+    std::remove(path);
+}
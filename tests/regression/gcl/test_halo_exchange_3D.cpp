@@ -9,6 +9,7 @@
  */
 #include <gridtools/gcl/halo_exchange.hpp>
 
+#include <tuple>
 #include <type_traits>
 #include <vector>
 
@@ -59,14 +60,24 @@ void exchange(std::true_type, Testee &testee, Fields const &... fields) {
     testee.unpack(vec);
 }
 
-class halo_exchange_3D_test : public testing::TestWithParam<test_spec> {
+inline test_spec const &get_spec(test_spec const &spec) { return spec; }
+
+template <class... Ts>
+test_spec const &get_spec(std::tuple<test_spec, Ts...> const &param) {
+    return std::get<0>(param);
+}
+
+template <class Param>
+class halo_exchange_3D_fixture : public testing::TestWithParam<Param> {
     int mpi_dims[num_dims];
     int coords[num_dims] = {};
 
+    test_spec const &spec() const { return get_spec(this->GetParam()); }
+
     value_type initial_state(int i, int j, int k, int field_no) const {
         auto val = [&](int i, int d) {
-            auto size = GetParam().dims[d];
-            i -= GetParam().halos[field_no][d][0];
+            auto size = spec().dims[d];
+            i -= spec().halos[field_no][d][0];
             int c = coords[d];
             if (c == 0 && i < 0)
                 c = mpi_dims[d];
@@ -81,12 +92,12 @@ class halo_exchange_3D_test : public testing::TestWithParam<test_spec> {
     auto make_storages(layout_map<Is...>) const {
         auto make_storage = [&](int field_no) {
             auto size = [&](int d) {
-                auto &&halos = GetParam().halos[field_no][d];
-                return GetParam().dims[d] + halos[0] + halos[1];
+                auto &&halos = spec().halos[field_no][d];
+                return spec().dims[d] + halos[0] + halos[1];
             };
             auto in_halo = [&](int i, int d) {
-                i -= GetParam().halos[field_no][d][0];
-                return i < 0 || i >= GetParam().dims[d];
+                i -= spec().halos[field_no][d][0];
+                return i < 0 || i >= spec().dims[d];
             };
             return storage::builder<storage_traits_t>
                     .template type<value_type>()
@@ -109,8 +120,8 @@ class halo_exchange_3D_test : public testing::TestWithParam<test_spec> {
             auto is_border = [&](int i, int d) {
                 if (periodicity[d])
                     return false;
-                i -= GetParam().halos[f][d][0];
-                return (i < 0 && coords[d] == 0) || (i >= GetParam().dims[d] && coords[d] + 1 == mpi_dims[d]);
+                i -= spec().halos[f][d][0];
+                return (i < 0 && coords[d] == 0) || (i >= spec().dims[d] && coords[d] + 1 == mpi_dims[d]);
             };
             auto &&lengths = view.lengths();
             for (int i = 0; i != lengths[0]; ++i)
@@ -125,11 +136,11 @@ class halo_exchange_3D_test : public testing::TestWithParam<test_spec> {
   public:
     MPI_Comm CartComm;
 
-    halo_exchange_3D_test() {
+    halo_exchange_3D_fixture() {
         int nprocs;
         MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
         for (int i = 0; i != num_dims; ++i)
-            mpi_dims[i] = GetParam().mpi_dims[i];
+            mpi_dims[i] = spec().mpi_dims[i];
         MPI_Dims_create(nprocs, num_dims, mpi_dims);
         int period[num_dims] = {1, 1, 1};
         MPI_Cart_create(MPI_COMM_WORLD, 3, mpi_dims, period, false, &CartComm);
@@ -141,8 +152,8 @@ class halo_exchange_3D_test : public testing::TestWithParam<test_spec> {
         array<halo_descriptor, num_dims> res;
         auto total_lengths = make_total_lengths(*storages[field_no]);
         for (size_t d = 0; d != num_dims; ++d) {
-            auto &&halos = GetParam().halos[field_no][d];
-            res[d] = halo_descriptor(halos[0], halos[1], halos[0], GetParam().dims[d] + halos[0] - 1, total_lengths[d]);
+            auto &&halos = spec().halos[field_no][d];
+            res[d] = halo_descriptor(halos[0], halos[1], halos[0], spec().dims[d] + halos[0] - 1, total_lengths[d]);
         }
         return res;
     }
@@ -173,6 +184,8 @@ class halo_exchange_3D_test : public testing::TestWithParam<test_spec> {
     }
 };
 
+using halo_exchange_3D_test = halo_exchange_3D_fixture<test_spec>;
+
 struct halo_exchange_3D_all : halo_exchange_3D_test {};
 
 TEST_P(halo_exchange_3D_all, test) {
@@ -190,6 +203,16 @@ TEST_P(halo_exchange_3D_all, test) {
         testee.setup(3);
         auto field = [&](int f) { return storages[f]->get_target_ptr(); };
         exchange(use_vector_interface, testee, field(0), field(1), field(2));
+#ifdef GT_GCL_CPU
+        if (periodicity.value(0) && periodicity.value(1) && periodicity.value(2)) {
+            // the send and the receive boxes of the periodic exchange have the same total volume
+            auto &&stats = testee.get_pack_statistics();
+            EXPECT_GT(stats.pack_bytes, 0);
+            EXPECT_EQ(stats.pack_bytes, stats.unpack_bytes);
+            testee.reset_pack_statistics();
+            EXPECT_EQ(testee.get_pack_statistics().pack_bytes, 0);
+        }
+#endif
     });
 }
 
@@ -208,6 +231,83 @@ INSTANTIATE_TEST_SUITE_P(tests,
             .halos = {{{2, 2}, {2, 2}, {2, 2}}, {{2, 2}, {2, 2}, {2, 2}}, {{2, 2}, {2, 2}, {2, 2}}},
             .mpi_dims = {2, 1}}));
 
+// how the halos are moved in addition to the exchange mode, the other transfers than `pack` are CPU only
+enum class transfer { pack, zero_copy, automatic_zero_copy, shared_memory };
+
+struct halo_exchange_3D_modes : halo_exchange_3D_fixture<std::tuple<test_spec, gcl::exchange_mode, transfer>> {
+    gcl::exchange_mode mode() const { return std::get<1>(GetParam()); }
+    transfer get_transfer() const { return std::get<2>(GetParam()); }
+
+    template <class Testee>
+    void set_transfer(Testee &testee) const {
+#ifdef GT_GCL_CPU
+        switch (get_transfer()) {
+        case transfer::pack:
+            break;
+        case transfer::zero_copy:
+            testee.set_zero_copy(gcl::zero_copy_policy::always);
+            break;
+        case transfer::automatic_zero_copy:
+            testee.set_zero_copy(gcl::zero_copy_policy::automatic);
+            break;
+        case transfer::shared_memory:
+            testee.set_shared_memory(true);
+            // the remote neighbours, if any, still go through the datatypes
+            testee.set_zero_copy(gcl::zero_copy_policy::always);
+            break;
+        }
+#endif
+    }
+};
+
+TEST_P(halo_exchange_3D_modes, test) {
+    run_exchanges([&](auto layout, auto use_vector_interface, auto &&storages, auto periodicity) {
+        using testee_t = gcl::halo_exchange_dynamic_ut<decltype(layout), layout_map<0, 1, 2>, value_type, gcl_arch_t>;
+        testee_t testee(periodicity, CartComm);
+        testee.set_exchange_mode(mode());
+        set_transfer(testee);
+        auto halo_descriptors = make_halo_descriptors(storages, 0);
+        for_each<meta::make_indices_c<num_fields>>(
+            [&](auto f) { testee.template add_halo<decltype(f)::value>(halo_descriptors[f.value]); });
+        testee.setup(3);
+        auto field = [&](int f) { return storages[f]->get_target_ptr(); };
+        // the buffer sizes change between the exchanges: the repeated exchange reuses the requests, the automatic
+        // zero copy policy decides on changing fields and the shared memory window alternates between its halves
+        exchange(use_vector_interface, testee, field(0));
+        exchange(use_vector_interface, testee, field(0), field(1), field(2));
+        exchange(use_vector_interface, testee, field(0), field(1), field(2));
+#ifdef GT_GCL_CPU
+        auto &&stats = testee.get_pack_statistics();
+        if (get_transfer() == transfer::zero_copy) {
+            EXPECT_EQ(stats.pack_bytes, 0);
+            EXPECT_EQ(stats.unpack_bytes, 0);
+        } else if (get_transfer() != transfer::automatic_zero_copy && periodicity.value(0) && periodicity.value(1) &&
+                   periodicity.value(2)) {
+            EXPECT_EQ(stats.pack_bytes, stats.unpack_bytes);
+        }
+#endif
+    });
+}
+
+INSTANTIATE_TEST_SUITE_P(tests,
+    halo_exchange_3D_modes,
+    testing::Combine(
+        testing::Values(test_spec{.dims = {12, 12, 12},
+                            .halos = {{{2, 2}, {2, 2}, {2, 2}}, {{2, 2}, {2, 2}, {2, 2}}, {{2, 2}, {2, 2}, {2, 2}}},
+                            .mpi_dims = {2, 1}},
+            test_spec{.dims = {9, 7, 5},
+                .halos = {{{2, 1}, {1, 2}, {0, 1}}, {{2, 1}, {1, 2}, {0, 1}}, {{2, 1}, {1, 2}, {0, 1}}},
+                .mpi_dims = {}}),
+        testing::Values(gcl::exchange_mode::point_to_point,
+            gcl::exchange_mode::persistent,
+            gcl::exchange_mode::neighbor_collective),
+#ifdef GT_GCL_CPU
+        testing::Values(transfer::pack, transfer::zero_copy, transfer::automatic_zero_copy, transfer::shared_memory)
+#else
+        testing::Values(transfer::pack)
+#endif
+            ));
+
 struct halo_exchange_3D_generic : halo_exchange_3D_test {
     array<halo_descriptor, num_dims> make_enclosed_halo_descriptor() {
         array<halo_descriptor, num_dims> res;
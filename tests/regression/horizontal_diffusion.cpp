@@ -133,4 +133,24 @@ namespace {
         TypeParam::verify(repo.out, out);
         TypeParam::benchmark("horizontal_diffusion", comp);
     }
+
+    // the same computation on storages with the strides padded against the cache set aliasing
+    GT_REGRESSION_TEST(horizontal_diffusion_anti_aliasing, test_environment<2>, stencil_backend_t) {
+        using float_t = typename TypeParam::float_t;
+        horizontal_diffusion_repository repo(TypeParam::d(0), TypeParam::d(1), TypeParam::d(2));
+        auto out = TypeParam::builder().template padding<storage::anti_aliasing>().build();
+        auto make_const_storage = [](auto const &fun) {
+            return TypeParam::template builder<float_t const>()
+                .template padding<storage::anti_aliasing>()
+                .initializer(fun)
+                .build();
+        };
+        auto comp = [grid = TypeParam::make_grid(),
+                        coeff = make_const_storage(repo.coeff),
+                        in = make_const_storage(repo.in),
+                        &out] { run(get_spec(TypeParam()), TypeParam::backend(), grid, in, coeff, out); };
+        comp();
+        TypeParam::verify(repo.out, out);
+        TypeParam::benchmark("horizontal_diffusion_anti_aliasing", comp);
+    }
 } // namespace
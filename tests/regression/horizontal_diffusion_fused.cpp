@@ -99,4 +99,59 @@ namespace {
         TypeParam::verify(repo.out, out);
         TypeParam::benchmark("horizontal_diffusion_fused", comp);
     }
+
+    struct div_function {
+        using out = inout_accessor<0>;
+        using in = in_accessor<1>;
+        using flx = in_accessor<2, extent<-1, 0, 0, 0>>;
+        using fly = in_accessor<3, extent<0, 0, -1, 0>>;
+        using coeff = in_accessor<4>;
+
+        using param_list = make_param_list<out, in, flx, fly, coeff>;
+
+        template <typename Evaluation>
+        GT_FUNCTION static void apply(Evaluation eval) {
+            eval(out()) =
+                eval(in()) - eval(coeff()) * (eval(flx()) - eval(flx(-1, 0)) + eval(fly()) - eval(fly(0, -1)));
+        }
+    };
+
+    // the fluxes are kept in uncached temporaries, which makes the working set depend on the tiling of the backend;
+    // the k-tiled instance only holds slabs of 64 levels of them (compare with long columns, e.g. `32 32 4096`);
+    // the k-tiling is experimental and usually slower than the untiled backend, the benchmark tracks the gap
+    GT_REGRESSION_TEST(horizontal_diffusion_fused_fluxes, test_environment<2>, stencil_backend_t) {
+        auto out = TypeParam::make_storage();
+
+        horizontal_diffusion_repository repo(TypeParam::d(0), TypeParam::d(1), TypeParam::d(2));
+
+        auto spec = [](auto in, auto coeff, auto out) {
+            GT_DECLARE_TMP(typename TypeParam::float_t, flx, fly);
+            return execute_parallel()
+                .stage(flx_function(), flx, in)
+                .stage(fly_function(), fly, in)
+                .stage(div_function(), out, in, flx, fly, coeff);
+        };
+        auto make_comp = [&,
+                             grid = TypeParam::make_grid(),
+                             in = TypeParam::make_storage(repo.in),
+                             coeff = TypeParam::make_storage(repo.coeff)](auto backend) {
+            return [&, backend] { run(spec, backend, grid, in, coeff, out); };
+        };
+
+        auto comp = make_comp(stencil_backend_t());
+        comp();
+        TypeParam::verify(repo.out, out);
+        TypeParam::benchmark("horizontal_diffusion_fused_fluxes", comp);
+
+#if defined(GT_STENCIL_CPU_KFIRST)
+        out = TypeParam::make_storage();
+        auto k_tiled_comp = make_comp(cpu_kfirst<integral_constant<int_t, 8>,
+            integral_constant<int_t, 8>,
+            thread_pool::omp,
+            integral_constant<int_t, 64>>());
+        k_tiled_comp();
+        TypeParam::verify(repo.out, out);
+        TypeParam::benchmark("horizontal_diffusion_fused_fluxes_k_tiled", k_tiled_comp);
+#endif
+    }
 } // namespace
@@ -0,0 +1,68 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gtest/gtest.h>
+
+#include <gridtools/stencil/cartesian.hpp>
+
+#include <stencil_select.hpp>
+#include <test_environment.hpp>
+
+/*
+ *  Compares the launch overhead of `run` with the one of the compiled stencil (`stencil::compile`).
+ *  The overhead dominates for the small domains, e.g. `perftests 16 16 8 1000`.
+ */
+namespace {
+    using namespace gridtools;
+    using namespace stencil;
+    using namespace cartesian;
+
+    struct lap {
+        using out = inout_accessor<0>;
+        using in = in_accessor<1, extent<-1, 1, -1, 1>>;
+        using param_list = make_param_list<out, in>;
+
+        template <typename Evaluation>
+        GT_FUNCTION static void apply(Evaluation eval) {
+            eval(out()) = 4 * eval(in()) - (eval(in(1, 0)) + eval(in(0, 1)) + eval(in(-1, 0)) + eval(in(0, -1)));
+        }
+    };
+
+    GT_REGRESSION_TEST(launch_overhead, test_environment<2>, stencil_backend_t) {
+        auto spec = [](auto in, auto out) {
+            GT_DECLARE_TMP(typename TypeParam::float_t, tmp);
+            return execute_parallel().stage(lap(), tmp, in).stage(lap(), out, tmp);
+        };
+        auto in = [](int_t i, int_t j, int_t k) { return i * 1.5 + j * j - k; };
+        auto lap1 = [in](int_t i, int_t j, int_t k) {
+            return 4 * in(i, j, k) - (in(i + 1, j, k) + in(i, j + 1, k) + in(i - 1, j, k) + in(i, j - 1, k));
+        };
+        auto ref = [lap1](int_t i, int_t j, int_t k) {
+            return 4 * lap1(i, j, k) -
+                   (lap1(i + 1, j, k) + lap1(i, j + 1, k) + lap1(i - 1, j, k) + lap1(i, j - 1, k));
+        };
+        auto out = TypeParam::make_storage();
+        auto grid = TypeParam::make_grid();
+        auto src = TypeParam::make_const_storage(in);
+
+        auto run_comp = [&] { run(spec, stencil_backend_t(), grid, src, out); };
+        run_comp();
+        TypeParam::verify(ref, out);
+
+        auto compiled = compile(spec, stencil_backend_t(), grid);
+        out = TypeParam::make_storage();
+        auto compiled_comp = [&] { compiled(src, out); };
+        compiled_comp();
+        TypeParam::verify(ref, out);
+
+        TypeParam::benchmark("launch_overhead_run", run_comp);
+        TypeParam::benchmark("launch_overhead_compiled", compiled_comp);
+    }
+} // namespace
@@ -8,8 +8,14 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <cstring>
+
 #include <gridtools/layout_transformation.hpp>
 
+#ifdef GT_STORAGE_GPU
+#include <gridtools/common/cuda_util.hpp>
+#endif
+
 #include <storage_select.hpp>
 #include <test_environment.hpp>
 
@@ -37,4 +43,24 @@ GT_REGRESSION_TEST(layout_transformation, test_environment<>, storage_traits_t)
     testee();
     verify_result(src, dst);
     TypeParam::benchmark("layout_transformation", testee);
+
+    // the same layout: the bound for the bandwidth of the transformation
+    auto same = TypeParam::builder().template layout<0, 1, 2>()();
+    auto copy = [&] {
+        transform_layout(
+            same->get_target_ptr(), src->get_target_ptr(), src->lengths(), same->strides(), src->strides());
+    };
+    copy();
+    verify_result(src, same);
+    TypeParam::benchmark("layout_transformation_copy", copy);
+
+    auto bytes = src->length() * sizeof(*src->get_target_ptr());
+    auto raw_copy = [&] {
+#ifdef GT_STORAGE_GPU
+        GT_CUDA_CHECK(cudaMemcpy(same->get_target_ptr(), src->get_target_ptr(), bytes, cudaMemcpyDeviceToDevice));
+#else
+        std::memcpy(same->get_target_ptr(), src->get_target_ptr(), bytes);
+#endif
+    };
+    TypeParam::benchmark("layout_transformation_memcpy", raw_copy);
 }
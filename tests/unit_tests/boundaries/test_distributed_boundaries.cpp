@@ -11,6 +11,8 @@
 #include <gridtools/boundaries/distributed_boundaries.hpp>
 
 #include <functional>
+#include <stdexcept>
+#include <tuple>
 
 #include <gtest/gtest.h>
 #include <mpi.h>
@@ -20,6 +22,13 @@
 #include <gridtools/boundaries/value.hpp>
 #include <gridtools/storage/builder.hpp>
 
+#ifdef GT_GCL_CPU
+#include <gridtools/boundaries/overlapped_run.hpp>
+#include <gridtools/stencil/cartesian.hpp>
+#include <gridtools/stencil/cpu_kfirst.hpp>
+#include <gridtools/storage/sid.hpp>
+#endif
+
 #include <gcl_select.hpp>
 #include <multiplet.hpp>
 #include <storage_select.hpp>
@@ -161,3 +170,77 @@ TEST_F(distributed_boundaries_test, exchange) {
     expect_b([&](int i, int j, int k) { return from_abroad(i, j) ? c_init(i, j, k) : b_init(i, j, k); });
     expect_d([&](int i, int j, int k) { return from_abroad(i, j) ? triplet{} : d_init(i, j, k); });
 }
+
+TEST_F(distributed_boundaries_test, split_phase_exchange) {
+    auto handle = testee.start_exchange(
+        bind_bc(value_boundary<triplet>(triplet{42, 42, 42}), a), bind_bc(copy_boundary(), b, _1).associate(c), d);
+    EXPECT_THROW(testee.start_exchange(d), std::runtime_error);
+    testee.finish_exchange(handle);
+    EXPECT_THROW(testee.finish_exchange(handle), std::runtime_error);
+    expect_a([&](int i, int j, int k) { return from_abroad(i, j) ? triplet{42, 42, 42} : a_init(i, j, k); });
+    expect_b([&](int i, int j, int k) { return from_abroad(i, j) ? c_init(i, j, k) : b_init(i, j, k); });
+    expect_d([&](int i, int j, int k) { return from_abroad(i, j) ? triplet{} : d_init(i, j, k); });
+}
+
+#ifdef GT_GCL_CPU
+struct gather_function {
+    using out = stencil::cartesian::inout_accessor<0>;
+    using in = stencil::cartesian::in_accessor<1, stencil::extent<-1, 1, -1, 1>>;
+    using param_list = stencil::make_param_list<out, in>;
+
+    template <class Eval>
+    GT_FUNCTION static void apply(Eval &&eval) {
+        eval(out()) = triplet{eval(in(-1, 0))[0], eval(in(1, 1))[1], eval(in(0, -1))[2]};
+    }
+};
+
+TEST(distributed_boundaries, overlapped_run) {
+    constexpr int halo = 2;
+    constexpr int ni = 12;
+    constexpr int nj = 11;
+    constexpr int nk = 3;
+    const auto big_builder =
+        storage::builder<storage_traits_t>.type<triplet>().halos(halo, halo, 0).dimensions(ni, nj, nk);
+    auto total_lengths = make_total_lengths(*big_builder());
+    array<halo_descriptor, 3> big_halos{{{halo, halo, halo, ni - halo - 1, total_lengths[0]},
+        {halo, halo, halo, nj - halo - 1, total_lengths[1]},
+        {0, 0, 0, nk - 1, total_lengths[2]}}};
+    testee_t testee(big_halos, {true, true, false}, 1, [] {
+        int dims[3] = {};
+        MPI_Dims_create(gcl::procs(), 2, dims);
+        dims[2] = 1;
+        int period[3] = {1, 1, 1};
+        MPI_Comm res;
+        MPI_Cart_create(gcl::world(), 3, dims, period, false, &res);
+        return res;
+    }());
+    int pi, pj, pk;
+    testee.proc_grid().coords(pi, pj, pk);
+    auto init = [=](int i, int j, int k) {
+        return i < halo || i >= ni - halo || j < halo || j >= nj - halo
+                   ? triplet{}
+                   : triplet{i + 100 * pi, j + 100 * pj, k};
+    };
+    auto in = big_builder.initializer(init).build();
+    auto in_ref = big_builder.initializer(init).build();
+    auto out = big_builder.value(triplet{-1, -1, -1}).build();
+    auto out_ref = big_builder.value(triplet{-1, -1, -1}).build();
+
+    auto comp = [](auto out, auto in) { return stencil::execute_parallel().stage(gather_function(), out, in); };
+    auto grid = stencil::make_grid(big_halos[0], big_halos[1], nk);
+
+    testee.exchange(in_ref);
+    stencil::run(comp, stencil::cpu_kfirst<>(), grid, out_ref, in_ref);
+    overlapped_run(comp, stencil::cpu_kfirst<>(), grid, testee, std::tie(in), out, in);
+
+    EXPECT_EQ(testee.get_count_exchange(), 2);
+    for (int i = 0; i < ni; ++i)
+        for (int j = 0; j < nj; ++j)
+            for (int k = 0; k < nk; ++k) {
+                EXPECT_EQ(out->const_host_view()(i, j, k), out_ref->const_host_view()(i, j, k))
+                    << gcl::pid() << ": " << i << ", " << j << ", " << k;
+                EXPECT_EQ(in->const_host_view()(i, j, k), in_ref->const_host_view()(i, j, k))
+                    << gcl::pid() << ": " << i << ", " << j << ", " << k;
+            }
+}
+#endif
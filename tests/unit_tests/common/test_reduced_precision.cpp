@@ -0,0 +1,104 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/common/reduced_precision.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include <gtest/gtest.h>
+
+namespace gridtools {
+    namespace {
+        static_assert(sizeof(float16_t) == 2, "");
+        static_assert(sizeof(bfloat16_t) == 2, "");
+        static_assert(sizeof(fixed_point<std::int16_t, 8>) == 2, "");
+        static_assert(std::is_trivially_copyable<float16_t>::value, "");
+        static_assert(std::is_same<widen_t<float16_t const>, float>::value, "");
+        static_assert(std::is_same<widen_t<fixed_point<std::int32_t, 16>>, double>::value, "");
+        static_assert(std::is_same<widen_t<double>, double>::value, "");
+
+        TEST(float16, round_trip) {
+            for (std::uint32_t bits = 0; bits != 0x10000; ++bits) {
+                float value = float16_t::from_bits(bits);
+                if (std::isnan(value)) {
+                    EXPECT_TRUE(std::isnan(float(float16_t(value))));
+                } else {
+                    EXPECT_EQ(float16_t(value).m_bits, bits);
+                }
+            }
+        }
+
+        TEST(float16, values) {
+            EXPECT_EQ(float16_t(1.f).m_bits, 0x3c00);
+            EXPECT_EQ(float16_t(-2.f).m_bits, 0xc000);
+            EXPECT_EQ(float16_t(65504.f).m_bits, 0x7bff);
+            EXPECT_EQ(float16_t(65519.f).m_bits, 0x7bff);
+            EXPECT_EQ(float16_t(65520.f).m_bits, 0x7c00);
+            EXPECT_EQ(float16_t(-1e10f).m_bits, 0xfc00);
+            EXPECT_EQ(float16_t(std::ldexp(1.f, -24)).m_bits, 0x0001);
+            EXPECT_EQ(float16_t(std::ldexp(1.f, -25)).m_bits, 0x0000);
+            EXPECT_EQ(float16_t(std::ldexp(3.f, -25)).m_bits, 0x0002);
+            EXPECT_EQ(float16_t(1e-10f).m_bits, 0x0000);
+            // ties to even
+            EXPECT_EQ(float16_t(1 + std::ldexp(1.f, -11)).m_bits, 0x3c00);
+            EXPECT_EQ(float16_t(1 + std::ldexp(3.f, -11)).m_bits, 0x3c02);
+            EXPECT_EQ(float16_t(1 + std::ldexp(1.f, -11) + std::ldexp(1.f, -20)).m_bits, 0x3c01);
+        }
+
+        TEST(float16, nearest) {
+            for (float value = 1e-7f; value < 65504.f; value *= 1.0001f) {
+                float16_t res = value;
+                float error = std::abs(float(res) - value);
+                EXPECT_LE(error, std::abs(float(float16_t::from_bits(res.m_bits + 1)) - value));
+                if (res.m_bits) {
+                    EXPECT_LE(error, std::abs(float(float16_t::from_bits(res.m_bits - 1)) - value));
+                }
+            }
+        }
+
+        TEST(bfloat16, values) {
+            EXPECT_EQ(bfloat16_t(1.f).m_bits, 0x3f80);
+            EXPECT_EQ(float(bfloat16_t(3.140625f)), 3.140625f);
+            EXPECT_EQ(float(bfloat16_t(1 + std::ldexp(1.f, -8))), 1);
+            EXPECT_EQ(float(bfloat16_t(1 + std::ldexp(3.f, -8))), 1 + std::ldexp(1.f, -6));
+            EXPECT_TRUE(std::isnan(float(bfloat16_t(std::numeric_limits<float>::quiet_NaN()))));
+            EXPECT_TRUE(std::isinf(float(bfloat16_t(std::numeric_limits<float>::infinity()))));
+        }
+
+        TEST(fixed_point, values) {
+            using testee_t = fixed_point<std::int16_t, 8>;
+            EXPECT_EQ(testee_t(1.5f).m_raw, 384);
+            EXPECT_EQ(testee_t(-1.5f).m_raw, -384);
+            EXPECT_EQ(float(testee_t::from_raw(-1)), -1.f / 256);
+            EXPECT_EQ(testee_t(1000.f).m_raw, 32767);
+            EXPECT_EQ(testee_t(-1000.f).m_raw, -32768);
+            EXPECT_EQ(testee_t(std::numeric_limits<float>::quiet_NaN()).m_raw, 0);
+            // ties to even
+            EXPECT_EQ(testee_t(.5f / 256).m_raw, 0);
+            EXPECT_EQ(testee_t(1.5f / 256).m_raw, 2);
+            EXPECT_EQ(testee_t(-1.5f / 256).m_raw, -2);
+            EXPECT_EQ(testee_t(-.7f / 256).m_raw, -1);
+        }
+
+        TEST(reduced_precision, arithmetic) {
+            float16_t a = 1.5;
+            fixed_point<std::int32_t, 16> b = 2;
+            EXPECT_EQ(a + b, 3.5);
+            EXPECT_EQ(a * 2, 3);
+            a += 1;
+            b *= a;
+            EXPECT_EQ(a, 2.5);
+            EXPECT_EQ(b, 5);
+            EXPECT_LT(a, b);
+        }
+    } // namespace
+} // namespace gridtools
@@ -0,0 +1,134 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <gridtools/common/simd.hpp>
+
+#include <cstdint>
+#include <type_traits>
+
+#include <gtest/gtest.h>
+
+namespace gridtools {
+    namespace simd {
+        namespace {
+            using vec_t = vec<double, 4>;
+            using ref_t = ref<double, 4>;
+
+            TEST(simd, native_lanes) {
+                EXPECT_EQ(native_lanes<double>() * sizeof(double), GT_SIMD_BYTES);
+                EXPECT_EQ(native_lanes<float>(), 2 * native_lanes<double>());
+            }
+
+            TEST(simd, arithmetic) {
+                double data[] = {1, 2, 3, 4};
+                vec_t a = vec_t::load(data);
+                vec_t b = 2;
+                auto c = (a + b) * a - 1 / a;
+                static_assert(std::is_same<decltype(c), vec_t>::value, "");
+                for (int i = 0; i != 4; ++i)
+                    EXPECT_DOUBLE_EQ(c[i], (data[i] + 2) * data[i] - 1 / data[i]);
+                auto d = -a * 2.f;
+                for (int i = 0; i != 4; ++i)
+                    EXPECT_DOUBLE_EQ(d[i], -2 * data[i]);
+            }
+
+            TEST(simd, conversion) {
+                vec<float, 4> a = 1.5f;
+                auto b = a + 1.25;
+                static_assert(std::is_same<decltype(b), vec_t>::value, "");
+                for (int i = 0; i != 4; ++i)
+                    EXPECT_DOUBLE_EQ(b[i], 2.75);
+            }
+
+            TEST(simd, select) {
+                double data[] = {-2, 3, -1, 5};
+                vec_t a = vec_t::load(data);
+                auto m = a > 0;
+                EXPECT_FALSE(m[0]);
+                EXPECT_TRUE(m[1]);
+                auto b = select(m & (a < 4), a, 0);
+                EXPECT_EQ(b[0], 0);
+                EXPECT_EQ(b[1], 3);
+                EXPECT_EQ(b[2], 0);
+                EXPECT_EQ(b[3], 0);
+                auto c = select(!m, 1, a);
+                EXPECT_EQ(c[0], 1);
+                EXPECT_EQ(c[3], 5);
+                auto d = abs(a);
+                auto e = min(a, 1);
+                auto f = max(a, 1);
+                for (int i = 0; i != 4; ++i) {
+                    EXPECT_EQ(d[i], data[i] < 0 ? -data[i] : data[i]);
+                    EXPECT_EQ(e[i], data[i] < 1 ? data[i] : 1);
+                    EXPECT_EQ(f[i], data[i] > 1 ? data[i] : 1);
+                }
+            }
+
+            TEST(simd, ref) {
+                double src[] = {1, 2, 3, 4, 5};
+                double dst[] = {0, 0, 0, 0, 42};
+                ref<double const, 4> in = {src + 1};
+                ref_t out = {dst};
+                out = in;
+                EXPECT_EQ(dst[0], 2);
+                EXPECT_EQ(dst[3], 5);
+                EXPECT_EQ(dst[4], 42);
+                out += in * 2;
+                EXPECT_EQ(dst[0], 6);
+                EXPECT_EQ(dst[3], 15);
+                out = 7;
+                EXPECT_EQ(dst[2], 7);
+                EXPECT_EQ(dst[4], 42);
+                ref<float, 4> narrow = {nullptr};
+                float fdst[4];
+                narrow.m_ptr = fdst;
+                narrow = in + 0.5;
+                EXPECT_EQ(fdst[1], 3.5f);
+                EXPECT_EQ(sqrt(in)[2], std::sqrt(4.));
+            }
+
+            TEST(simd, interleave) {
+                int l_data[] = {0, 1, 2, 3};
+                int r_data[] = {10, 11, 12, 13};
+                auto l = vec<int, 4>::load(l_data);
+                auto r = vec<int, 4>::load(r_data);
+                auto low = interleave_low(l, r);
+                auto high = interleave_high(l, r);
+                EXPECT_EQ(low[0], 0);
+                EXPECT_EQ(low[1], 10);
+                EXPECT_EQ(low[2], 1);
+                EXPECT_EQ(low[3], 11);
+                EXPECT_EQ(high[0], 2);
+                EXPECT_EQ(high[1], 12);
+                EXPECT_EQ(high[2], 3);
+                EXPECT_EQ(high[3], 13);
+            }
+
+            template <class T, int N>
+            void test_transpose() {
+                vec<T, N> rows[N];
+                for (int i = 0; i != N; ++i)
+                    for (int j = 0; j != N; ++j)
+                        rows[i].m_data[j] = 100 * i + j;
+                transpose(rows);
+                for (int i = 0; i != N; ++i)
+                    for (int j = 0; j != N; ++j)
+                        EXPECT_EQ(rows[i][j], 100 * j + i);
+            }
+
+            TEST(simd, transpose) {
+                test_transpose<double, 2>();
+                test_transpose<double, 4>();
+                test_transpose<float, 8>();
+                test_transpose<std::uint64_t, 8>();
+                test_transpose<std::uint32_t, 16>();
+            }
+        } // namespace
+    }     // namespace simd
+} // namespace gridtools
@@ -260,6 +260,10 @@ namespace gridtools {
 
         TEST(pop_back, functional) { EXPECT_EQ(pop_back(std::make_tuple(1, 2, 3, 4)), std::make_tuple(1, 2, 3)); }
 
+        TEST(pop_back, heterogeneous) {
+            EXPECT_EQ(pop_back(std::make_tuple(1, 'a', 2.5)), std::make_tuple(1, 'a'));
+        }
+
         TEST(pop_front, functional) { EXPECT_EQ(pop_front(std::make_tuple(1, 2, 3, 4)), std::make_tuple(2, 3, 4)); }
 
         TEST(fold, functional) {
@@ -9,8 +9,13 @@
  */
 #include <gridtools/layout_transformation.hpp>
 
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
 #include <gtest/gtest.h>
 
+#include <gridtools/common/array.hpp>
 #include <gridtools/common/defs.hpp>
 #include <gridtools/common/generic_metafunctions/for_each.hpp>
 #include <gridtools/common/hypercube_iterator.hpp>
@@ -18,7 +23,6 @@
 #include <gridtools/meta.hpp>
 
 #ifdef GT_CUDACC
-#include <gridtools/common/array.hpp>
 #include <gridtools/common/cuda_util.hpp>
 #endif
 
@@ -129,4 +133,71 @@ namespace {
             }
         });
     }
+
+    // strides of the dense layout where `order[0]` is the innermost dimension, with padding of the innermost one
+    template <size_t N>
+    array<int, N> make_strides(array<int, N> const &dims, array<int, N> const &order, int padding = 0) {
+        array<int, N> res;
+        int stride = 1;
+        for (size_t n = 0; n != N; ++n) {
+            res[order[n]] = stride;
+            stride *= dims[order[n]] + (n == 0 ? padding : 0);
+        }
+        return res;
+    }
+
+    template <class T, size_t N>
+    void test_host_permutation(
+        array<int, N> const &dims, array<int, N> src_order, array<int, N> dst_order, int padding = 3) {
+        auto src_strides = make_strides(dims, src_order, padding);
+        auto dst_strides = make_strides(dims, dst_order);
+        size_t size = 1;
+        for (int d : dims)
+            size *= d;
+        std::vector<T> src(size * (1 + padding)), dst(size, T(-1));
+        for (auto i : make_hypercube_view(dims)) {
+            int offset = 0;
+            for (size_t d = 0; d != N; ++d)
+                offset += i[d] * src_strides[d];
+            src[offset] = T(offset);
+        }
+        transform_layout(dst.data(), src.data(), dims, dst_strides, src_strides);
+        for (auto i : make_hypercube_view(dims)) {
+            int src_offset = 0, dst_offset = 0;
+            for (size_t d = 0; d != N; ++d) {
+                src_offset += i[d] * src_strides[d];
+                dst_offset += i[d] * dst_strides[d];
+            }
+            ASSERT_EQ(dst[dst_offset], T(src_offset));
+        }
+    }
+
+    template <class T>
+    void test_host_permutations() {
+        // the sizes are not multiples of the tiles nor of the vector widths
+        array<int, 3> dims = {71, 37, 5};
+        array<int, 3> src_order = {0, 1, 2};
+        do {
+            array<int, 3> dst_order = {0, 1, 2};
+            do {
+                test_host_permutation<T>(dims, src_order, dst_order);
+            } while (std::next_permutation(dst_order.begin(), dst_order.end()));
+        } while (std::next_permutation(src_order.begin(), src_order.end()));
+    }
+
+    TEST(layout_transformation, host_permutations_double) { test_host_permutations<double>(); }
+
+    TEST(layout_transformation, host_permutations_float) { test_host_permutations<float>(); }
+
+    TEST(layout_transformation, host_permutations_short) { test_host_permutations<std::int16_t>(); }
+
+    TEST(layout_transformation, host_5D) {
+        array<int, 5> dims = {33, 3, 17, 2, 4};
+        test_host_permutation<double>(dims, {0, 1, 2, 3, 4}, {4, 3, 2, 1, 0});
+        test_host_permutation<double>(dims, {0, 1, 2, 3, 4}, {2, 0, 1, 3, 4});
+        test_host_permutation<float>(dims, {3, 0, 1, 2, 4}, {1, 4, 2, 0, 3});
+        // dense copies
+        test_host_permutation<double>(dims, {0, 1, 2, 3, 4}, {0, 1, 2, 3, 4}, 0);
+        test_host_permutation<double>(dims, {1, 0, 3, 2, 4}, {1, 0, 3, 2, 4}, 0);
+    }
 } // namespace
@@ -0,0 +1,223 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/sid/allocator.hpp>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/meta.hpp>
+
+namespace gridtools {
+    namespace {
+        struct counting_f {
+            int &m_count;
+            std::unique_ptr<char[]> operator()(size_t size) const {
+                ++m_count;
+                return std::make_unique<char[]>(size);
+            }
+        };
+
+        TEST(allocator, allocates_once) {
+            int count = 0;
+            auto alloc = sid::make_allocator(counting_f{count});
+            allocate(alloc, meta::lazy::id<double>(), 10);
+            allocate(alloc, meta::lazy::id<int>(), 3);
+            EXPECT_EQ(count, 2);
+        }
+
+        template <int>
+        struct tagged_f {
+            std::unique_ptr<char[]> operator()(size_t size) const { return std::make_unique<char[]>(size); }
+        };
+
+        TEST(size_class, rounding) {
+            EXPECT_EQ(sid::allocator_impl_::size_class(1), 256);
+            EXPECT_EQ(sid::allocator_impl_::size_class(256), 256);
+            EXPECT_EQ(sid::allocator_impl_::size_class(257), 320);
+            EXPECT_EQ(sid::allocator_impl_::size_class(1000), 1024);
+            EXPECT_EQ(sid::allocator_impl_::size_class(1025), 1280);
+            for (size_t size = 1; size < 100000; size = size * 3 / 2 + 1) {
+                auto res = sid::allocator_impl_::size_class(size);
+                EXPECT_GE(res, size);
+                EXPECT_TRUE(res == 256 || res < size / 4 * 5 + 1) << size;
+            }
+        }
+
+        struct placed_f {
+            int &m_count;
+            std::size_t m_placement;
+
+            std::unique_ptr<char[]> operator()(size_t size) const {
+                ++m_count;
+                return std::make_unique<char[]>(size);
+            }
+
+            friend std::size_t allocation_placement(placed_f const &obj) { return obj.m_placement; }
+        };
+
+        class pooled_allocator : public testing::Test {
+          protected:
+            std::size_t m_limit;
+            sid::pool_stats m_before;
+
+            void SetUp() override {
+                sid::release_pooled_memory();
+                m_limit = sid::get_pool_limit();
+                m_before = sid::get_pool_stats();
+            }
+
+            void TearDown() override {
+                sid::set_pool_limit(m_limit);
+                sid::release_pooled_memory();
+            }
+
+            sid::pool_stats delta() const {
+                auto res = sid::get_pool_stats();
+                res.hits -= m_before.hits;
+                res.misses -= m_before.misses;
+                res.evictions -= m_before.evictions;
+                return res;
+            }
+        };
+
+        TEST_F(pooled_allocator, reuse) {
+            {
+                auto alloc = sid::make_pooled_allocator(tagged_f<0>());
+                allocate(alloc, meta::lazy::id<double>(), 1000);
+                allocate(alloc, meta::lazy::id<double>(), 1000);
+                auto stats = delta();
+                EXPECT_EQ(stats.misses, 2);
+                EXPECT_EQ(stats.hits, 0);
+                EXPECT_EQ(stats.bytes_in_use, 2 * 8192);
+            }
+            auto stats = delta();
+            EXPECT_EQ(stats.bytes_in_use, 0);
+            EXPECT_EQ(stats.bytes_retained, 2 * 8192);
+            {
+                auto alloc = sid::make_pooled_allocator(tagged_f<0>());
+                // much smaller sizes are not served by the large buffers
+                allocate(alloc, meta::lazy::id<double>(), 100);
+                EXPECT_EQ(delta().misses, 3);
+                // a slightly smaller size is served from the pool
+                allocate(alloc, meta::lazy::id<double>(), 990);
+                allocate(alloc, meta::lazy::id<double>(), 1000);
+                EXPECT_EQ(delta().hits, 2);
+                EXPECT_EQ(delta().misses, 3);
+            }
+            EXPECT_EQ(delta().bytes_retained, 2 * 8192 + 896);
+            sid::release_pooled_memory();
+            stats = delta();
+            EXPECT_EQ(stats.bytes_retained, 0);
+            EXPECT_EQ(stats.evictions, 3);
+        }
+
+        TEST_F(pooled_allocator, buffers_are_not_shared_between_functors) {
+            {
+                auto alloc = sid::make_pooled_allocator(tagged_f<0>());
+                allocate(alloc, meta::lazy::id<char>(), 1024);
+            }
+            {
+                auto alloc = sid::make_pooled_allocator(tagged_f<1>());
+                allocate(alloc, meta::lazy::id<char>(), 1024);
+            }
+            EXPECT_EQ(delta().hits, 0);
+            EXPECT_EQ(delta().misses, 2);
+        }
+
+        TEST_F(pooled_allocator, limit) {
+            sid::set_pool_limit(3000);
+            {
+                auto alloc = sid::make_pooled_allocator(tagged_f<1>());
+                allocate(alloc, meta::lazy::id<char>(), 1024);
+                allocate(alloc, meta::lazy::id<char>(), 1024);
+                allocate(alloc, meta::lazy::id<char>(), 1024);
+                allocate(alloc, meta::lazy::id<char>(), 4096);
+            }
+            auto stats = delta();
+            EXPECT_LE(stats.bytes_retained, 3000);
+            EXPECT_EQ(stats.bytes_retained, 2048);
+            EXPECT_EQ(stats.evictions, 2);
+            sid::set_pool_limit(1024);
+            EXPECT_EQ(delta().bytes_retained, 1024);
+        }
+
+        TEST_F(pooled_allocator, limit_is_global) {
+            sid::set_pool_limit(3000);
+            {
+                auto first = sid::make_pooled_allocator(tagged_f<0>());
+                auto second = sid::make_pooled_allocator(tagged_f<1>());
+                auto third = sid::make_pooled_allocator(tagged_f<2>());
+                allocate(first, meta::lazy::id<char>(), 1024);
+                allocate(second, meta::lazy::id<char>(), 1024);
+                allocate(third, meta::lazy::id<char>(), 1024);
+                allocate(third, meta::lazy::id<char>(), 1024);
+            }
+            auto stats = delta();
+            EXPECT_EQ(stats.bytes_retained, 2048);
+            EXPECT_EQ(stats.evictions, 2);
+            // the least recently returned buffers (the ones of `third`, destroyed first) are gone
+            {
+                auto alloc = sid::make_pooled_allocator(tagged_f<2>());
+                allocate(alloc, meta::lazy::id<char>(), 1024);
+            }
+            EXPECT_EQ(delta().hits, 0);
+            {
+                auto alloc = sid::make_pooled_allocator(tagged_f<0>());
+                allocate(alloc, meta::lazy::id<char>(), 1024);
+            }
+            EXPECT_EQ(delta().hits, 1);
+        }
+
+        TEST_F(pooled_allocator, placement) {
+            int count = 0;
+            {
+                auto alloc = sid::make_pooled_allocator(placed_f{count, 4});
+                allocate(alloc, meta::lazy::id<char>(), 1000);
+            }
+            {
+                // another size or placement is not served by the stashed buffer
+                auto alloc = sid::make_pooled_allocator(placed_f{count, 4});
+                allocate(alloc, meta::lazy::id<char>(), 990);
+                auto other = sid::make_pooled_allocator(placed_f{count, 2});
+                allocate(other, meta::lazy::id<char>(), 1000);
+            }
+            EXPECT_EQ(count, 3);
+            {
+                auto alloc = sid::make_pooled_allocator(placed_f{count, 4});
+                allocate(alloc, meta::lazy::id<char>(), 1000);
+            }
+            EXPECT_EQ(count, 3);
+            EXPECT_EQ(delta().hits, 1);
+            EXPECT_EQ(delta().bytes_retained, 1000 + 990 + 1000);
+        }
+
+        TEST_F(pooled_allocator, threads) {
+            std::vector<std::thread> threads;
+            for (int t = 0; t != 4; ++t)
+                threads.emplace_back([t] {
+                    for (int n = 0; n != 100; ++n) {
+                        auto alloc = sid::make_pooled_allocator(tagged_f<2>());
+                        char *ptr = allocate(alloc, meta::lazy::id<char>(), 1000 + 100 * t)();
+                        ptr[999] = 1;
+                    }
+                });
+            for (auto &thread : threads)
+                thread.join();
+            auto stats = delta();
+            EXPECT_EQ(stats.hits + stats.misses, 400);
+            EXPECT_LE(stats.misses, 4 * 4);
+            EXPECT_EQ(stats.bytes_in_use, 0);
+        }
+    } // namespace
+} // namespace gridtools
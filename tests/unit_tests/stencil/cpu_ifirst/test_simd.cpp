@@ -0,0 +1,278 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/stencil/cpu_ifirst.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/common/halo_descriptor.hpp>
+#include <gridtools/stencil/cartesian.hpp>
+#include <gridtools/stencil/positional.hpp>
+#include <gridtools/storage/builder.hpp>
+#include <gridtools/storage/cpu_ifirst.hpp>
+#include <gridtools/storage/sid.hpp>
+#include <gridtools/thread_pool/omp.hpp>
+
+namespace gridtools {
+    namespace stencil {
+        namespace {
+            using namespace cartesian;
+
+            constexpr int halo = 2;
+            constexpr int i_size = 21;
+            constexpr int j_size = 11;
+            constexpr int k_size = 5;
+
+            using axis_t = axis<1, axis_config::offset_limit<3>>;
+            using kfull = axis_t::full_interval;
+
+            auto make_grid() {
+                halo_descriptor i_halo(halo, halo, halo, i_size + halo - 1, i_size + 2 * halo);
+                halo_descriptor j_halo(halo, halo, halo, j_size + halo - 1, j_size + 2 * halo);
+                return stencil::make_grid(i_halo, j_halo, axis_t(k_size));
+            }
+
+            template <class T = double>
+            auto builder() {
+                return storage::builder<storage::cpu_ifirst>
+                    .template type<T>()
+                    .dimensions(i_size + 2 * halo, j_size + 2 * halo, k_size);
+            }
+
+            double input(int i, int j, int k) { return std::sin(.3 * i + .2 * j) * std::cos(.1 * (i - j)) + k; }
+
+            struct lap_function {
+                using out = inout_accessor<0>;
+                using in = in_accessor<1, extent<-1, 1, -1, 1>>;
+                using param_list = make_param_list<out, in>;
+
+                template <class Eval>
+                GT_FUNCTION static void apply(Eval &&eval) {
+                    eval(out()) =
+                        4 * eval(in()) - (eval(in(1, 0)) + eval(in(0, 1)) + eval(in(-1, 0)) + eval(in(0, -1)));
+                }
+            };
+
+            template <int I, int J>
+            struct flux_function {
+                using out = inout_accessor<0>;
+                using in = in_accessor<1, extent<0, I, 0, J>>;
+                using lap = in_accessor<2, extent<0, I, 0, J>>;
+                using param_list = make_param_list<out, in, lap>;
+
+                template <class Eval>
+                GT_FUNCTION static void apply(Eval &&eval) {
+                    auto res = eval(lap(I, J)) - eval(lap());
+                    eval(out()) = select(res * (eval(in(I, J)) - eval(in())) > 0, 0, res);
+                }
+            };
+
+            struct out_function {
+                using out = inout_accessor<0>;
+                using in = in_accessor<1>;
+                using flx = in_accessor<2, extent<-1, 0, 0, 0>>;
+                using fly = in_accessor<3, extent<0, 0, -1, 0>>;
+                using coeff = in_accessor<4>;
+                using param_list = make_param_list<out, in, flx, fly, coeff>;
+
+                template <class Eval>
+                GT_FUNCTION static void apply(Eval &&eval) {
+                    auto div = eval(flx()) - eval(flx(-1, 0)) + eval(fly()) - eval(fly(0, -1));
+                    eval(out()) = eval(in()) - eval(coeff()) * div;
+                }
+            };
+
+            template <class Backend, class Spec>
+            void test_horizontal_diffusion(Spec spec) {
+                auto in = builder().initializer(input).build();
+                auto coeff = builder()
+                                 .template selector<0, 0, 1>()
+                                 .initializer([](int, int, int k) { return .1 + .05 * k; })
+                                 .build();
+                auto out = builder().value(-1).build();
+                run(spec, Backend(), make_grid(), in, coeff, out);
+
+                auto lap = [&](int i, int j, int k) {
+                    return 4 * input(i, j, k) -
+                           (input(i + 1, j, k) + input(i, j + 1, k) + input(i - 1, j, k) + input(i, j - 1, k));
+                };
+                auto flux = [&](int i, int j, int k, int di, int dj) {
+                    double res = lap(i + di, j + dj, k) - lap(i, j, k);
+                    return res * (input(i + di, j + dj, k) - input(i, j, k)) > 0 ? 0 : res;
+                };
+                auto view = out->const_host_view();
+                for (int i = 0; i < i_size + 2 * halo; ++i)
+                    for (int j = 0; j < j_size + 2 * halo; ++j)
+                        for (int k = 0; k < k_size; ++k) {
+                            if (i < halo || i >= i_size + halo || j < halo || j >= j_size + halo) {
+                                EXPECT_EQ(view(i, j, k), -1);
+                                continue;
+                            }
+                            double expected =
+                                input(i, j, k) - (.1 + .05 * k) * (flux(i, j, k, 1, 0) - flux(i - 1, j, k, 1, 0) +
+                                                                     flux(i, j, k, 0, 1) - flux(i, j - 1, k, 0, 1));
+                            EXPECT_NEAR(view(i, j, k), expected, 1e-12) << "i=" << i << " j=" << j << " k=" << k;
+                        }
+            }
+
+            template <class Backend>
+            void test_horizontal_diffusion() {
+                test_horizontal_diffusion<Backend>([](auto in, auto coeff, auto out) {
+                    GT_DECLARE_TMP(double, lap, flx, fly);
+                    return execute_parallel()
+                        .stage(lap_function(), lap, in)
+                        .stage(flux_function<1, 0>(), flx, in, lap)
+                        .stage(flux_function<0, 1>(), fly, in, lap)
+                        .stage(out_function(), out, in, flx, fly, coeff);
+                });
+                test_horizontal_diffusion<Backend>([](auto in, auto coeff, auto out) {
+                    GT_DECLARE_TMP(double, lap, flx, fly);
+                    return execute_forward()
+                        .ij_cached(lap, flx, fly)
+                        .stage(lap_function(), lap, in)
+                        .stage(flux_function<1, 0>(), flx, in, lap)
+                        .stage(flux_function<0, 1>(), fly, in, lap)
+                        .stage(out_function(), out, in, flx, fly, coeff);
+                });
+            }
+
+            using lanes_4_t = cpu_ifirst<thread_pool::omp,
+                integral_constant<int_t, 0>,
+                integral_constant<int_t, 0>,
+                integral_constant<int_t, 4>>;
+
+            using small_blocks_t = cpu_ifirst<thread_pool::omp,
+                integral_constant<int_t, 7>,
+                integral_constant<int_t, 3>,
+                integral_constant<int_t, 8>>;
+
+            TEST(cpu_ifirst_simd, horizontal_diffusion) {
+                test_horizontal_diffusion<cpu_ifirst_simd<>>();
+                test_horizontal_diffusion<lanes_4_t>();
+                test_horizontal_diffusion<small_blocks_t>();
+            }
+
+            struct cumulative_sum {
+                using out = inout_accessor<0, extent<0, 0, 0, 0, -1, 0>>;
+                using in = in_accessor<1>;
+                using param_list = make_param_list<out, in>;
+
+                template <class Eval>
+                GT_FUNCTION static void apply(Eval &&eval, kfull::modify<1, 0>) {
+                    eval(out()) = eval(out(0, 0, -1)) + eval(in());
+                }
+                template <class Eval>
+                GT_FUNCTION static void apply(Eval &&eval, kfull::first_level) {
+                    eval(out()) += eval(in());
+                }
+            };
+
+            template <class Backend>
+            void test_k_cache() {
+                auto in = builder().initializer(input).build();
+                auto out = builder().value(1).build();
+                run(
+                    [](auto in, auto out) {
+                        return execute_forward()
+                            .k_cached(cache_io_policy::fill(), cache_io_policy::flush(), out)
+                            .stage(cumulative_sum(), out, in);
+                    },
+                    Backend(),
+                    make_grid(),
+                    in,
+                    out);
+                auto view = out->const_host_view();
+                for (int i = halo; i < i_size + halo; ++i)
+                    for (int j = halo; j < j_size + halo; ++j) {
+                        double expected = 1;
+                        for (int k = 0; k < k_size; ++k) {
+                            expected += input(i, j, k);
+                            EXPECT_NEAR(view(i, j, k), expected, 1e-12);
+                        }
+                    }
+            }
+
+            TEST(cpu_ifirst_simd, k_cache) {
+                test_k_cache<cpu_ifirst_simd<>>();
+                test_k_cache<small_blocks_t>();
+            }
+
+            struct positions {
+                using out = inout_accessor<0>;
+                using i_pos = in_accessor<1>;
+                using j_pos = in_accessor<2>;
+                using scale = in_accessor<3>;
+                using param_list = make_param_list<out, i_pos, j_pos, scale>;
+
+                template <class Eval>
+                GT_FUNCTION static void apply(Eval &&eval) {
+                    eval(out()) = max(eval(i_pos()) * eval(scale()) - eval(j_pos()), 0);
+                }
+            };
+
+            template <class Backend>
+            void test_positional() {
+                auto scale = builder<float>()
+                                 .template selector<0, 1, 0>()
+                                 .initializer([](int, int j, int) { return j; })
+                                 .build();
+                auto out = builder().value(-1).build();
+                run_single_stage(positions(),
+                    Backend(),
+                    make_grid(),
+                    out,
+                    positional<dim::i>(),
+                    positional<dim::j>(),
+                    scale);
+                auto view = out->const_host_view();
+                for (int i = halo; i < i_size + halo; ++i)
+                    for (int j = halo; j < j_size + halo; ++j)
+                        for (int k = 0; k < k_size; ++k)
+                            EXPECT_EQ(view(i, j, k), std::max(i * j - j, 0));
+            }
+
+            TEST(cpu_ifirst_simd, positional_and_masked) {
+                test_positional<cpu_ifirst_simd<float>>();
+                test_positional<small_blocks_t>();
+            }
+
+            struct branching {
+                using out = inout_accessor<0>;
+                using in = in_accessor<1>;
+                using param_list = make_param_list<out, in>;
+                using vectorizable_t = std::false_type;
+
+                template <class Eval>
+                GT_FUNCTION static void apply(Eval &&eval) {
+                    if (eval(in()) > 2)
+                        eval(out()) = eval(in());
+                    else
+                        eval(out()) = -eval(in());
+                }
+            };
+
+            TEST(cpu_ifirst_simd, not_vectorizable) {
+                auto in = builder().initializer(input).build();
+                auto out = builder().value(0).build();
+                run_single_stage(branching(), cpu_ifirst_simd<>(), make_grid(), out, in);
+                auto view = out->const_host_view();
+                for (int i = halo; i < i_size + halo; ++i)
+                    for (int j = halo; j < j_size + halo; ++j)
+                        for (int k = 0; k < k_size; ++k) {
+                            double expected = input(i, j, k);
+                            EXPECT_EQ(view(i, j, k), expected > 2 ? expected : -expected);
+                        }
+            }
+        } // namespace
+    }     // namespace stencil
+} // namespace gridtools
@@ -24,7 +24,7 @@ using namespace cpu_ifirst_backend;
 static constexpr std::size_t byte_alignment = 64;
 
 TEST(tmp_storage_sid, allocator) {
-    tmp_allocator allocator;
+    tmp_allocator<thread_pool::omp> allocator;
 
     std::size_t n = 100;
     auto ptr_holder = allocate(allocator, meta::lazy::id<double>(), n);
@@ -42,7 +42,7 @@ TEST(tmp_storage_sid, nonzero_k_extents) {
     using extent_t = extent<-1, 2, -2, 3, -1, 2>;
     pos3<std::size_t> block_size{12, 2, 8};
 
-    tmp_allocator allocator;
+    tmp_allocator<thread_pool::omp> allocator;
     auto tmp = make_tmp_storage<double, extent_t, false, thread_pool::omp>(allocator, block_size);
 
     using tmp_t = decltype(tmp);
@@ -110,7 +110,7 @@ TEST(tmp_storage_sid, zero_k_extents) {
     using extent_t = extent<-1, 2, -2, 3, 0, 0>;
     pos3<std::size_t> block_size{12, 5, 1};
 
-    tmp_allocator allocator;
+    tmp_allocator<thread_pool::omp> allocator;
     auto tmp = make_tmp_storage<double, extent_t, true, thread_pool::omp>(allocator, block_size);
 
     using tmp_t = decltype(tmp);
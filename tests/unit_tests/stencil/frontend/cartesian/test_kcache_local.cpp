@@ -230,4 +230,64 @@ namespace {
             }
         TypeParam::verify(ref, out);
     }
+
+    struct accumulate_forward {
+        using in = in_accessor<0>;
+        using buff = inout_accessor<1, extent<0, 0, 0, 0, -1, 0>>;
+
+        using param_list = make_param_list<in, buff>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, kfull::first_level) {
+            eval(buff()) = eval(in());
+        }
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, kfull::modify<1, 0>) {
+            eval(buff()) = eval(buff(0, 0, -1)) + eval(in());
+        }
+    };
+
+    struct average_forward {
+        using buff = in_accessor<0, extent<0, 0, 0, 0, -1, 0>>;
+        using out = inout_accessor<1>;
+
+        using param_list = make_param_list<buff, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, kfull::first_level) {
+            eval(out()) = eval(buff());
+        }
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, kfull::modify<1, 0>) {
+            eval(out()) = (eval(buff()) + eval(buff(0, 0, -1))) / 2;
+        }
+    };
+
+    TYPED_TEST(test_kcache_local, two_stages_forward) {
+        auto out = TypeParam::make_storage();
+        auto spec = [](auto in, auto out) {
+            GT_DECLARE_TMP(double, tmp);
+            return execute_forward()
+                .k_cached(tmp)
+                .stage(accumulate_forward(), in, tmp)
+                .stage(average_forward(), tmp, out);
+        };
+        run(spec, stencil_backend_t(), TypeParam::make_grid(), TypeParam::make_storage(in), out);
+        auto ref = TypeParam::make_storage();
+        auto refv = ref->host_view();
+        auto buff = TypeParam::make_storage();
+        auto buffv = buff->host_view();
+        for (int i = 0; i < TypeParam::d(0); ++i)
+            for (int j = 0; j < TypeParam::d(1); ++j) {
+                buffv(i, j, 0) = in(i, j, 0);
+                refv(i, j, 0) = buffv(i, j, 0);
+                for (int k = 1; k < 10; ++k) {
+                    buffv(i, j, k) = buffv(i, j, k - 1) + in(i, j, k);
+                    refv(i, j, k) = (buffv(i, j, k) + buffv(i, j, k - 1)) / 2;
+                }
+            }
+        TypeParam::verify(ref, out);
+    }
 } // namespace
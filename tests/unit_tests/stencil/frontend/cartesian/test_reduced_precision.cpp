@@ -0,0 +1,68 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <cstdint>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/common/reduced_precision.hpp>
+#include <gridtools/stencil/cartesian.hpp>
+
+#include <stencil_select.hpp>
+#include <test_environment.hpp>
+
+namespace {
+    using namespace gridtools;
+    using namespace stencil;
+    using namespace cartesian;
+    using namespace expressions;
+
+    struct axpy {
+        using x = in_accessor<0>;
+        using y = in_accessor<1>;
+        using out = inout_accessor<2>;
+        using acc = inout_accessor<3>;
+        using param_list = make_param_list<x, y, out, acc>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval) {
+            static_assert(std::is_same<decltype(eval(x())), float>::value, "");
+            eval(out()) = 2 * eval(x()) + eval(y());
+            eval(acc()) += eval(x() * y());
+        }
+    };
+
+    using env_t = test_environment<>::apply<stencil_backend_t, double, inlined_params<12, 13, 9>>;
+
+    using fixed_t = fixed_point<std::int16_t, 4>;
+
+    TEST(reduced_precision, axpy) {
+        auto x = [](int i, int j, int k) { return i + .5 * j; };
+        auto y = [](int i, int j, int k) { return .25 * k - j; };
+        auto out = env_t::make_storage<float16_t>(0);
+        auto acc = env_t::make_storage<bfloat16_t>(1);
+        run_single_stage(axpy(),
+            stencil_backend_t(),
+            env_t::make_grid(),
+            env_t::make_const_storage<float16_t>(x),
+            env_t::make_storage<fixed_t>(y),
+            out,
+            acc);
+        auto out_view = out->const_host_view();
+        auto acc_view = acc->const_host_view();
+        for (int i = 0; i < 12; ++i)
+            for (int j = 0; j < 13; ++j)
+                for (int k = 0; k < 9; ++k) {
+                    // all the values are exactly representable
+                    EXPECT_EQ(out_view(i, j, k), 2 * x(i, j, k) + y(i, j, k));
+                    EXPECT_EQ(acc_view(i, j, k), bfloat16_t(1 + x(i, j, k) * y(i, j, k)));
+                }
+    }
+} // namespace
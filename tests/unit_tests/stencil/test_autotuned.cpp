@@ -0,0 +1,135 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/stencil/autotuned.hpp>
+
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/stencil/cartesian.hpp>
+#include <gridtools/stencil/cpu_ifirst.hpp>
+#include <gridtools/stencil/cpu_kfirst.hpp>
+#include <gridtools/storage/builder.hpp>
+#include <gridtools/storage/cpu_ifirst.hpp>
+#include <gridtools/storage/cpu_kfirst.hpp>
+#include <gridtools/storage/sid.hpp>
+#include <gridtools/thread_pool/omp.hpp>
+
+namespace gridtools {
+    namespace stencil {
+        namespace {
+            using namespace cartesian;
+            using autotuned_backend::tuning_key;
+            using autotuned_backend::tuning_table;
+
+            constexpr int runs_per_candidate = tuning_table::samples + 1;
+
+            TEST(tuning_table, tune) {
+                tuning_table testee;
+                tuning_key key = {42, 10, 20, 30, 4};
+
+                for (int candidate = 0; candidate != 3; ++candidate) {
+                    // the warm-up of each candidate is the slowest run
+                    EXPECT_EQ(testee.next(key, 3), candidate);
+                    testee.report(key, 3, candidate, 100);
+                    for (int sample = 0; sample != tuning_table::samples; ++sample) {
+                        EXPECT_EQ(testee.winner(key), -1);
+                        EXPECT_EQ(testee.next(key, 3), candidate);
+                        // the best sample counts
+                        testee.report(key, 3, candidate, sample == 1 ? candidate == 1 ? 1 : 2 : 50);
+                    }
+                }
+                EXPECT_EQ(testee.winner(key), 1);
+                EXPECT_EQ(testee.next(key, 3), 1);
+
+                tuning_key other = {42, 10, 20, 31, 4};
+                EXPECT_EQ(testee.winner(other), -1);
+                EXPECT_EQ(testee.next(other, 3), 0);
+            }
+
+            TEST(tuning_table, ignore_unexpected_reports) {
+                tuning_table testee;
+                tuning_key key = {1, 2, 3, 4, 5};
+
+                testee.report(key, 2, 0, 1);
+                testee.report(key, 2, 1, 1);
+                EXPECT_EQ(testee.next(key, 2), 0);
+                for (int run = 1; run != runs_per_candidate; ++run)
+                    testee.report(key, 2, 0, 2);
+                EXPECT_EQ(testee.next(key, 2), 1);
+                testee.report(key, 2, 0, 2);
+                for (int run = 0; run != runs_per_candidate; ++run)
+                    testee.report(key, 2, 1, 1);
+                EXPECT_EQ(testee.winner(key), 1);
+                testee.report(key, 2, 0, 0);
+                EXPECT_EQ(testee.winner(key), 1);
+            }
+
+            TEST(tuning_table, save_load) {
+                tuning_table src;
+                tuning_key key = {1234567890123ull, 2, 3, 4, 5};
+                for (int run = 0; run != runs_per_candidate; ++run)
+                    src.report(key, 1, 0, 1);
+                std::stringstream file;
+                src.save(file);
+
+                tuning_table testee;
+                testee.load(file);
+                EXPECT_EQ(testee.winner(key), 0);
+                EXPECT_EQ(testee.next(key, 1), 0);
+            }
+
+            struct accumulate_functor {
+                using in = in_accessor<0>;
+                using out = inout_accessor<1>;
+                using param_list = make_param_list<in, out>;
+
+                template <class Eval>
+                GT_FUNCTION static void apply(Eval &&eval) {
+                    eval(out()) = eval(in()) + eval(out());
+                }
+            };
+
+            template <class StorageTraits, class Backend>
+            void test_run_once_per_call() {
+                auto builder = storage::builder<StorageTraits>.template type<double>().dimensions(17, 13, 7);
+                auto in = builder.initializer([](int i, int j, int k) { return i + 2 * j + 3 * k; }).build();
+                auto out = builder.value(0).build();
+                auto grid = make_grid(17, 13, 7);
+                // three measured candidates and two tuned runs
+                int runs = 3 * runs_per_candidate + 2;
+                for (int n = 0; n != runs; ++n)
+                    run_single_stage(accumulate_functor(), Backend(), grid, in, out);
+                auto view = out->const_host_view();
+                for (int i = 0; i != 17; ++i)
+                    for (int j = 0; j != 13; ++j)
+                        for (int k = 0; k != 7; ++k)
+                            EXPECT_EQ(view(i, j, k), runs * (i + 2 * j + 3 * k));
+            }
+
+            TEST(autotuned, cpu_kfirst) {
+                test_run_once_per_call<storage::cpu_kfirst,
+                    autotuned<thread_pool::omp,
+                        cpu_kfirst<integral_constant<int_t, 8>, integral_constant<int_t, 8>>,
+                        cpu_kfirst<integral_constant<int_t, 16>, integral_constant<int_t, 2>>,
+                        cpu_kfirst<integral_constant<int_t, 4>, integral_constant<int_t, 4>>>>();
+            }
+
+            TEST(autotuned, cpu_ifirst) {
+                test_run_once_per_call<storage::cpu_ifirst,
+                    autotuned<thread_pool::omp,
+                        cpu_ifirst<>,
+                        cpu_ifirst<thread_pool::omp, integral_constant<int_t, 16>, integral_constant<int_t, 2>>,
+                        cpu_ifirst<thread_pool::omp, integral_constant<int_t, 5>, integral_constant<int_t, 3>>>>();
+            }
+        } // namespace
+    }     // namespace stencil
+} // namespace gridtools
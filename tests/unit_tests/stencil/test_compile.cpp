@@ -0,0 +1,233 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/stencil/frontend/compile.hpp>
+
+#include <cmath>
+#include <utility>
+
+#include <gtest/gtest.h>
+#include <omp.h>
+
+#include <gridtools/common/halo_descriptor.hpp>
+#include <gridtools/stencil/cartesian.hpp>
+#include <gridtools/stencil/cpu_ifirst.hpp>
+#include <gridtools/stencil/cpu_kfirst.hpp>
+#include <gridtools/stencil/naive.hpp>
+#include <gridtools/storage/builder.hpp>
+#include <gridtools/storage/cpu_ifirst.hpp>
+#include <gridtools/storage/cpu_kfirst.hpp>
+#include <gridtools/storage/sid.hpp>
+
+namespace gridtools {
+    namespace stencil {
+        namespace {
+            using namespace cartesian;
+
+            constexpr int halo = 1;
+            constexpr int i_size = 13;
+            constexpr int j_size = 9;
+            constexpr int k_size = 7;
+
+            using axis_t = axis<1, axis_config::offset_limit<3>>;
+            using kfull = axis_t::full_interval;
+
+            auto make_grid() {
+                halo_descriptor i_halo(halo, halo, halo, i_size + halo - 1, i_size + 2 * halo);
+                halo_descriptor j_halo(halo, halo, halo, j_size + halo - 1, j_size + 2 * halo);
+                return stencil::make_grid(i_halo, j_halo, axis_t(k_size));
+            }
+
+            struct lap_function {
+                using out = inout_accessor<0>;
+                using in = in_accessor<1, extent<-1, 1, -1, 1>>;
+                using param_list = make_param_list<out, in>;
+
+                template <class Eval>
+                GT_FUNCTION static void apply(Eval &&eval) {
+                    eval(out()) =
+                        4 * eval(in()) - (eval(in(1, 0)) + eval(in(0, 1)) + eval(in(-1, 0)) + eval(in(0, -1)));
+                }
+            };
+
+            struct scale_function {
+                using out = inout_accessor<0>;
+                using in = in_accessor<1>;
+                using coeff = in_accessor<2>;
+                using param_list = make_param_list<out, in, coeff>;
+
+                template <class Eval>
+                GT_FUNCTION static void apply(Eval &&eval) {
+                    eval(out()) = eval(coeff()) * eval(in());
+                }
+            };
+
+            struct cumulative_sum {
+                using out = inout_accessor<0, extent<0, 0, 0, 0, -1, 0>>;
+                using in = in_accessor<1>;
+                using param_list = make_param_list<out, in>;
+
+                template <class Eval>
+                GT_FUNCTION static void apply(Eval &&eval, kfull::modify<1, 0>) {
+                    eval(out()) = eval(out(0, 0, -1)) + eval(in());
+                }
+                template <class Eval>
+                GT_FUNCTION static void apply(Eval &&eval, kfull::first_level) {
+                    eval(out()) = eval(in());
+                }
+            };
+
+            // a temporary, an ij-cache and a k-cache
+            auto spec = [](auto in, auto coeff, auto out) {
+                GT_DECLARE_TMP(double, lap, scaled, sum);
+                return multi_pass(execute_parallel()
+                                      .ij_cached(lap)
+                                      .stage(lap_function(), lap, in)
+                                      .stage(scale_function(), scaled, lap, coeff),
+                    execute_forward().k_cached(sum).stage(cumulative_sum(), sum, scaled).stage(
+                        scale_function(), out, sum, coeff));
+            };
+
+            template <class StorageTraits, class T = double>
+            auto builder() {
+                return storage::builder<StorageTraits>
+                    .template type<T>()
+                    .dimensions(i_size + 2 * halo, j_size + 2 * halo, k_size);
+            }
+
+            template <class StorageTraits, class Backend>
+            void test_compile() {
+                auto coeff = builder<StorageTraits>().value(.5).build();
+                auto stencil = compile(spec, Backend(), make_grid());
+                auto moved = std::move(stencil);
+                for (int n = 0; n != 3; ++n) {
+                    auto in = builder<StorageTraits>()
+                                  .initializer([n](int i, int j, int k) { return std::sin(i + n) * std::cos(j) + k; })
+                                  .build();
+                    auto actual = builder<StorageTraits>().value(-1).build();
+                    auto expected = builder<StorageTraits>().value(-1).build();
+                    moved(in, coeff, actual);
+                    run(spec, Backend(), make_grid(), in, coeff, expected);
+                    auto actual_view = actual->const_host_view();
+                    auto expected_view = expected->const_host_view();
+                    for (int i = 0; i < i_size + 2 * halo; ++i)
+                        for (int j = 0; j < j_size + 2 * halo; ++j)
+                            for (int k = 0; k < k_size; ++k)
+                                EXPECT_EQ(actual_view(i, j, k), expected_view(i, j, k))
+                                    << "n=" << n << " i=" << i << " j=" << j << " k=" << k;
+                }
+            }
+
+            TEST(compile, cpu_kfirst) {
+                test_compile<storage::cpu_kfirst, cpu_kfirst<>>();
+                test_compile<storage::cpu_kfirst,
+                    cpu_kfirst<integral_constant<int_t, 5>,
+                        integral_constant<int_t, 4>,
+                        thread_pool::omp,
+                        integral_constant<int_t, 3>>>();
+            }
+
+            TEST(compile, cpu_ifirst) {
+                test_compile<storage::cpu_ifirst, cpu_ifirst<>>();
+                test_compile<storage::cpu_ifirst, cpu_ifirst_simd<double>>();
+            }
+
+            template <class StorageTraits, class Backend>
+            void test_more_threads() {
+                int max_threads = omp_get_max_threads();
+                omp_set_num_threads(1);
+                auto coeff = builder<StorageTraits>().value(.5).build();
+                auto in = builder<StorageTraits>()
+                              .initializer([](int i, int j, int k) { return std::sin(i) * std::cos(j) + k; })
+                              .build();
+                auto stencil = compile(spec, Backend(), make_grid());
+                auto actual = builder<StorageTraits>().value(-1).build();
+                stencil(in, coeff, actual);
+                // more threads than the temporaries were made for
+                omp_set_num_threads(4);
+                stencil(in, coeff, actual);
+                auto expected = builder<StorageTraits>().value(-1).build();
+                run(spec, Backend(), make_grid(), in, coeff, expected);
+                omp_set_num_threads(max_threads);
+                auto actual_view = actual->const_host_view();
+                auto expected_view = expected->const_host_view();
+                for (int i = 0; i < i_size + 2 * halo; ++i)
+                    for (int j = 0; j < j_size + 2 * halo; ++j)
+                        for (int k = 0; k < k_size; ++k)
+                            EXPECT_EQ(actual_view(i, j, k), expected_view(i, j, k))
+                                << "i=" << i << " j=" << j << " k=" << k;
+            }
+
+            TEST(compile, more_threads) {
+                test_more_threads<storage::cpu_kfirst,
+                    cpu_kfirst<integral_constant<int_t, 4>, integral_constant<int_t, 2>>>();
+                test_more_threads<storage::cpu_ifirst,
+                    cpu_ifirst<thread_pool::omp, integral_constant<int_t, 4>, integral_constant<int_t, 2>>>();
+            }
+
+            TEST(compile, naive) { test_compile<storage::cpu_kfirst, naive>(); }
+
+            TEST(compile, field_types_change) {
+                auto stencil = compile(
+                    [](auto in, auto out) { return execute_parallel().stage(lap_function(), out, in); },
+                    cpu_kfirst<>(),
+                    make_grid());
+                auto in_f = builder<storage::cpu_kfirst, float>().initializer([](int i, int j, int) { return i * j; });
+                auto in_d = builder<storage::cpu_kfirst, double>().initializer([](int i, int j, int) { return i * j; });
+                auto out_f = builder<storage::cpu_kfirst, float>().value(-1).build();
+                auto out_d = builder<storage::cpu_kfirst, double>().value(-1).build();
+                stencil(in_f.build(), out_f);
+                stencil(in_d.build(), out_d);
+                stencil(in_f.build(), out_f);
+                auto view_f = out_f->const_host_view();
+                auto view_d = out_d->const_host_view();
+                for (int i = halo; i < i_size + halo; ++i)
+                    for (int j = halo; j < j_size + halo; ++j)
+                        for (int k = 0; k < k_size; ++k) {
+                            EXPECT_EQ(view_f(i, j, k), 0);
+                            EXPECT_EQ(view_d(i, j, k), 0);
+                        }
+            }
+
+            template <class StorageTraits, class Backend>
+            void test_strides_change() {
+                auto lap = [](auto in, auto out) { return execute_parallel().stage(lap_function(), out, in); };
+                auto stencil = compile(lap, Backend(), make_grid());
+                // the loops are built for the strides of the first fields and again for the padded ones
+                for (int pad : {0, 3, 0, 3}) {
+                    auto make_storage = [pad](double value) {
+                        return storage::builder<StorageTraits>
+                            .template type<double>()
+                            .dimensions(i_size + 2 * halo + pad, j_size + 2 * halo + pad, k_size)
+                            .initializer([value](int i, int j, int k) { return value * std::sin(i) * std::cos(j) + k; })
+                            .build();
+                    };
+                    auto in = make_storage(pad + 1);
+                    auto actual = make_storage(0);
+                    auto expected = make_storage(0);
+                    stencil(in, actual);
+                    run(lap, Backend(), make_grid(), in, expected);
+                    auto actual_view = actual->const_host_view();
+                    auto expected_view = expected->const_host_view();
+                    for (int i = 0; i < i_size + 2 * halo + pad; ++i)
+                        for (int j = 0; j < j_size + 2 * halo + pad; ++j)
+                            for (int k = 0; k < k_size; ++k)
+                                EXPECT_EQ(actual_view(i, j, k), expected_view(i, j, k))
+                                    << "pad=" << pad << " i=" << i << " j=" << j << " k=" << k;
+                }
+            }
+
+            TEST(compile, strides_change) {
+                test_strides_change<storage::cpu_kfirst, cpu_kfirst<>>();
+                test_strides_change<storage::cpu_ifirst, cpu_ifirst<>>();
+            }
+        } // namespace
+    }     // namespace stencil
+} // namespace gridtools
@@ -0,0 +1,108 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <atomic>
+#include <type_traits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/common/halo_descriptor.hpp>
+#include <gridtools/stencil/cartesian.hpp>
+#include <gridtools/stencil/cpu_ifirst.hpp>
+#include <gridtools/stencil/cpu_kfirst.hpp>
+#include <gridtools/storage/builder.hpp>
+#include <gridtools/storage/cpu_ifirst.hpp>
+#include <gridtools/storage/cpu_kfirst.hpp>
+#include <gridtools/storage/sid.hpp>
+#include <gridtools/thread_pool/omp.hpp>
+
+namespace gridtools {
+    namespace stencil {
+        namespace {
+            using namespace cartesian;
+
+            template <class Backend, class KParallel = std::false_type>
+            void test_covers_domain_once() {
+                int i_size = 37, j_size = 23, k_size = 11;
+                std::vector<std::atomic<int>> hits(i_size * j_size * k_size);
+                first_touch_blocks(Backend(), KParallel())(i_size,
+                    j_size,
+                    k_size,
+                    [&](int i_begin, int i_end, int j_begin, int j_end, int k_begin, int k_end) {
+                        for (int i = i_begin; i < i_end; ++i)
+                            for (int j = j_begin; j < j_end; ++j)
+                                for (int k = k_begin; k < k_end; ++k)
+                                    ++hits[i + i_size * (j + j_size * k)];
+                    });
+                for (auto &&hit : hits)
+                    EXPECT_EQ(hit, 1);
+            }
+
+            TEST(first_touch_blocks, cpu_kfirst) {
+                test_covers_domain_once<cpu_kfirst<>>();
+                test_covers_domain_once<cpu_kfirst<integral_constant<int_t, 5>, integral_constant<int_t, 64>>>();
+                using tiled_t = cpu_kfirst<integral_constant<int_t, 8>,
+                    integral_constant<int_t, 8>,
+                    thread_pool::omp,
+                    integral_constant<int_t, 4>>;
+                test_covers_domain_once<tiled_t>();
+                test_covers_domain_once<tiled_t, std::true_type>();
+            }
+
+            TEST(first_touch_blocks, cpu_ifirst) {
+                test_covers_domain_once<cpu_ifirst<>>();
+                test_covers_domain_once<cpu_ifirst<>, std::true_type>();
+                test_covers_domain_once<
+                    cpu_ifirst<thread_pool::omp, integral_constant<int_t, 4>, integral_constant<int_t, 6>>>();
+                test_covers_domain_once<
+                    cpu_ifirst<thread_pool::omp, integral_constant<int_t, 4>, integral_constant<int_t, 6>>,
+                    std::true_type>();
+            }
+
+            struct copy_functor {
+                using in = in_accessor<0>;
+                using out = inout_accessor<1>;
+                using param_list = make_param_list<in, out>;
+
+                template <class Eval>
+                GT_FUNCTION static void apply(Eval &&eval) {
+                    eval(out()) = eval(in());
+                }
+            };
+
+            template <class StorageTraits, class Backend>
+            void test_copy() {
+                int halo = 2;
+                halo_descriptor i_halo(halo, halo, halo, 17 + halo - 1, 17 + 2 * halo);
+                halo_descriptor j_halo(halo, halo, halo, 13 + halo - 1, 13 + 2 * halo);
+                auto builder = storage::builder<StorageTraits>
+                                   .template type<double>()
+                                   .dimensions(17 + 2 * halo, 13 + 2 * halo, 7)
+                                   .halos(halo, halo, 0)
+                                   .first_touch(first_touch_blocks(Backend()));
+                auto in = builder.initializer([](int i, int j, int k) { return i + 2 * j + 3 * k; }).build();
+                auto out = builder.value(-1).build();
+                run_single_stage(copy_functor(), Backend(), make_grid(i_halo, j_halo, 7), in, out);
+                auto view = out->const_host_view();
+                for (int i = 0; i != 17 + 2 * halo; ++i)
+                    for (int j = 0; j != 13 + 2 * halo; ++j)
+                        for (int k = 0; k != 7; ++k) {
+                            bool inner = i >= halo && i < 17 + halo && j >= halo && j < 13 + halo;
+                            EXPECT_EQ(view(i, j, k), inner ? i + 2 * j + 3 * k : -1);
+                        }
+            }
+
+            TEST(first_touch, cpu_kfirst) { test_copy<storage::cpu_kfirst, cpu_kfirst<>>(); }
+
+            TEST(first_touch, cpu_ifirst) { test_copy<storage::cpu_ifirst, cpu_ifirst<>>(); }
+        } // namespace
+    }     // namespace stencil
+} // namespace gridtools
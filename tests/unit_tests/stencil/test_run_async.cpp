@@ -0,0 +1,169 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/stencil/frontend/run_async.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/stencil/cartesian.hpp>
+#include <gridtools/stencil/cpu_kfirst.hpp>
+#include <gridtools/storage/builder.hpp>
+#include <gridtools/storage/cpu_kfirst.hpp>
+#include <gridtools/storage/sid.hpp>
+#include <gridtools/thread_pool/work_stealing.hpp>
+
+namespace gridtools {
+    namespace stencil {
+        namespace {
+            using namespace cartesian;
+
+            struct add_one {
+                using out = inout_accessor<0>;
+                using in = in_accessor<1>;
+                using param_list = make_param_list<out, in>;
+
+                template <class Eval>
+                GT_FUNCTION static void apply(Eval &&eval) {
+                    eval(out()) = eval(in()) + 1;
+                }
+            };
+
+            struct sum {
+                using out = inout_accessor<0>;
+                using lhs = in_accessor<1>;
+                using rhs = in_accessor<2>;
+                using param_list = make_param_list<out, lhs, rhs>;
+
+                template <class Eval>
+                GT_FUNCTION static void apply(Eval &&eval) {
+                    eval(out()) = eval(lhs()) + eval(rhs());
+                }
+            };
+
+            const auto builder = storage::builder<storage::cpu_kfirst>.type<double>().dimensions(11, 7, 5);
+
+            template <class Storage>
+            void expect_all(Storage const &storage, double expected) {
+                auto view = storage->const_host_view();
+                for (int i = 0; i < 11; ++i)
+                    for (int j = 0; j < 7; ++j)
+                        for (int k = 0; k < 5; ++k)
+                            EXPECT_EQ(view(i, j, k), expected);
+            }
+
+            TEST(run_async, ping_pong) {
+                auto a = builder.value(0).build();
+                auto b = builder.value(0).build();
+                auto grid = make_grid(11, 7, 5);
+                std::shared_future<void> last;
+                for (int n = 0; n != 20; ++n) {
+                    last = run_async([](auto out, auto in) { return execute_parallel().stage(add_one(), out, in); },
+                        cpu_kfirst<>(),
+                        grid,
+                        b,
+                        a);
+                    std::swap(a, b);
+                }
+                last.get();
+                expect_all(a, 20);
+            }
+
+            TEST(run_async, diamond) {
+                auto in = builder.value(1).build();
+                auto left = builder.value(0).build();
+                auto right = builder.value(0).build();
+                auto out = builder.value(0).build();
+                auto grid = make_grid(11, 7, 5);
+                auto inc = [](auto out, auto in) { return execute_parallel().stage(add_one(), out, in); };
+                auto add = [](auto out, auto lhs, auto rhs) { return execute_parallel().stage(sum(), out, lhs, rhs); };
+                run_async(inc, cpu_kfirst<>(), grid, left, in);
+                run_async(inc, cpu_kfirst<>(), grid, right, in);
+                auto done = run_async(add, cpu_kfirst<>(), grid, out, left, right);
+                // overwrites the input of the first two computations
+                run_async(inc, cpu_kfirst<>(), grid, in, out);
+                done.get();
+                expect_all(out, 4);
+                async_scheduler::instance().wait_all();
+                expect_all(in, 5);
+            }
+
+            TEST(run_async, work_stealing) {
+                using backend_t =
+                    cpu_kfirst<integral_constant<int_t, 4>, integral_constant<int_t, 4>, thread_pool::work_stealing>;
+                auto in = builder.value(1).build();
+                auto left = builder.value(0).build();
+                auto right = builder.value(0).build();
+                auto grid = make_grid(11, 7, 5);
+                auto inc = [](auto out, auto in) { return execute_parallel().stage(add_one(), out, in); };
+                // independent, each of them runs its loops on its share of the workers
+                for (int n = 0; n != 10; ++n) {
+                    run_async(inc, backend_t(), grid, left, in);
+                    run_async(inc, backend_t(), grid, right, in);
+                    run_async(inc, backend_t(), grid, in, left);
+                }
+                async_scheduler::instance().wait_all();
+                expect_all(left, 20);
+                expect_all(right, 20);
+                expect_all(in, 21);
+            }
+
+            TEST(async_scheduler, independent_tasks_overlap) {
+                async_scheduler scheduler(2);
+                std::atomic<bool> flag{false};
+                int a, b;
+                auto waiting = scheduler.submit(
+                    [&] {
+                        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+                        while (!flag && std::chrono::steady_clock::now() < deadline)
+                            std::this_thread::yield();
+                        if (!flag)
+                            throw std::runtime_error("not concurrent");
+                    },
+                    {{&a, true}});
+                scheduler.submit([&] { flag = true; }, {{&b, true}});
+                EXPECT_NO_THROW(waiting.get());
+            }
+
+            TEST(async_scheduler, ordering) {
+                async_scheduler scheduler(4);
+                int a, b;
+                std::atomic<int> writes{0};
+                std::atomic<int> seen{-1};
+                scheduler.submit(
+                    [&] {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                        ++writes;
+                    },
+                    {{&a, true}});
+                // reads a: has to wait for the writer
+                auto reader = scheduler.submit([&] { seen = writes.load(); }, {{&a, false}, {&b, true}});
+                reader.get();
+                EXPECT_EQ(seen, 1);
+            }
+
+            TEST(async_scheduler, exceptions_propagate) {
+                async_scheduler scheduler(2);
+                int a;
+                bool executed = false;
+                auto failing = scheduler.submit([] { throw std::runtime_error("failure"); }, {{&a, true}});
+                auto dependent = scheduler.submit([&] { executed = true; }, {{&a, false}});
+                EXPECT_THROW(failing.get(), std::runtime_error);
+                EXPECT_THROW(dependent.get(), std::runtime_error);
+                EXPECT_FALSE(executed);
+                scheduler.wait_all();
+            }
+        } // namespace
+    }     // namespace stencil
+} // namespace gridtools
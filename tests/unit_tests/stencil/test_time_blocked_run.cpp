@@ -0,0 +1,130 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/stencil/frontend/time_blocked_run.hpp>
+
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/common/halo_descriptor.hpp>
+#include <gridtools/stencil/cartesian.hpp>
+#include <gridtools/stencil/cpu_ifirst.hpp>
+#include <gridtools/stencil/cpu_kfirst.hpp>
+#include <gridtools/stencil/naive.hpp>
+#include <gridtools/storage/builder.hpp>
+#include <gridtools/storage/cpu_ifirst.hpp>
+#include <gridtools/storage/cpu_kfirst.hpp>
+#include <gridtools/storage/sid.hpp>
+
+namespace gridtools {
+    namespace stencil {
+        namespace {
+            using namespace cartesian;
+
+            constexpr int halo = 3;
+            constexpr int i_size = 45;
+            constexpr int j_size = 29;
+            constexpr int k_size = 6;
+
+            using axis_t = axis<1, axis_config::offset_limit<3>>;
+            using kfull = axis_t::full_interval;
+
+            auto make_grid() {
+                halo_descriptor i_halo(halo, halo, halo, i_size + halo - 1, i_size + 2 * halo);
+                halo_descriptor j_halo(halo, halo, halo, j_size + halo - 1, j_size + 2 * halo);
+                return stencil::make_grid(i_halo, j_halo, axis_t(k_size));
+            }
+
+            double initial(int i, int j, int k) { return std::sin(.4 * i) * std::cos(.3 * j) + .1 * k; }
+
+            struct lap_function {
+                using out = inout_accessor<0>;
+                using in = in_accessor<1, extent<-1, 1, -1, 1>>;
+                using param_list = make_param_list<out, in>;
+
+                template <class Eval>
+                GT_FUNCTION static void apply(Eval &&eval) {
+                    eval(out()) =
+                        4 * eval(in()) - (eval(in(1, 0)) + eval(in(0, 1)) + eval(in(-1, 0)) + eval(in(0, -1)));
+                }
+            };
+
+            struct smooth_function {
+                using out = inout_accessor<0>;
+                using in = in_accessor<1, extent<0, 0, 0, 0, -1, 1>>;
+                using lap = in_accessor<2, extent<-1, 1, -1, 1>>;
+                using coeff = in_accessor<3>;
+                using param_list = make_param_list<out, in, lap, coeff>;
+
+                template <class Eval>
+                GT_FUNCTION static void apply(Eval &&eval, kfull::modify<1, -1>) {
+                    eval(out()) = .5 * eval(in()) + .25 * (eval(in(0, 0, -1)) + eval(in(0, 0, 1))) -
+                                  eval(coeff()) * (eval(lap(1, 0)) + eval(lap(-1, 0)) + eval(lap(0, 1)) +
+                                                      eval(lap(0, -1)) - 4 * eval(lap()));
+                }
+
+                template <class Eval>
+                GT_FUNCTION static void apply(Eval &&eval, kfull::first_level) {
+                    eval(out()) = eval(in()) - eval(coeff()) * (eval(lap(1, 0)) - eval(lap()));
+                }
+
+                template <class Eval>
+                GT_FUNCTION static void apply(Eval &&eval, kfull::last_level) {
+                    eval(out()) = eval(in()) - eval(coeff()) * (eval(lap(0, 1)) - eval(lap()));
+                }
+            };
+
+            // halo 2 in i and j, 1 in k, with a temporary
+            auto spec = [](auto in, auto out, auto coeff) {
+                GT_DECLARE_TMP(double, lap);
+                return execute_parallel().stage(lap_function(), lap, in).stage(smooth_function(), out, in, lap, coeff);
+            };
+
+            template <class StorageTraits, class Backend, size_t TimeBlock, size_t ITile, size_t JTile>
+            void test_time_blocked(size_t steps) {
+                auto builder = storage::builder<StorageTraits>.template type<double>().dimensions(
+                    i_size + 2 * halo, j_size + 2 * halo, k_size);
+                auto coeff = builder.value(.02).build();
+                auto expected_a = builder.initializer(initial).build();
+                auto expected_b = builder.initializer(initial).build();
+                auto a = builder.initializer(initial).build();
+                auto b = builder.initializer(initial).build();
+
+                for (size_t n = 0; n != steps; ++n) {
+                    run(spec, Backend(), make_grid(), expected_a, expected_b, coeff);
+                    std::swap(expected_a, expected_b);
+                }
+                time_blocked_run<TimeBlock, ITile, JTile>(spec, Backend(), make_grid(), steps, a, b, coeff);
+
+                auto actual = a->const_host_view();
+                auto expected = expected_a->const_host_view();
+                for (int i = 0; i < i_size + 2 * halo; ++i)
+                    for (int j = 0; j < j_size + 2 * halo; ++j)
+                        for (int k = 0; k < k_size; ++k)
+                            EXPECT_NEAR(actual(i, j, k), expected(i, j, k), 1e-12)
+                                << "i=" << i << " j=" << j << " k=" << k;
+            }
+
+            TEST(time_blocked_run, cpu_kfirst) {
+                test_time_blocked<storage::cpu_kfirst, cpu_kfirst<>, 4, 16, 8>(7);
+                test_time_blocked<storage::cpu_kfirst, cpu_kfirst<>, 3, 64, 32>(6);
+            }
+
+            TEST(time_blocked_run, cpu_ifirst) {
+                test_time_blocked<storage::cpu_ifirst, cpu_ifirst<>, 4, 16, 8>(7);
+                test_time_blocked<storage::cpu_ifirst, cpu_ifirst<>, 2, 13, 5>(5);
+                test_time_blocked<storage::cpu_ifirst, cpu_ifirst<>, 8, 50, 40>(3);
+            }
+
+            TEST(time_blocked_run, naive) { test_time_blocked<storage::cpu_kfirst, naive, 4, 16, 8>(5); }
+        } // namespace
+    }     // namespace stencil
+} // namespace gridtools
@@ -11,8 +11,15 @@
 #include <gtest/gtest.h>
 
 #include <cpp_bindgen/fortran_array_view.hpp>
+#include <gridtools/sid/concept.hpp>
+#include <gridtools/stencil/cartesian.hpp>
+#include <gridtools/stencil/naive.hpp>
+#ifdef GT_STENCIL_CPU_IFIRST
+#include <gridtools/stencil/cpu_ifirst.hpp>
+#endif
 #include <gridtools/storage/adapter/fortran_array_adapter.hpp>
 #include <gridtools/storage/builder.hpp>
+#include <gridtools/storage/cpu_ifirst.hpp>
 #include <gridtools/storage/cpu_kfirst.hpp>
 
 const auto builder = gridtools::storage::builder<gridtools::storage::cpu_kfirst>.type<double>();
@@ -85,3 +92,78 @@ TEST(FortranArrayAdapter, TransformDataStoreIntoAdapter) {
             for (size_t x = 0; x < x_size; ++x, ++i)
                 EXPECT_EQ(fortran_array[z][y][x], i);
 }
+
+namespace bind_test {
+    using namespace gridtools;
+    using namespace stencil;
+    using namespace cartesian;
+
+    constexpr int x_size = 6;
+    constexpr int y_size = 5;
+    constexpr int z_size = 4;
+
+    struct double_functor {
+        using in = in_accessor<0>;
+        using out = inout_accessor<1>;
+        using param_list = make_param_list<in, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval) {
+            eval(out()) = 2 * eval(in());
+        }
+    };
+
+    bindgen_fortran_array_descriptor make_descriptor(double (&array)[z_size][y_size][x_size]) {
+        bindgen_fortran_array_descriptor res;
+        res.rank = 3;
+        res.dims[0] = x_size;
+        res.dims[1] = y_size;
+        res.dims[2] = z_size;
+        res.type = bindgen_fk_Double;
+        res.data = array;
+        res.is_acc_present = false;
+        return res;
+    }
+
+    template <class StorageTraits, class Backend = naive>
+    void test_bind(bool zero_copy) {
+        double in_array[z_size][y_size][x_size];
+        double out_array[z_size][y_size][x_size];
+        for (int z = 0; z < z_size; ++z)
+            for (int y = 0; y < y_size; ++y)
+                for (int x = 0; x < x_size; ++x) {
+                    in_array[z][y][x] = 100 * z + 10 * y + x;
+                    out_array[z][y][x] = -1;
+                }
+        auto in_descriptor = make_descriptor(in_array);
+        auto out_descriptor = make_descriptor(out_array);
+
+        auto builder = storage::builder<StorageTraits>.template type<double>().dimensions(x_size, y_size, z_size);
+        auto in_ds = builder();
+        auto out_ds = builder();
+        auto in = fortran_array_adapter<decltype(in_ds)>(in_descriptor).bind(in_ds);
+        auto out = fortran_array_adapter<decltype(out_ds)>(out_descriptor).bind(out_ds);
+        static_assert(is_sid<decltype(in)>::value, "");
+        EXPECT_EQ(in.is_zero_copy(), zero_copy);
+        EXPECT_EQ(sid::get_origin(in)() == &in_array[0][0][0], zero_copy);
+
+        run_single_stage(double_functor(), Backend(), make_grid(x_size, y_size, z_size), in, out);
+        out.sync();
+
+        for (int z = 0; z < z_size; ++z)
+            for (int y = 0; y < y_size; ++y)
+                for (int x = 0; x < x_size; ++x)
+                    EXPECT_EQ(out_array[z][y][x], 2 * in_array[z][y][x]);
+    }
+
+    TEST(FortranArrayAdapter, BindZeroCopy) { test_bind<storage::cpu_ifirst>(true); }
+
+    TEST(FortranArrayAdapter, BindCopy) { test_bind<storage::cpu_kfirst>(false); }
+
+#ifdef GT_STENCIL_CPU_IFIRST
+    // the unit i-stride of the zero copy sid is a compile time constant, so the vectorized loops apply
+    TEST(FortranArrayAdapter, BindZeroCopyCpuIfirst) { test_bind<storage::cpu_ifirst, cpu_ifirst<>>(true); }
+
+    TEST(FortranArrayAdapter, BindCopyCpuIfirst) { test_bind<storage::cpu_kfirst, cpu_ifirst<>>(false); }
+#endif
+} // namespace bind_test
@@ -0,0 +1,110 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <gridtools/storage/bundle.hpp>
+
+#include <type_traits>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/common/hymap.hpp>
+#include <gridtools/common/integral_constant.hpp>
+#include <gridtools/common/tuple_util.hpp>
+#include <gridtools/sid/composite.hpp>
+#include <gridtools/sid/concept.hpp>
+#include <gridtools/storage/builder.hpp>
+#include <gridtools/storage/sid.hpp>
+
+#include <storage_select.hpp>
+
+namespace gridtools {
+    namespace storage {
+        namespace {
+            namespace tu = tuple_util;
+            using tuple_util::get;
+
+            template <int_t I>
+            using dim = integral_constant<int_t, I>;
+
+            const auto builder = storage::builder<storage_traits_t>.type<double>().dimensions(9, 7, 5).halos(2, 2, 0);
+
+            auto field = [](int i, int j, int k, int n) { return i + 10 * j + 100 * k + 1000 * n; };
+
+            template <class Bundle>
+            void check_fields(Bundle const &bundle) {
+                auto &&strides = bundle.data_store()->strides();
+                auto *base = bundle.data_store()->get_target_ptr();
+                tu::for_each(
+                    [&](auto testee) {
+                        using field_t = decltype(testee);
+                        static_assert(sid::concept_impl_::is_sid<field_t>(), "");
+                        static_assert(std::is_same<sid::ptr_type<field_t>, double *>(), "");
+                        static_assert(tu::size<sid::strides_type<field_t>>() == 3, "");
+                        EXPECT_EQ(base + field_t::index * strides[3], sid::get_origin(testee)());
+                        auto field_strides = sid::get_strides(testee);
+                        EXPECT_EQ(strides[0], get<0>(field_strides));
+                        EXPECT_EQ(strides[1], get<1>(field_strides));
+                        EXPECT_EQ(strides[2], get<2>(field_strides));
+                        auto upper_bounds = sid::get_upper_bounds(testee);
+                        EXPECT_EQ(9, at_key<dim<0>>(upper_bounds));
+                        EXPECT_EQ(7, at_key<dim<1>>(upper_bounds));
+                        EXPECT_EQ(5, at_key<dim<2>>(upper_bounds));
+                        EXPECT_FALSE((has_key<decltype(upper_bounds), dim<3>>()));
+                        auto *ptr = sid::get_origin(testee)();
+                        for (int i = 0; i < 9; ++i)
+                            for (int j = 0; j < 7; ++j)
+                                for (int k = 0; k < 5; ++k)
+                                    EXPECT_EQ(field(i, j, k, field_t::index),
+                                        ptr[i * get<0>(field_strides) + j * get<1>(field_strides) +
+                                            k * get<2>(field_strides)]);
+                    },
+                    bundle.fields());
+            }
+
+            TEST(bundle, blocked) {
+                auto testee = builder.bundle<3>().initializer(field).build();
+                auto ds = testee.data_store();
+                auto single = builder.build();
+                using layout_t = typename decltype(ds)::element_type::layout_t;
+                using single_layout_t = typename decltype(single)::element_type::layout_t;
+                static_assert(layout_t::at(3) == 0, "");
+                static_assert(layout_t::at(0) == single_layout_t::at(0) + 1, "");
+                EXPECT_EQ(ds->lengths(), (array<uint_t, 4>{9, 7, 5, 3}));
+                // the fields have the same layout and padding as the standalone ones
+                for (size_t d = 0; d != 3; ++d)
+                    EXPECT_EQ(ds->strides()[d], single->strides()[d]);
+                EXPECT_GE(ds->strides()[3], single->length());
+                check_fields(testee);
+            }
+
+            TEST(bundle, interleaved) {
+                auto testee = builder.bundle<2, bundle_kind::interleaved>().initializer(field).build();
+                auto ds = testee.data_store();
+                EXPECT_EQ(ds->strides()[3], 1);
+                EXPECT_EQ(ds->length(), 9 * 7 * 5 * 2);
+                auto view = ds->const_host_view();
+                EXPECT_EQ(&view(1, 2, 3, 1), &view(1, 2, 3, 0) + 1);
+                check_fields(testee);
+            }
+
+            TEST(bundle, composite_shares_strides) {
+                auto testee = builder.bundle<2>().value(0).build();
+                auto composite = tu::make<sid::composite::keys<dim<0>, dim<1>>::values>(
+                    testee.field<0>(), testee.field<1>());
+                // one copy of the strides and the pointer differences for both fields
+                static_assert(sizeof(sid::get_stride<dim<1>>(sid::get_strides(composite))) == sizeof(int_t), "");
+                static_assert(sizeof(sid::ptr_diff_type<decltype(composite)>) == sizeof(int_t), "");
+                auto ptr = sid::get_origin(composite)();
+                at_key<dim<1>>(ptr)[0] = 42;
+                EXPECT_EQ(42, testee.data_store()->const_host_view()(0, 0, 0, 1));
+                EXPECT_EQ(0, testee.data_store()->const_host_view()(0, 0, 0, 0));
+            }
+        } // namespace
+    }     // namespace storage
+} // namespace gridtools
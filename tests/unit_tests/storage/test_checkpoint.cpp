@@ -0,0 +1,116 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/storage/checkpoint.hpp>
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/storage/builder.hpp>
+
+#include <storage_select.hpp>
+
+namespace gridtools {
+    namespace storage {
+        namespace {
+            class checkpoint_test : public testing::Test {
+              protected:
+                std::string m_path;
+
+                void SetUp() override {
+                    char tmpl[] = "/tmp/gt_checkpoint_XXXXXX";
+                    int fd = mkstemp(tmpl);
+                    ASSERT_GE(fd, 0);
+                    close(fd);
+                    m_path = tmpl;
+                }
+
+                void TearDown() override { std::remove(m_path.c_str()); }
+            };
+
+            const auto builder = storage::builder<storage_traits_t>.dimensions(13, 7, 5).halos(2, 2, 0);
+            const auto builder_2d = storage::builder<storage_traits_t>.dimensions(1000, 300);
+
+            template <class Storage, class Fun>
+            void expect_all(Storage const &storage, Fun &&fun) {
+                auto view = storage->const_host_view();
+                for (int i = 0; i < 13; ++i)
+                    for (int j = 0; j < 7; ++j)
+                        for (int k = 0; k < 5; ++k)
+                            EXPECT_EQ(view(i, j, k), fun(i, j, k));
+            }
+
+            auto field = [](int i, int j, int k) { return i + 100 * j + 10000 * k; };
+
+            TEST_F(checkpoint_test, save_restore) {
+                auto a = builder.type<double>().name("a").initializer(field).build();
+                auto b = builder.type<int>().name("b").value(42).build();
+                auto c = builder_2d.type<float>().name("c").value(-1).build();
+                save_checkpoint(m_path, a, b, c);
+
+                auto a2 = builder.type<double>().name("a").value(0).build();
+                auto b2 = builder.type<int>().name("b").value(0).build();
+                auto c2 = builder_2d.type<float>().name("c").value(0).build();
+                load_checkpoint(m_path, c2, a2, b2);
+                expect_all(a2, field);
+                expect_all(b2, [](int, int, int) { return 42; });
+                auto view = c2->const_host_view();
+                EXPECT_EQ(view(0, 0), -1);
+                EXPECT_EQ(view(999, 299), -1);
+            }
+
+            TEST_F(checkpoint_test, chunked_direct_io) {
+                checkpoint_options options;
+                options.direct_io = true;
+                options.threads = 3;
+                options.chunk_size = 4096;
+                auto a = builder.type<double>().name("a").initializer(field).build();
+                auto b = builder.type<char>().name("b").value('x').build();
+                checkpoint_writer(m_path, options).add(a).add(b).write();
+
+                checkpoint_reader reader(m_path, options);
+                ASSERT_EQ(reader.entries().size(), 2);
+                auto entry = reader.find("a");
+                ASSERT_TRUE(entry);
+                EXPECT_EQ(entry->element_size, sizeof(double));
+                EXPECT_EQ(entry->element_kind, 'f');
+                EXPECT_EQ(entry->lengths, (std::vector<std::uint64_t>{13, 7, 5}));
+                EXPECT_EQ(entry->offset % 4096, 0);
+
+                auto a2 = builder.type<double>().name("a").value(0).build();
+                auto b2 = builder.type<char>().name("b").value(0).build();
+                reader.add(a2).add(b2).read();
+                expect_all(a2, field);
+                expect_all(b2, [](int, int, int) { return 'x'; });
+            }
+
+            TEST_F(checkpoint_test, mismatch) {
+                save_checkpoint(m_path, builder.type<double>().name("a").value(1).build());
+                checkpoint_reader reader(m_path);
+                EXPECT_THROW(reader.add(builder.type<float>().name("a").value(0).build()), std::runtime_error);
+                EXPECT_THROW(reader.add(builder_2d.type<double>().name("a").value(0).build()),
+                    std::runtime_error);
+                EXPECT_THROW(reader.add(builder.type<double>().name("b").value(0).build()), std::runtime_error);
+            }
+
+            TEST_F(checkpoint_test, not_a_checkpoint) {
+                FILE *f = std::fopen(m_path.c_str(), "w");
+                std::fputs("not a checkpoint", f);
+                std::fclose(f);
+                EXPECT_THROW(checkpoint_reader{m_path}, std::runtime_error);
+            }
+        } // namespace
+    }     // namespace storage
+} // namespace gridtools
@@ -8,10 +8,15 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <algorithm>
+#include <vector>
+
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
 #include <gridtools/storage/builder.hpp>
+#include <gridtools/storage/cpu_kfirst.hpp>
+#include <gridtools/storage/sid.hpp>
 
 #include <storage_select.hpp>
 
@@ -48,6 +53,20 @@ TEST(DataStoreTest, Initializer) {
                 EXPECT_DOUBLE_EQ(view(i, j, k), 3.1415);
 }
 
+TEST(DataStoreTest, CpuKfirstZeroInitialized) {
+    auto kfirst_builder = storage::builder<storage::cpu_kfirst>.type<double>();
+    for (auto dims : {4, 128}) {
+        // the freed memory of the first store is likely reused by the second one
+        kfirst_builder.dimensions(dims, dims, 8).value(7).build();
+        auto ds = kfirst_builder.dimensions(dims, dims, 8).build();
+        auto view = ds->const_host_view();
+        for (int i = 0; i < dims; ++i)
+            for (int j = 0; j < dims; ++j)
+                for (int k = 0; k < 8; ++k)
+                    EXPECT_EQ(view(i, j, k), 0);
+    }
+}
+
 TEST(DataStoreTest, LambdaInitializer) {
     auto ds = builder.dimensions(10, 11, 12).initializer([](int i, int j, int k) { return i + j + k; }).build();
     auto lengths = ds->lengths();
@@ -81,3 +100,173 @@ TEST(DataStoreTest, DimAndSizeInterface) {
     auto ds = builder.dimensions(128, 128, 80)();
     EXPECT_THAT(ds->lengths(), ElementsAre(128, 128, 80));
 }
+
+namespace {
+    // serial decomposition into 3x2x4 blocks
+    struct test_decomposition {
+        template <class F>
+        void operator()(int i_size, int j_size, int k_size, F const &f) const {
+            for (int i = 0; i < i_size; i += 3)
+                for (int j = 0; j < j_size; j += 2)
+                    for (int k = 0; k < k_size; k += 4)
+                        f(i, std::min(i + 3, i_size), j, std::min(j + 2, j_size), k, std::min(k + 4, k_size));
+        }
+    };
+
+    // the serial decomposition into 3x2x4 blocks that keeps the number of the current block in `m_block`
+    struct numbering_decomposition {
+        int &m_block;
+
+        template <class F>
+        void operator()(int i_size, int j_size, int k_size, F const &f) const {
+            m_block = 0;
+            for (int i = 0; i < i_size; i += 3)
+                for (int j = 0; j < j_size; j += 2)
+                    for (int k = 0; k < k_size; k += 4, ++m_block)
+                        f(i, std::min(i + 3, i_size), j, std::min(j + 2, j_size), k, std::min(k + 4, k_size));
+        }
+    };
+
+    // the block of the 7x6x9 storage with the i/j halos of 1 that contains the point
+    int expected_block(int i, int j, int k) {
+        int bi = std::min(std::max(i - 1, 0), 4) / 3;
+        int bj = std::min(std::max(j - 1, 0), 3) / 2;
+        return (bi * 2 + bj) * 3 + k / 4;
+    }
+
+    template <int... Args>
+    void test_first_touch_layout() {
+        int block;
+        auto ds = builder.dimensions(7, 6, 9)
+                      .halos(1, 1, 0)
+                      .layout<Args...>()
+                      .first_touch(numbering_decomposition{block})
+                      .initializer([&](int, int, int) { return block; })
+                      .build();
+        auto view = ds->const_host_view();
+        for (int i = 0; i < 7; ++i)
+            for (int j = 0; j < 6; ++j)
+                for (int k = 0; k < 9; ++k)
+                    EXPECT_EQ(view(i, j, k), expected_block(i, j, k)) << i << " " << j << " " << k;
+    }
+
+} // namespace
+
+TEST(DataStoreTest, FirstTouchInitializer) {
+    auto ds = builder.dimensions(10, 11, 12)
+                  .halos(2, 1, 0)
+                  .first_touch(test_decomposition())
+                  .initializer([](int i, int j, int k) { return i + 100 * j + 10000 * k; })
+                  .build();
+    auto view = ds->const_host_view();
+    for (int i = 0; i < 10; ++i)
+        for (int j = 0; j < 11; ++j)
+            for (int k = 0; k < 12; ++k)
+                EXPECT_EQ(view(i, j, k), i + 100 * j + 10000 * k);
+}
+
+TEST(DataStoreTest, FirstTouchValue) {
+    auto ds = builder.first_touch(test_decomposition()).dimensions(7, 5, 3, 2).value(2.5).build();
+    auto view = ds->const_host_view();
+    for (int i = 0; i < 7; ++i)
+        for (int j = 0; j < 5; ++j)
+            for (int k = 0; k < 3; ++k)
+                for (int l = 0; l < 2; ++l)
+                    EXPECT_EQ(view(i, j, k, l), 2.5);
+}
+
+TEST(DataStoreTest, FirstTouchMasked) {
+    auto ds = builder.dimensions(6, 4, 5)
+                  .selector<1, 0, 1>()
+                  .first_touch(test_decomposition())
+                  .initializer([](int i, int j, int k) { return i + 10 * k; })
+                  .build();
+    auto view = ds->const_host_view();
+    for (int i = 0; i < 6; ++i)
+        for (int j = 0; j < 4; ++j)
+            for (int k = 0; k < 5; ++k)
+                EXPECT_EQ(view(i, j, k), i + 10 * k);
+}
+
+TEST(DataStoreTest, FirstTouchLayout) {
+    test_first_touch_layout<2, 1, 0>();
+    test_first_touch_layout<0, 1, 2>();
+    test_first_touch_layout<1, 2, 0>();
+}
+
+TEST(DataStoreTest, FirstTouchMaskedBlocks) {
+    int block;
+    auto ds = builder.dimensions(7, 6, 9)
+                  .halos(1, 1, 0)
+                  .selector<0, 1, 1>()
+                  .first_touch(numbering_decomposition{block})
+                  .initializer([&](int, int, int) { return block; })
+                  .build();
+    auto view = ds->const_host_view();
+    // the masked i dimension is touched by the first blocks along i
+    for (int j = 0; j < 6; ++j)
+        for (int k = 0; k < 9; ++k)
+            EXPECT_EQ(view(3, j, k), expected_block(0, j, k));
+}
+
+TEST(DataStoreTest, MaskedLambdaInitializer) {
+    auto ds = builder.dimensions(6, 4, 5, 3)
+                  .selector<0, 1, 1, 0>()
+                  .initializer([](int i, int j, int k, int l) { return j + 10 * k; })
+                  .build();
+    auto view = ds->const_host_view();
+    for (int j = 0; j < 4; ++j)
+        for (int k = 0; k < 5; ++k)
+            EXPECT_EQ(view(0, j, k, 0), j + 10 * k);
+}
+
+TEST(DataStoreTest, CopyFromDataStore) {
+    auto src = storage::builder<storage_traits_t>
+                   .type<int>()
+                   .dimensions(9, 7, 5)
+                   .layout<0, 2, 1>()
+                   .initializer([](int i, int j, int k) { return i + 10 * j + 100 * k; })
+                   .build();
+    auto ds = builder.dimensions(9, 7, 5).halos(1, 1, 0).copy_from(src).build();
+    auto view = ds->const_host_view();
+    for (int i = 0; i < 9; ++i)
+        for (int j = 0; j < 7; ++j)
+            for (int k = 0; k < 5; ++k)
+                EXPECT_EQ(view(i, j, k), i + 10 * j + 100 * k);
+}
+
+TEST(DataStoreTest, CopyFromFortran) {
+    std::vector<float> src(8 * 6 * 4);
+    for (size_t n = 0; n < src.size(); ++n)
+        src[n] = n;
+    auto ds = builder.dimensions(8, 6, 4).first_touch(test_decomposition()).copy_from_fortran(src.data()).build();
+    auto view = ds->const_host_view();
+    for (int i = 0; i < 8; ++i)
+        for (int j = 0; j < 6; ++j)
+            for (int k = 0; k < 4; ++k)
+                EXPECT_EQ(view(i, j, k), i + 8 * j + 48 * k);
+
+    // the masked dimensions are skipped
+    auto masked = builder.dimensions(8, 5, 6).selector<1, 0, 1>().copy_from_fortran(src.data()).build();
+    auto masked_view = masked->const_host_view();
+    for (int i = 0; i < 8; ++i)
+        for (int k = 0; k < 6; ++k)
+            EXPECT_EQ(masked_view(i, 3, k), i + 8 * k);
+}
+
+TEST(DataStoreTest, AntiAliasingPadding) {
+    auto ds = builder.dimensions(64, 64, 16)
+                  .halos(2, 2, 0)
+                  .padding<storage::anti_aliasing>()
+                  .initializer([](int i, int j, int k) { return i + 100 * j + 10000 * k; })
+                  .build();
+    auto plain = builder.dimensions(64, 64, 16).halos(2, 2, 0).build();
+    EXPECT_FALSE((std::is_same<decltype(ds)::element_type::kind_t, decltype(plain)::element_type::kind_t>()));
+    for (auto stride : ds->strides())
+        EXPECT_NE(stride * sizeof(double) % 4096, 0);
+    auto view = ds->const_host_view();
+    for (int i = 0; i < 64; ++i)
+        for (int j = 0; j < 64; ++j)
+            for (int k = 0; k < 16; ++k)
+                EXPECT_EQ(view(i, j, k), i + 100 * j + 10000 * k);
+}
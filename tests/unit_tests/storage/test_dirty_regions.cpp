@@ -0,0 +1,129 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/storage/mirror.hpp>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/storage/builder.hpp>
+#include <gridtools/storage/cpu_ifirst.hpp>
+
+namespace gridtools {
+    namespace storage {
+        namespace {
+            class dirty_regions : public testing::Test {
+              protected:
+                void SetUp() override { reset_mirror_statistics(); }
+            };
+
+            const auto kfirst_builder = builder<mirror<>>.type<double>().dimensions(12, 10, 8).halos(2, 2, 0);
+            const auto ifirst_builder = builder<mirror<cpu_ifirst>>.type<double>().dimensions(12, 10, 8).halos(2, 2, 0);
+
+            template <class DataStore>
+            double target_at(DataStore const &ds, int i, int j, int k) {
+                return ds->get_const_target_ptr()[ds->info().index(i, j, k)];
+            }
+
+            TEST_F(dirty_regions, whole_copy_after_initialization) {
+                auto ds = kfirst_builder.value(1).build();
+                EXPECT_EQ(target_at(ds, 11, 9, 7), 1);
+                auto stats = get_mirror_statistics();
+                EXPECT_EQ(stats.to_target_copies, 1);
+                EXPECT_EQ(stats.to_target_bytes, ds->length() * sizeof(double));
+                ds->get_const_target_ptr();
+                EXPECT_EQ(get_mirror_statistics().to_target_copies, 1);
+            }
+
+            TEST_F(dirty_regions, host_halo_side) {
+                auto ds = kfirst_builder.value(0).build();
+                ds->get_const_target_ptr();
+                reset_mirror_statistics();
+                auto view = ds->host_view(halo_region(*ds, 0, side::upper));
+                for (int i = 10; i < 12; ++i)
+                    for (int j = 0; j < 10; ++j)
+                        for (int k = 0; k < 8; ++k)
+                            view(i, j, k) = i + j + k;
+                EXPECT_EQ(target_at(ds, 11, 9, 7), 11 + 9 + 7);
+                EXPECT_EQ(target_at(ds, 9, 9, 7), 0);
+                auto stats = get_mirror_statistics();
+                // k is the inner most dimension: one run per (i, j) row, the rows of the halo side are adjacent
+                EXPECT_EQ(stats.to_target_copies, 1);
+                EXPECT_EQ(stats.to_target_bytes, 2 * 10 * 8 * sizeof(double));
+            }
+
+            TEST_F(dirty_regions, host_slab) {
+                auto ds = ifirst_builder.value(0).build();
+                ds->get_const_target_ptr();
+                reset_mirror_statistics();
+                auto view = ds->host_view(slab_region(*ds, 3, 5));
+                view(0, 0, 3) = 1;
+                view(11, 9, 4) = 2;
+                EXPECT_EQ(target_at(ds, 0, 0, 3), 1);
+                EXPECT_EQ(target_at(ds, 11, 9, 4), 2);
+                auto stats = get_mirror_statistics();
+                // j is the outer most dimension: one run per j, covering the two (padded) rows of the slab
+                EXPECT_EQ(stats.to_target_copies, 10);
+                EXPECT_LT(stats.to_target_bytes, ds->length() * sizeof(double) / 3);
+            }
+
+            TEST_F(dirty_regions, several_host_regions) {
+                auto ds = ifirst_builder.value(0).build();
+                ds->get_const_target_ptr();
+                reset_mirror_statistics();
+                ds->host_view(halo_region(*ds, 1, side::lower))(5, 0, 0) = 1;
+                ds->host_view(halo_region(*ds, 1, side::upper))(5, 9, 7) = 2;
+                region<3> box = {{4, 4, 4}, {6, 6, 6}};
+                ds->get_host_ptr(box)[ds->info().index(5, 5, 5)] = 3;
+                EXPECT_EQ(target_at(ds, 5, 0, 0), 1);
+                EXPECT_EQ(target_at(ds, 5, 9, 7), 2);
+                EXPECT_EQ(target_at(ds, 5, 5, 5), 3);
+                auto stats = get_mirror_statistics();
+                EXPECT_GT(stats.to_target_copies, 3);
+                EXPECT_LT(stats.to_target_bytes, ds->length() * sizeof(double));
+            }
+
+            TEST_F(dirty_regions, target_region) {
+                auto ds = ifirst_builder.value(0).build();
+                ds->const_host_view();
+                ds->get_const_target_ptr();
+                reset_mirror_statistics();
+                auto view = ds->target_view(slab_region(*ds, 7, 8));
+                view(3, 4, 7) = 5;
+                EXPECT_EQ(ds->const_host_view()(3, 4, 7), 5);
+                auto stats = get_mirror_statistics();
+                EXPECT_EQ(stats.to_target_copies, 0);
+                EXPECT_EQ(stats.to_host_copies, 10);
+                EXPECT_LT(stats.to_host_bytes, ds->length() * sizeof(double) / 4);
+            }
+
+            TEST_F(dirty_regions, falls_back_to_whole_copy) {
+                auto ds = kfirst_builder.value(0).build();
+                ds->get_const_target_ptr();
+                {
+                    // a whole modification absorbs the later regions
+                    ds->host_view();
+                    ds->host_view(slab_region(*ds, 0, 1));
+                    reset_mirror_statistics();
+                    ds->get_const_target_ptr();
+                    EXPECT_EQ(get_mirror_statistics().to_target_bytes, ds->length() * sizeof(double));
+                }
+                {
+                    for (int k = 0; k < 20; ++k)
+                        ds->host_view(slab_region(*ds, k % 8, k % 8 + 1));
+                    reset_mirror_statistics();
+                    ds->get_const_target_ptr();
+                    auto stats = get_mirror_statistics();
+                    EXPECT_EQ(stats.to_target_copies, 1);
+                    EXPECT_EQ(stats.to_target_bytes, ds->length() * sizeof(double));
+                }
+            }
+        } // namespace
+    }     // namespace storage
+} // namespace gridtools
@@ -0,0 +1,100 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/storage/mmap_file.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/storage/builder.hpp>
+#include <gridtools/storage/cpu_ifirst.hpp>
+
+namespace gridtools {
+    namespace storage {
+        namespace {
+            class mmap_file_test : public testing::Test {
+                std::string m_old_dir;
+
+              protected:
+                std::string m_dir;
+
+                void SetUp() override {
+                    char tmpl[] = "/tmp/gt_mmap_file_XXXXXX";
+                    ASSERT_TRUE(mkdtemp(tmpl));
+                    m_dir = tmpl;
+                    m_old_dir = get_mmap_directory();
+                    set_mmap_directory(m_dir);
+                }
+
+                void TearDown() override {
+                    set_mmap_directory(m_old_dir);
+                    for (auto name : {"a", "b", "c"})
+                        std::remove((m_dir + "/" + name).c_str());
+                    rmdir(m_dir.c_str());
+                }
+            };
+
+            const auto builder = storage::builder<mmap_file<>>.type<double>().dimensions(5, 6, 7);
+
+            TEST_F(mmap_file_test, content_persists) {
+                {
+                    auto ds = builder.name("a").initializer([](int i, int j, int k) { return i + 10 * j + 100 * k; })();
+                    EXPECT_EQ(ds->const_host_view()(1, 2, 3), 321);
+                }
+                struct stat st;
+                ASSERT_EQ(stat((m_dir + "/a").c_str(), &st), 0);
+                EXPECT_GE(st.st_size, 5 * 6 * 7 * sizeof(double));
+
+                auto ds = builder.name("a")();
+                auto view = ds->host_view();
+                for (int i = 0; i < 5; ++i)
+                    for (int j = 0; j < 6; ++j)
+                        for (int k = 0; k < 7; ++k)
+                            EXPECT_EQ(view(i, j, k), i + 10 * j + 100 * k);
+                view(0, 0, 0) = 42;
+                ds.reset();
+                EXPECT_EQ(builder.name("a")()->const_host_view()(0, 0, 0), 42);
+            }
+
+            TEST_F(mmap_file_test, read_only_file_is_private) {
+                builder.name("b").value(3)();
+                chmod((m_dir + "/b").c_str(), 0444);
+                if (access((m_dir + "/b").c_str(), W_OK) == 0)
+                    return; // running as root
+                {
+                    auto ds = builder.name("b")();
+                    auto view = ds->host_view();
+                    EXPECT_EQ(view(4, 5, 6), 3);
+                    view(4, 5, 6) = 7;
+                    EXPECT_EQ(view(4, 5, 6), 7);
+                }
+                EXPECT_EQ(builder.name("b")()->const_host_view()(4, 5, 6), 3);
+            }
+
+            TEST_F(mmap_file_test, size_mismatch) {
+                builder.name("c").value(0)();
+                auto other = storage::builder<mmap_file<>>.type<double>().dimensions(5, 6, 8).name("c");
+                EXPECT_THROW(other(), std::runtime_error);
+            }
+
+            TEST_F(mmap_file_test, anonymous) {
+                auto ds = storage::builder<mmap_file<cpu_ifirst>>.type<int>().dimensions(33, 2).value(5)();
+                EXPECT_EQ(ds->const_host_view()(32, 1), 5);
+            }
+        } // namespace
+    }     // namespace storage
+} // namespace gridtools
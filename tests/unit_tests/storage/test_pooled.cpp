@@ -0,0 +1,102 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/storage/pooled.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/sid/allocator.hpp>
+#include <gridtools/storage/builder.hpp>
+#include <gridtools/storage/cpu_kfirst.hpp>
+
+namespace gridtools {
+    namespace storage {
+        namespace {
+            class pooled_test : public testing::Test {
+              protected:
+                std::size_t m_limit;
+
+                void SetUp() override {
+                    sid::release_pooled_memory();
+                    m_limit = sid::get_pool_limit();
+                }
+
+                void TearDown() override {
+                    sid::set_pool_limit(m_limit);
+                    sid::release_pooled_memory();
+                }
+            };
+
+            const auto builder = storage::builder<pooled<>>.dimensions(64, 32, 16).halos(3, 3, 0);
+
+            TEST_F(pooled_test, steady_state_reuses_blocks) {
+                auto before = sid::get_pool_stats();
+                for (int step = 0; step < 10; ++step) {
+                    auto a = builder.type<double>().value(step).build();
+                    auto b = builder.type<double>().initializer([](int i, int j, int k) { return i + j + k; }).build();
+                    EXPECT_EQ(a->const_host_view()(63, 31, 15), step);
+                    EXPECT_EQ(b->const_host_view()(63, 31, 15), 63 + 31 + 15);
+                    auto first = a->get_target_ptr() + a->info().index(3, 3, 0);
+                    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(first) % 64, 0);
+                }
+                auto after = sid::get_pool_stats();
+                EXPECT_EQ(after.misses - before.misses, 2);
+                EXPECT_EQ(after.hits - before.hits, 18);
+                EXPECT_EQ(after.bytes_in_use, before.bytes_in_use);
+                EXPECT_GE(after.bytes_retained, 2 * 64 * 32 * 16 * sizeof(double));
+            }
+
+            TEST_F(pooled_test, blocks_are_shared_across_builders) {
+                builder.type<float>().build();
+                auto stats = sid::get_pool_stats();
+                EXPECT_GT(stats.bytes_retained, 0);
+                // a different type, shape and base layout that fits into the same block
+                auto other = storage::builder<pooled<cpu_kfirst>>.type<int>().dimensions(70, 30, 16).build();
+                EXPECT_EQ(sid::get_pool_stats().hits, stats.hits + 1);
+                EXPECT_EQ(sid::get_pool_stats().bytes_retained, 0);
+            }
+
+            TEST_F(pooled_test, limit) {
+                {
+                    auto a = builder.type<double>().build();
+                    auto b = storage::builder<pooled<>>.type<double>().dimensions(1024, 1024, 2).build();
+                }
+                auto stats = sid::get_pool_stats();
+                EXPECT_GE(stats.bytes_retained, 1024 * 1024 * 2 * sizeof(double));
+                sid::set_pool_limit(stats.bytes_retained - 1);
+                stats = sid::get_pool_stats();
+                // the large block is returned first and goes first
+                EXPECT_GT(stats.bytes_retained, 0);
+                EXPECT_LT(stats.bytes_retained, 1024 * 1024);
+                sid::release_pooled_memory();
+                EXPECT_EQ(sid::get_pool_stats().bytes_retained, 0);
+            }
+
+            TEST_F(pooled_test, concurrent) {
+                std::vector<std::thread> threads;
+                for (int t = 0; t < 4; ++t)
+                    threads.emplace_back([t] {
+                        for (int step = 0; step < 20; ++step)
+                            EXPECT_EQ(builder.type<int>().value(t).build()->const_host_view()(1, 2, 3), t);
+                    });
+                for (auto &thread : threads)
+                    thread.join();
+                auto stats = sid::get_pool_stats();
+                EXPECT_EQ(stats.bytes_in_use, 0);
+                EXPECT_LE(stats.bytes_retained, 4 * 64 * 32 * 16 * sizeof(int) * 2);
+            }
+        } // namespace
+    }     // namespace storage
+} // namespace gridtools
@@ -56,6 +56,34 @@ namespace gridtools {
                 }
             }
 
+            TEST(StorageInfo, AntiAliasingPadding) {
+                {
+                    // 8 byte elements: the padding unit is 8 elements, 128 * 128 * 8 bytes is a multiple of 4 KiB
+                    info<3> si(layout_map<0, 1, 2>(), 1, {128, 128, 80}, anti_aliasing(), 8);
+                    EXPECT_THAT(si.strides(), ElementsAre(80 * 128 + 8, 80, 1));
+                    EXPECT_EQ(si.length(), si.index(127, 127, 79) + 1);
+                }
+                {
+                    info<3> si(layout_map<0, 1, 2>(), 8, {80, 128, 128}, anti_aliasing(), 8);
+                    EXPECT_THAT(si.strides(), ElementsAre(136 * 128 + 8, 136, 1));
+                    for (auto stride : si.strides())
+                        EXPECT_NE(stride * 8 % 4096, 0);
+                }
+                {
+                    // the small strides are not padded
+                    info<3> si(layout_map<0, 1, 2>(), 1, {4, 4, 4}, anti_aliasing(), 8);
+                    EXPECT_THAT(si.strides(), ElementsAre(16, 4, 1));
+                }
+                {
+                    info<3> si(layout_map<-1, 0, 1>(), 32, {3, 512, 512}, anti_aliasing(), 4);
+                    EXPECT_THAT(si.strides(), ElementsAre(0, 544, 1));
+                }
+                {
+                    info<3> si(layout_map<0, 1, 2>(), 32, {3, 4, 5}, no_padding(), 8);
+                    EXPECT_EQ(si, info<3>(layout_map<0, 1, 2>(), 32, {3, 4, 5}));
+                }
+            }
+
             TEST(StorageInfo, IndexVariadic) {
                 {
                     info<3> si(layout_map<0, 1, 2>(), 1, {3, 4, 5});
@@ -0,0 +1,41 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/thread_pool/first_touch.hpp>
+
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/thread_pool/work_stealing.hpp>
+
+namespace gridtools {
+    namespace thread_pool {
+        namespace {
+            TEST(first_touch, zeroes) {
+                for (std::size_t size : {0, 1, 7, 1000, 12345}) {
+                    std::vector<char> buf(size + 2, 1);
+                    first_touch(work_stealing(), buf.data() + 1, size);
+                    EXPECT_EQ(buf.front(), 1);
+                    EXPECT_EQ(buf.back(), 1);
+                    for (std::size_t i = 1; i <= size; ++i)
+                        EXPECT_EQ(buf[i], 0);
+                }
+            }
+
+            TEST(first_touch, allocation) {
+                auto ptr = first_touch_allocation_f<work_stealing>()(100);
+                for (int i = 0; i != 100; ++i)
+                    EXPECT_EQ(ptr[i], 0);
+            }
+        } // namespace
+    }     // namespace thread_pool
+} // namespace gridtools
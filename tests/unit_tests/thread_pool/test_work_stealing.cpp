@@ -0,0 +1,194 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2019, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/thread_pool/work_stealing.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/thread_pool/concept.hpp>
+
+namespace gridtools {
+    namespace thread_pool {
+        namespace {
+            using testee_t = work_stealing;
+
+            TEST(work_stealing, thread_num) {
+                int max_threads = get_max_threads(testee_t());
+                EXPECT_GT(max_threads, 0);
+                EXPECT_EQ(get_thread_num(testee_t()), 0);
+                std::vector<std::atomic<int>> hits(max_threads);
+                parallel_for_loop(
+                    testee_t(),
+                    [&](int) {
+                        int id = get_thread_num(testee_t());
+                        ASSERT_GE(id, 0);
+                        ASSERT_LT(id, max_threads);
+                        ++hits[id];
+                    },
+                    1000);
+                int total = 0;
+                for (auto &&hit : hits)
+                    total += hit;
+                EXPECT_EQ(total, 1000);
+            }
+
+            TEST(work_stealing, one_dim) {
+                std::vector<std::atomic<int>> hits(1003);
+                parallel_for_loop(
+                    testee_t(), [&](int i) { ++hits[i]; }, 1003);
+                for (auto &&hit : hits)
+                    EXPECT_EQ(hit, 1);
+            }
+
+            TEST(work_stealing, three_dims) {
+                int const ni = 7, nj = 5, nk = 11;
+                std::vector<std::atomic<int>> hits(ni * nj * nk);
+                parallel_for_loop(
+                    testee_t(),
+                    [&](int i, int j, int k) {
+                        ASSERT_LT(i, ni);
+                        ASSERT_LT(j, nj);
+                        ASSERT_LT(k, nk);
+                        ++hits[i + ni * (j + nj * k)];
+                    },
+                    ni,
+                    nj,
+                    nk);
+                for (auto &&hit : hits)
+                    EXPECT_EQ(hit, 1);
+            }
+
+            TEST(work_stealing, empty) {
+                parallel_for_loop(
+                    testee_t(), [&](int, int) { FAIL(); }, 0, 10);
+                parallel_for_loop(
+                    testee_t(), [&](int) { FAIL(); }, 0);
+            }
+
+            TEST(work_stealing, nested) {
+                std::vector<std::atomic<int>> hits(10 * 20);
+                parallel_for_loop(
+                    testee_t(),
+                    [&](int j) { parallel_for_loop(testee_t(), [&](int i) { ++hits[i + 10 * j]; }, 10); },
+                    20);
+                for (auto &&hit : hits)
+                    EXPECT_EQ(hit, 1);
+            }
+
+            TEST(work_stealing, imbalanced) {
+                std::atomic<int> sum(0);
+                parallel_for_loop(
+                    testee_t(),
+                    [&](int i) {
+                        if (i == 0)
+                            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                        sum += i;
+                    },
+                    100);
+                EXPECT_EQ(sum, 4950);
+            }
+
+            TEST(work_stealing, consecutive) {
+                std::atomic<long> sum(0);
+                for (int n = 0; n != 1000; ++n)
+                    parallel_for_loop(
+                        testee_t(), [&](int i, int j) { sum += i * j; }, 4, 3);
+                EXPECT_EQ(sum, 1000 * 6 * 3);
+            }
+
+            TEST(work_stealing, exception) {
+                for (int thrower : {0, 517, 999}) {
+                    std::atomic<int> calls(0);
+                    EXPECT_THROW(parallel_for_loop(
+                                     testee_t(),
+                                     [&](int i) {
+                                         ++calls;
+                                         if (i == thrower)
+                                             throw std::runtime_error("thrower");
+                                     },
+                                     1000),
+                        std::runtime_error);
+                    EXPECT_GT(calls, 0);
+                    EXPECT_LE(calls, 1000);
+                }
+                // the pool is still usable and the loops are parallel again
+                int max_threads = get_max_threads(testee_t());
+                std::vector<std::atomic<int>> hits(max_threads);
+                parallel_for_loop(
+                    testee_t(),
+                    [&](int) {
+                        std::this_thread::sleep_for(std::chrono::microseconds(100));
+                        ++hits[get_thread_num(testee_t())];
+                    },
+                    1000);
+                int total = 0, active = 0;
+                for (auto &&hit : hits) {
+                    total += hit;
+                    active += hit != 0;
+                }
+                EXPECT_EQ(total, 1000);
+                if (max_threads > 1) {
+                    EXPECT_GT(active, 1);
+                }
+            }
+
+            TEST(work_stealing, concurrent_callers) {
+                std::atomic<int> sum(0);
+                std::vector<std::thread> callers;
+                for (int t = 0; t != 4; ++t)
+                    callers.emplace_back([&] {
+                        for (int n = 0; n != 50; ++n)
+                            parallel_for_loop(
+                                testee_t(), [&](int) { ++sum; }, 100);
+                    });
+                for (auto &&caller : callers)
+                    caller.join();
+                EXPECT_EQ(sum, 4 * 50 * 100);
+            }
+
+            TEST(work_stealing, set_num_threads) {
+                int share = std::max(get_max_threads(testee_t()) / 2, 1);
+                std::atomic<int> started(0);
+                auto caller = [&] {
+                    set_num_threads(testee_t(), share);
+                    EXPECT_EQ(get_max_threads(testee_t()), share);
+                    std::vector<std::atomic<int>> hits(1000);
+                    parallel_for_loop(
+                        testee_t(),
+                        [&](int i) {
+                            if (i == 0) {
+                                // the loops of both callers have to run at the same time
+                                ++started;
+                                auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+                                while (started < 2 && std::chrono::steady_clock::now() < deadline)
+                                    std::this_thread::yield();
+                            }
+                            ASSERT_LT(get_thread_num(testee_t()), share);
+                            ++hits[i];
+                        },
+                        1000);
+                    for (auto &&hit : hits)
+                        EXPECT_EQ(hit, 1);
+                    EXPECT_EQ(started, 2);
+                };
+                std::thread first(caller), second(caller);
+                first.join();
+                second.join();
+            }
+        } // namespace
+    }     // namespace thread_pool
+} // namespace gridtools